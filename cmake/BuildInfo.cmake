@@ -0,0 +1,41 @@
+# Genera build_info.hpp con hash git, compilatore e flag della build corrente.
+# Eseguito a ogni compilazione (cmake -P), riscrive il file solo se il contenuto cambia.
+
+execute_process(COMMAND git rev-parse --short=12 HEAD
+    WORKING_DIRECTORY ${SOURCE_DIR} OUTPUT_VARIABLE GIT_HASH
+    OUTPUT_STRIP_TRAILING_WHITESPACE ERROR_QUIET RESULT_VARIABLE GIT_RESULT)
+if(NOT GIT_RESULT EQUAL 0 OR GIT_HASH STREQUAL "")
+    set(GIT_HASH "unknown")
+endif()
+
+# Modifiche non salvate ai file tracciati (i risultati non corrispondono esattamente all'hash)
+execute_process(COMMAND git diff --quiet HEAD --
+    WORKING_DIRECTORY ${SOURCE_DIR} RESULT_VARIABLE GIT_DIRTY_RESULT ERROR_QUIET)
+if(GIT_DIRTY_RESULT EQUAL 1)
+    set(GIT_DIRTY 1)
+else()
+    set(GIT_DIRTY 0)
+endif()
+
+string(STRIP "${CXX_FLAGS}" CXX_FLAGS)
+string(REPLACE "\"" "\\\"" CXX_FLAGS "${CXX_FLAGS}")
+
+set(CONTENT "// File generato da cmake/BuildInfo.cmake: non modificare
+#ifndef MORPHOLOGY_BUILD_INFO_HPP
+#define MORPHOLOGY_BUILD_INFO_HPP
+
+#define MORPHO_GIT_HASH \"${GIT_HASH}\"
+#define MORPHO_GIT_DIRTY ${GIT_DIRTY}
+#define MORPHO_COMPILER \"${COMPILER}\"
+#define MORPHO_CXX_FLAGS \"${CXX_FLAGS}\"
+#define MORPHO_BUILD_TYPE \"${BUILD_TYPE}\"
+
+#endif // MORPHOLOGY_BUILD_INFO_HPP
+")
+
+if(EXISTS ${OUTPUT})
+    file(READ ${OUTPUT} OLD_CONTENT)
+endif()
+if(NOT "${OLD_CONTENT}" STREQUAL "${CONTENT}")
+    file(WRITE ${OUTPUT} "${CONTENT}")
+endif()
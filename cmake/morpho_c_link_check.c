@@ -0,0 +1,26 @@
+/* Programma C collegato alla sola libmorpho_c.so (CMakeLists.txt): apertura di un elemento strutturante e
+   un'erosione 8x8, così un simbolo mancante fa fallire il collegamento e uno rotto l'esecuzione */
+#include "morpho_c.h"
+
+#include <stdio.h>
+
+int main(void) {
+    uint8_t src[64], dst[64];
+    morpho_se* se = NULL;
+    morpho_image image = {src, 8, dst, 8, 8, 8};
+    int status, i;
+    for (i = 0; i < 64; i++) src[i] = 255;
+
+    if (morpho_abi_version() != MORPHO_ABI_VERSION) {
+        fprintf(stderr, "morpho_c: versione ABI diversa dall'intestazione\n");
+        return 1;
+    }
+    status = morpho_se_create_shape("disk", 1, &se);
+    if (status == MORPHO_OK) status = morpho_apply(se, MORPHO_EROSION, &image, 0, 1);
+    morpho_se_destroy(se);
+    if (status != MORPHO_OK) {
+        fprintf(stderr, "morpho_c: %s\n", morpho_status_string(status));
+        return 1;
+    }
+    return dst[3 * 8 + 3] == 255 && dst[0] == 0 ? 0 : 1;
+}
@@ -0,0 +1,174 @@
+#include "alloc_tracker.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <stdio.h>
+
+#if defined(__APPLE__)
+    #include <malloc/malloc.h>
+    #define ALLOCATION_SIZE(ptr) malloc_size(ptr)
+#elif defined(_WIN32)
+    #include <malloc.h>
+    #define ALLOCATION_SIZE(ptr) _msize(ptr)
+#else
+    #include <malloc.h>
+    #define ALLOCATION_SIZE(ptr) malloc_usable_size(ptr)
+#endif
+
+// Contatori inizializzati staticamente: validi anche per le allocazioni dei costruttori globali
+static std::atomic<uint64_t> allocation_count{0};
+static std::atomic<uint64_t> free_count{0};
+static std::atomic<uint64_t> allocated_bytes{0};
+static std::atomic<int64_t> live_bytes{0};
+static std::atomic<int64_t> peak_live_bytes{0};
+// Massimo dei picchi azzerati da resetAllocPeak(): insieme al picco corrente dà quello dell'intera esecuzione
+static std::atomic<int64_t> run_peak_live_bytes{0};
+
+static void recordAllocation(void* ptr) {
+    if (!ptr) return;
+    int64_t size = (int64_t)ALLOCATION_SIZE(ptr);
+    allocation_count.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t live = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+    int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_live_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+static void recordFree(void* ptr) {
+    if (!ptr) return;
+    free_count.fetch_add(1, std::memory_order_relaxed);
+    live_bytes.fetch_sub((int64_t)ALLOCATION_SIZE(ptr), std::memory_order_relaxed);
+}
+
+void* trackedMalloc(size_t size) {
+    void* ptr = std::malloc(size);
+    recordAllocation(ptr);
+    return ptr;
+}
+
+void* trackedRealloc(void* ptr, size_t size) {
+    recordFree(ptr);
+    void* result = std::realloc(ptr, size);
+    // Se realloc fallisce il blocco originale resta valido e va contato di nuovo
+    recordAllocation(result ? result : (size ? ptr : nullptr));
+    return result;
+}
+
+void trackedFree(void* ptr) {
+    recordFree(ptr);
+    std::free(ptr);
+}
+
+AllocStats allocStats() {
+    AllocStats stats;
+    stats.allocations = allocation_count.load(std::memory_order_relaxed);
+    stats.frees = free_count.load(std::memory_order_relaxed);
+    stats.bytes_allocated = allocated_bytes.load(std::memory_order_relaxed);
+    stats.live_bytes = live_bytes.load(std::memory_order_relaxed);
+    stats.peak_live_bytes = peak_live_bytes.load(std::memory_order_relaxed);
+    stats.run_peak_live_bytes = std::max(stats.peak_live_bytes, run_peak_live_bytes.load(std::memory_order_relaxed));
+    return stats;
+}
+
+void resetAllocPeak() {
+    int64_t peak = peak_live_bytes.load(std::memory_order_relaxed);
+    if (peak > run_peak_live_bytes.load(std::memory_order_relaxed)) run_peak_live_bytes.store(peak, std::memory_order_relaxed);
+    peak_live_bytes.store(live_bytes.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+void AllocMeasure::begin() {
+    resetAllocPeak();
+    start = allocStats();
+}
+
+AllocSample AllocMeasure::end() const {
+    AllocStats now = allocStats();
+    AllocSample sample;
+    sample.allocations = now.allocations - start.allocations;
+    sample.bytes_allocated = now.bytes_allocated - start.bytes_allocated;
+    sample.peak_live_bytes = now.peak_live_bytes;
+    sample.peak_extra_bytes = now.peak_live_bytes - start.live_bytes;
+    sample.retained_bytes = now.live_bytes - start.live_bytes;
+    sample.peak_rss_bytes = peakRssBytes();
+    return sample;
+}
+
+// Legge un campo "Nome:   valore kB" da /proc/self/status (senza allocare, con stdio)
+static uint64_t procStatusBytes(const char* field) {
+    uint64_t value = 0;
+#ifdef __linux__
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) return 0;
+    char line[256];
+    size_t length = strlen(field);
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, field, length) == 0 && line[length] == ':') {
+            value = strtoull(line + length + 1, nullptr, 10) * 1024;
+            break;
+        }
+    }
+    fclose(status);
+#else
+    (void)field;
+#endif
+    return value;
+}
+
+uint64_t peakRssBytes() {
+    return procStatusBytes("VmHWM");
+}
+
+uint64_t currentRssBytes() {
+    return procStatusBytes("VmRSS");
+}
+
+// OPERATOR NEW / DELETE GLOBALI
+//
+// Sostituiscono quelli della libreria standard in tutto il programma che collega la libreria.
+// Le versioni allineate non sono sostituite: allocazione e rilascio restano entrambi fuori dai conteggi.
+
+void* operator new(size_t size) {
+    void* ptr = trackedMalloc(size ? size : 1);
+    if (!ptr) throw std::bad_alloc();
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return trackedMalloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return trackedMalloc(size ? size : 1);
+}
+
+void operator delete(void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
+
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept {
+    trackedFree(ptr);
+}
@@ -0,0 +1,60 @@
+#ifndef MORPHOLOGY_ALLOC_TRACKER_HPP
+#define MORPHOLOGY_ALLOC_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// CONTABILITÀ DELLA MEMORIA
+//
+// Le allocazioni dei pixel di STBImage (e quelle di stb_image) passano da trackedMalloc/trackedFree,
+// quelle dei contenitori e delle stringhe dall'operator new globale sostituito in alloc_tracker.cpp.
+// Contatori atomici globali registrano allocazioni, byte allocati e byte vivi, con il massimo dei
+// byte vivi azzerabile prima di ogni misura; il picco di RSS del processo si legge da /proc/self/status.
+// I byte sono quelli effettivamente riservati dall'allocatore (malloc_usable_size), gli stessi al
+// rilascio, così i byte vivi tornano a zero quando tutto è stato liberato.
+
+// Funzioni di allocazione contabilizzate per i buffer delle immagini
+void* trackedMalloc(size_t size);
+void* trackedRealloc(void* ptr, size_t size);
+void trackedFree(void* ptr);
+
+// Stato dei contatori dall'avvio del processo
+struct AllocStats {
+    uint64_t allocations{0};
+    uint64_t frees{0};
+    uint64_t bytes_allocated{0};
+    int64_t live_bytes{0};
+    int64_t peak_live_bytes{0};     // Massimo dall'ultimo resetAllocPeak()
+    int64_t run_peak_live_bytes{0}; // Massimo dall'avvio del processo
+};
+
+AllocStats allocStats();
+
+// Funzione per riportare il massimo dei byte vivi al valore corrente
+void resetAllocPeak();
+
+// Memoria usata da una misura: differenza fra due istanti, con il picco raggiunto nel mezzo
+struct AllocSample {
+    uint64_t allocations{0};
+    uint64_t bytes_allocated{0};
+    int64_t peak_live_bytes{0};     // Picco dei byte vivi del processo durante la misura
+    int64_t peak_extra_bytes{0};    // Picco oltre i byte vivi all'inizio della misura
+    int64_t retained_bytes{0};      // Byte vivi alla fine rispetto all'inizio
+    uint64_t peak_rss_bytes{0};     // VmHWM del processo alla fine della misura (0 se non disponibile)
+};
+
+// Misura della memoria: begin() azzera il picco, end() restituisce il campione
+class AllocMeasure {
+public:
+    void begin();
+    AllocSample end() const;
+
+private:
+    AllocStats start;
+};
+
+// Funzione per leggere da /proc/self/status il picco di RSS (VmHWM) e l'RSS corrente (VmRSS), in byte
+uint64_t peakRssBytes();
+uint64_t currentRssBytes();
+
+#endif // MORPHOLOGY_ALLOC_TRACKER_HPP
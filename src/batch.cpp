@@ -0,0 +1,589 @@
+#include "batch.hpp"
+
+#include "morphology.hpp"
+#include "kernel_registry.hpp"
+
+#include <omp.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+using BatchClock = std::chrono::steady_clock;
+
+// Versione delle chiavi del giornale: va cambiata se cambia il significato di una voce
+static const char* const BATCH_KEY_VERSION = "morphology-batch-1";
+
+// Operazioni, versione ed elemento strutturante di un gruppo di voci
+struct BatchSpec {
+    std::vector<std::string> ops;
+    std::string mode;
+    StructuringElementSpec se_spec;
+    StructuringElement se;
+};
+
+struct BatchItem {
+    std::string input, output;
+    int spec{0};
+    uint64_t key{0};
+};
+
+// FNV-1a a 64 bit, sufficiente per distinguere le voci di un manifesto
+static uint64_t fnv1a(const std::string& text, uint64_t hash = 1469598103934665603ull) {
+    for (unsigned char c : text) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+static std::string hexKey(uint64_t key) {
+    std::ostringstream out;
+    out << std::hex << std::setw(16) << std::setfill('0') << key;
+    return out.str();
+}
+
+static std::string specText(const BatchSpec& spec) {
+    const StructuringElementSpec& se = spec.se_spec;
+    json fields = {se.shape, se.radius, se.width, se.height, se.length, se.angle, se.path, se.anchor_x, se.anchor_y};
+    std::string text = spec.mode + '\0' + fields.dump();
+    for (const auto& op : spec.ops) text += '\0' + op;
+    return text;
+}
+
+static std::string isoTime() {
+    std::time_t now = std::time(nullptr);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+    return buffer;
+}
+
+// LETTURA DEL MANIFESTO
+
+// Applica a spec i campi "ops", "mode" e "se" presenti in entry
+static void applySpecFields(const json& entry, BatchSpec& spec) {
+    if (entry.contains("ops")) spec.ops = entry["ops"].get<std::vector<std::string>>();
+    if (entry.contains("op")) spec.ops = {entry["op"].get<std::string>()};
+    if (entry.contains("mode")) spec.mode = entry["mode"].get<std::string>();
+    if (entry.contains("se")) spec.se_spec = parseStructuringElementSpec(entry["se"], spec.se_spec);
+}
+
+static bool validateSpec(const BatchSpec& spec, std::string& error) {
+    if (spec.ops.empty()) error = "nessuna operazione";
+    for (const auto& op : spec.ops)
+        if (operationIndex(op) < 0) error = "operazione sconosciuta: " + op;
+    if (spec.mode != "auto" && !findKernel(spec.mode)) error = "versione sconosciuta: " + spec.mode;
+    return error.empty();
+}
+
+// Funzione per leggere il manifesto; le voci con la stessa specifica la condividono
+static bool readManifest(const std::string& path, const BatchOptions& options, std::vector<BatchItem>& items, std::vector<BatchSpec>& specs) {
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "Impossibile aprire il manifesto: " << path << std::endl;
+        return false;
+    }
+    BatchSpec defaults;
+    defaults.ops = options.ops;
+    defaults.mode = options.mode;
+    defaults.se_spec = options.se_spec;
+
+    std::map<std::string, int> spec_index;
+    std::string line;
+    size_t line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+
+        BatchSpec spec = defaults;
+        BatchItem item;
+        std::string error;
+        if (line[first] == '{') {
+            json entry = json::parse(line, nullptr, false);
+            if (entry.is_discarded() || !entry.is_object()) {
+                error = "JSON non valido";
+            } else if (entry.contains("defaults")) {
+                try {
+                    applySpecFields(entry["defaults"], defaults);
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+                if (error.empty() && validateSpec(defaults, error)) continue;
+            } else {
+                try {
+                    item.input = entry.at("input").get<std::string>();
+                    item.output = entry.at("output").get<std::string>();
+                    applySpecFields(entry, spec);
+                } catch (const std::exception& e) {
+                    error = e.what();
+                }
+            }
+        } else {
+            std::istringstream fields(line);
+            std::string extra;
+            if (!(fields >> item.input >> item.output) || (fields >> extra)) error = "attesi ingresso e uscita";
+        }
+        if (error.empty()) validateSpec(spec, error);
+        if (!error.empty()) {
+            std::cerr << path << ":" << line_number << ": " << error << std::endl;
+            return false;
+        }
+
+        std::string text = specText(spec);
+        auto found = spec_index.find(text);
+        if (found == spec_index.end()) {
+            // Elemento strutturante costruito una volta per specifica (una maschera si legge qui)
+            try {
+                spec.se = makeStructuringElement(spec.se_spec);
+            } catch (const std::exception& e) {
+                std::cerr << path << ":" << line_number << ": " << e.what() << std::endl;
+                return false;
+            }
+            found = spec_index.emplace(text, (int)specs.size()).first;
+            specs.push_back(std::move(spec));
+        }
+        item.spec = found->second;
+        item.key = fnv1a(std::string(BATCH_KEY_VERSION) + '\0' + item.input + '\0' + item.output + '\0' + text);
+        items.push_back(std::move(item));
+    }
+    return true;
+}
+
+// GIORNALE
+
+// Funzione per leggere il giornale: stato finale di ogni chiave (true = completata).
+// Le righe non leggibili (l'ultima, se troncata da un arresto) si ignorano.
+static std::unordered_map<uint64_t, bool> readJournal(const std::string& path, size_t& ignored) {
+    std::unordered_map<uint64_t, bool> done;
+    ignored = 0;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        json entry = json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.is_object()) {
+            ignored++;
+            continue;
+        }
+        if (!entry.contains("key") || !entry["key"].is_string()) continue;
+        uint64_t key = std::strtoull(entry["key"].get<std::string>().c_str(), nullptr, 16);
+        bool ok = entry.value("status", std::string()) == "ok";
+        done[key] = done[key] || ok;
+    }
+    return done;
+}
+
+// Giornale in sola aggiunta con fsync a gruppi. Le righe restano in memoria fino alla sincronizzazione:
+// prima si sincronizzano i file system delle uscite, poi si scrivono e sincronizzano le righe, così una
+// voce non compare mai nel giornale prima che la sua uscita sia su disco.
+class BatchJournal {
+public:
+    ~BatchJournal() {
+        flush();
+        if (fd >= 0) close(fd);
+        for (auto& output : output_fs) close(output.second);
+    }
+
+    bool open(const std::string& path) {
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            std::cerr << "Impossibile aprire il giornale " << path << ": " << std::strerror(errno) << std::endl;
+            return false;
+        }
+        // Un'ultima riga troncata va chiusa, altrimenti la prossima riga si attaccherebbe a lei
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            int reader = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            char last = '\n';
+            if (reader >= 0) {
+                if (pread(reader, &last, 1, info.st_size - 1) != 1) last = '\n';
+                close(reader);
+            }
+            if (last != '\n') pending = "\n";
+        }
+        last_sync = BatchClock::now();
+        return true;
+    }
+
+    // Registra il file system della cartella di un'uscita, da sincronizzare prima del giornale
+    void watchOutput(const std::string& directory) {
+        struct stat info;
+        if (stat(directory.c_str(), &info) != 0 || output_fs.count(info.st_dev)) return;
+        int dir_fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (dir_fd >= 0) output_fs[info.st_dev] = dir_fd;
+    }
+
+    void append(const json& entry) {
+        pending += entry.dump() + "\n";
+        pending_items++;
+    }
+
+    // Sincronizza se sono state raggiunte le soglie di voci o di tempo
+    void maybeFlush(int every, int ms) {
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(BatchClock::now() - last_sync).count();
+        if (pending_items >= every || (pending_items > 0 && elapsed >= ms)) flush();
+    }
+
+    bool flush() {
+        if (fd < 0 || pending.empty()) return true;
+        for (auto& output : output_fs) syncfs(output.second);
+        size_t written = 0;
+        while (written < pending.size()) {
+            ssize_t n = write(fd, pending.data() + written, pending.size() - written);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) {
+                std::cerr << "Scrittura del giornale non riuscita: " << std::strerror(errno) << std::endl;
+                return false;
+            }
+            written += n;
+        }
+        fdatasync(fd);
+        pending.clear();
+        pending_items = 0;
+        syncs++;
+        last_sync = BatchClock::now();
+        return true;
+    }
+
+    size_t syncCount() const { return syncs; }
+
+private:
+    int fd{-1};
+    std::string pending;
+    int pending_items{0};
+    size_t syncs{0};
+    BatchClock::time_point last_sync;
+    std::map<dev_t, int> output_fs;
+};
+
+// AVANZAMENTO
+
+struct BatchProgress {
+    std::atomic<size_t> done{0}, errors{0};
+    std::atomic<uint64_t> pixels{0};
+};
+
+static std::string formatDuration(double seconds) {
+    if (!(seconds >= 0) || seconds > 1e8) return "?";
+    long total = (long)(seconds + 0.5);
+    std::ostringstream out;
+    out << std::setfill('0');
+    if (total >= 3600) out << total / 3600 << "h" << std::setw(2) << (total / 60) % 60 << "m";
+    else if (total >= 60) out << total / 60 << "m" << std::setw(2) << total % 60 << "s";
+    else out << total << "s";
+    return out.str();
+}
+
+// Riga di avanzamento: ritmo complessivo e recente (media esponenziale), stima del tempo rimanente
+// sul ritmo recente, che segue i cambi di dimensione delle immagini meglio della media complessiva
+class ProgressReporter {
+public:
+    ProgressReporter(const BatchProgress& progress, size_t todo, size_t skipped, double interval_s)
+        : progress(progress), todo(todo), skipped(skipped), interval_s(interval_s), start(BatchClock::now()) {
+        if (interval_s > 0) worker = std::thread([this] { loop(); });
+    }
+
+    ~ProgressReporter() { stop(); }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopped) return;
+            stopped = true;
+        }
+        wake.notify_all();
+        if (worker.joinable()) worker.join();
+        print();
+    }
+
+private:
+    void loop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, std::chrono::duration<double>(interval_s), [this] { return stopped; })) {
+            lock.unlock();
+            print();
+            lock.lock();
+        }
+    }
+
+    void print() {
+        auto now = BatchClock::now();
+        double elapsed = std::chrono::duration<double>(now - start).count();
+        size_t done = progress.done.load(std::memory_order_relaxed);
+        double since = std::chrono::duration<double>(now - last_time).count();
+        if (last_time == BatchClock::time_point()) since = elapsed;
+        if (since > 0) {
+            double rate = (done - last_done) / since;
+            recent_rate = recent_rate < 0 ? rate : 0.7 * recent_rate + 0.3 * rate;
+        }
+        last_time = now;
+        last_done = done;
+
+        double overall = elapsed > 0 ? done / elapsed : 0.0;
+        double rate = recent_rate > 0 ? recent_rate : overall;
+        double eta = rate > 0 ? (todo - done) / rate : -1.0;
+        std::cout << std::fixed << std::setprecision(1)
+                  << "[batch] " << done << "/" << todo << " (" << (todo ? 100.0 * done / todo : 100.0) << "%)"
+                  << "  " << overall << " img/s"
+                  << "  " << std::setprecision(2) << (elapsed > 0 ? progress.pixels.load(std::memory_order_relaxed) / elapsed / 1e6 : 0.0) << " Mpix/s"
+                  << "  recente " << std::setprecision(1) << std::max(recent_rate, 0.0) << " img/s"
+                  << "  ETA " << (done >= todo ? "0s" : formatDuration(eta))
+                  << "  errori " << progress.errors.load(std::memory_order_relaxed)
+                  << "  saltate " << skipped
+                  << "  trascorso " << formatDuration(elapsed) << std::endl;
+    }
+
+    const BatchProgress& progress;
+    size_t todo, skipped;
+    double interval_s;
+    BatchClock::time_point start, last_time{};
+    size_t last_done{0};
+    double recent_rate{-1.0};
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopped{false};
+    std::thread worker;
+};
+
+// ELABORAZIONE
+
+static std::atomic<bool> batch_interrupted{false};
+
+static void batchSignalHandler(int) {
+    batch_interrupted.store(true);
+}
+
+// Nome temporaneo nella stessa cartella dell'uscita, con la stessa estensione (saveImage sceglie il
+// formato dall'estensione); il rename finale sostituisce l'uscita in modo atomico
+static std::string partialName(const std::string& output) {
+    std::filesystem::path path(output);
+    std::filesystem::path partial = path.parent_path() / (path.stem().string() + ".part" + path.extension().string());
+    return partial.string();
+}
+
+// Funzione per elaborare una voce; error riceve il motivo di un fallimento
+static bool processItem(const BatchItem& item, const BatchSpec& spec, const BatchOptions& options, uint64_t& pixels, std::string& error) {
+    STBImage img;
+    if (!img.loadImage(item.input)) {
+        error = "impossibile leggere l'immagine";
+        return false;
+    }
+    size_t count = (size_t)img.width * img.height * img.channels;
+    if (!isBinaryPixels(img.image_data, count)) binarizePixels(img.image_data, count);
+    pixels = (uint64_t)img.width * img.height;
+
+    try {
+        STBImage result = std::move(img);
+        for (const auto& op : spec.ops)
+            result = applyOperation(result, spec.se, op, spec.mode, options.tile_size, options.background);
+        std::string partial = partialName(item.output);
+        std::remove(partial.c_str());
+        if (!result.saveImage(partial)) {
+            error = "scrittura dell'uscita non riuscita";
+            std::remove(partial.c_str());
+            return false;
+        }
+        if (std::rename(partial.c_str(), item.output.c_str()) != 0) {
+            error = std::string("rename non riuscita: ") + std::strerror(errno);
+            std::remove(partial.c_str());
+            return false;
+        }
+    } catch (const std::exception& e) {
+        error = e.what();
+        return false;
+    }
+    return true;
+}
+
+int runBatch(const std::string& manifest_path, const BatchOptions& options) {
+    std::vector<BatchItem> items;
+    std::vector<BatchSpec> specs;
+    if (!readManifest(manifest_path, options, items, specs)) return 1;
+
+    std::string journal_path = options.journal_path.empty() ? manifest_path + ".journal" : options.journal_path;
+    size_t ignored = 0;
+    std::unordered_map<uint64_t, bool> journal = readJournal(journal_path, ignored);
+    if (ignored > 0) std::cout << "Giornale: " << ignored << " righe non leggibili ignorate" << std::endl;
+
+    // Voci da elaborare; le chiavi duplicate nel manifesto si elaborano una volta
+    std::vector<size_t> todo;
+    std::set<uint64_t> queued;
+    size_t skipped = 0, previous_errors = 0;
+    for (size_t i = 0; i < items.size(); i++) {
+        auto found = journal.find(items[i].key);
+        bool finished = found != journal.end() && (found->second || !options.retry_failed);
+        if (found != journal.end() && !found->second) previous_errors++;
+        if (finished || !queued.insert(items[i].key).second) {
+            skipped++;
+            continue;
+        }
+        todo.push_back(i);
+    }
+    std::cout << "Manifesto: " << items.size() << " voci, " << specs.size() << " specifiche, "
+              << skipped << " già completate o duplicate, " << todo.size() << " da elaborare";
+    if (previous_errors > 0) std::cout << " (" << previous_errors << " fallite in precedenza" << (options.retry_failed ? ", riprovate" : "") << ")";
+    std::cout << std::endl;
+    if (todo.empty()) return 0;
+
+    BatchJournal writer;
+    if (!writer.open(journal_path)) return 1;
+    writer.append({{"run_start", isoTime()}, {"manifest", manifest_path}, {"items", items.size()}, {"todo", todo.size()}});
+    writer.flush();
+
+    if (std::any_of(specs.begin(), specs.end(), [](const BatchSpec& spec) { return spec.mode == "auto"; }))
+        calibrateKernels();
+
+    batch_interrupted.store(false);
+    auto previous_int = std::signal(SIGINT, batchSignalHandler);
+    auto previous_term = std::signal(SIGTERM, batchSignalHandler);
+
+    BatchProgress progress;
+    ProgressReporter reporter(progress, todo.size(), skipped, options.progress_s);
+    size_t chunk = (size_t)std::max(options.chunk, 1);
+    std::vector<json> entries;
+    std::set<std::string> directories;
+
+    for (size_t begin = 0; begin < todo.size() && !batch_interrupted.load(); begin += chunk) {
+        size_t end = std::min(begin + chunk, todo.size());
+
+        // Preparazione sequenziale: cartelle di uscita del blocco
+        bool intra_parallel = false;
+        for (size_t t = begin; t < end; t++) {
+            const BatchItem& item = items[todo[t]];
+            const BatchSpec& spec = specs[item.spec];
+            // Una versione parallela usa già tutti i thread su ogni immagine
+            intra_parallel = intra_parallel || (spec.mode != "auto" && isParallelMode(spec.mode));
+            std::string directory = std::filesystem::path(item.output).parent_path().string();
+            if (directory.empty()) directory = ".";
+            if (directories.insert(directory).second) {
+                std::error_code ignored_error;
+                std::filesystem::create_directories(directory, ignored_error);
+                writer.watchOutput(directory);
+            }
+        }
+
+        entries.assign(end - begin, json());
+        #pragma omp parallel for schedule(dynamic) if(!intra_parallel) shared(begin, end, todo, items, specs, options, entries, progress) default(none)
+        for (size_t t = begin; t < end; t++) {
+            const BatchItem& item = items[todo[t]];
+            uint64_t pixels = 0;
+            std::string error;
+            double start = omp_get_wtime();
+            bool ok = processItem(item, specs[item.spec], options, pixels, error);
+            json entry = {{"key", hexKey(item.key)}, {"input", item.input}, {"status", ok ? "ok" : "error"},
+                          {"ms", std::round((omp_get_wtime() - start) * 1e5) / 100}};
+            if (!ok) entry["error"] = error;
+            entries[t - begin] = std::move(entry);
+            progress.pixels.fetch_add(pixels, std::memory_order_relaxed);
+            if (!ok) progress.errors.fetch_add(1, std::memory_order_relaxed);
+            progress.done.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        for (size_t t = begin; t < end; t++) {
+            if (entries[t - begin].value("status", std::string()) != "ok")
+                std::cerr << "Errore su " << items[todo[t]].input << ": " << entries[t - begin].value("error", std::string()) << std::endl;
+            writer.append(entries[t - begin]);
+        }
+        writer.maybeFlush(options.fsync_every, options.fsync_ms);
+    }
+    writer.flush();
+    reporter.stop();
+
+    std::signal(SIGINT, previous_int);
+    std::signal(SIGTERM, previous_term);
+
+    size_t done = progress.done.load(), errors = progress.errors.load();
+    std::cout << "Completate " << done - errors << ", fallite " << errors << ", sincronizzazioni del giornale " << writer.syncCount() << std::endl;
+    if (batch_interrupted.load()) {
+        std::cout << "Interrotto: " << todo.size() - done << " voci rimaste, si riprende rilanciando lo stesso comando" << std::endl;
+        return 130;
+    }
+    return errors > 0 ? 1 : 0;
+}
+
+int runBatchCommand(int argc, char* argv[], BatchOptions options) {
+    if (argc < 1) {
+        std::cerr << "Uso: batch <manifesto> [--journal PERCORSO] [--chunk N] [--fsync-every N] [--fsync-ms N] "
+                     "[--progress-s S] [--mode VERSIONE] [--ops op1,op2] [--skip-failed]" << std::endl;
+        return 1;
+    }
+    std::string manifest_path = argv[0];
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--skip-failed") {
+            options.retry_failed = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--journal") options.journal_path = value;
+        else if (arg == "--chunk") options.chunk = std::max(std::stoi(value), 1);
+        else if (arg == "--fsync-every") options.fsync_every = std::max(std::stoi(value), 1);
+        else if (arg == "--fsync-ms") options.fsync_ms = std::max(std::stoi(value), 0);
+        else if (arg == "--progress-s") options.progress_s = std::stod(value);
+        else if (arg == "--mode") options.mode = value;
+        else if (arg == "--ops") {
+            options.ops.clear();
+            std::istringstream list(value);
+            std::string op;
+            while (std::getline(list, op, ',')) if (!op.empty()) options.ops.push_back(op);
+        }
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+    }
+    return runBatch(manifest_path, options);
+}
+
+int runManifestCommand(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Uso: manifest <cartella> <cartella_uscita> <manifesto.jsonl> [op1,op2]" << std::endl;
+        return 1;
+    }
+    std::string input_dir = argv[0], output_dir = argv[1], manifest_path = argv[2];
+    std::error_code error;
+    if (!std::filesystem::is_directory(input_dir, error)) {
+        std::cerr << "Cartella non trovata: " << input_dir << std::endl;
+        return 1;
+    }
+    std::ofstream out(manifest_path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Impossibile scrivere il manifesto: " << manifest_path << std::endl;
+        return 1;
+    }
+    if (argc >= 4) {
+        json ops = json::array();
+        std::istringstream list(argv[3]);
+        std::string op;
+        while (std::getline(list, op, ',')) if (!op.empty()) ops.push_back(op);
+        out << json{{"defaults", {{"ops", ops}}}}.dump() << "\n";
+    }
+    size_t count = 0;
+    for (const auto& input : listImageFiles(input_dir)) {
+        std::string output = (std::filesystem::path(output_dir) / std::filesystem::path(input).filename()).string();
+        out << json{{"input", input}, {"output", output}}.dump() << "\n";
+        count++;
+    }
+    std::cout << "Manifesto " << manifest_path << ": " << count << " voci" << std::endl;
+    return out ? 0 : 1;
+}
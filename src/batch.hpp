@@ -0,0 +1,47 @@
+#ifndef MORPHOLOGY_BATCH_HPP
+#define MORPHOLOGY_BATCH_HPP
+
+#include "image.hpp"
+
+// ELABORAZIONE DA MANIFESTO CON RIPRESA
+//
+// Per i lavori notturni su centinaia di migliaia di immagini: un manifesto elenca ingressi, uscite e
+// catena di operazioni; le voci si elaborano a blocchi, in parallelo all'interno di ogni blocco.
+// Ogni voce completata è aggiunta a un giornale (JSON-lines in sola aggiunta) identificata da una chiave
+// (hash di ingresso, uscita, operazioni, elemento strutturante e versione): al riavvio le voci già
+// presenti nel giornale si saltano, quindi un'interruzione costa al più il blocco in corso.
+//
+// Le uscite si scrivono in un file temporaneo rinominato a fine scrittura. Il giornale si sincronizza
+// (fsync) a gruppi, ogni --fsync-every voci o --fsync-ms millisecondi, dopo aver sincronizzato i file
+// system delle uscite: una voce registrata ha la sua uscita su disco. Un'ultima riga troncata da un
+// arresto improvviso viene ignorata alla lettura.
+//
+// Manifesto: una voce per riga, {"input", "output"} con "ops", "se" (come structuring_element nella
+// configurazione: "shape", "radius", "width", "path", ...) e "mode" facoltativi, oppure "ingresso uscita"
+// su una riga di testo. Una riga {"defaults": {...}} cambia i valori predefiniti delle righe successive.
+
+struct BatchOptions {
+    std::string journal_path;           // Vuoto = <manifesto>.journal
+    int chunk{256};                     // Voci per blocco
+    int fsync_every{256};               // Voci registrate fra due fsync del giornale
+    int fsync_ms{1000};                 // Tempo massimo fra due fsync
+    double progress_s{2.0};             // Intervallo fra due righe di avanzamento
+    bool retry_failed{true};            // Riprova le voci fallite in un'esecuzione precedente
+    std::vector<std::string> ops{"opening"};
+    std::string mode{"V1"};
+    StructuringElementSpec se_spec;
+    int tile_size{64};
+    uint8_t background{DEFAULT_BACKGROUND_COLOR};
+};
+
+// Funzione per elaborare un manifesto; restituisce 0 se tutte le voci sono completate
+int runBatch(const std::string& manifest_path, const BatchOptions& options);
+
+// Comando "batch <manifesto> [opzioni]": le opzioni da riga di comando sovrascrivono i valori predefiniti
+int runBatchCommand(int argc, char* argv[], BatchOptions options);
+
+// Comando "manifest <cartella> <cartella_uscita> <manifesto> [operazioni]": un manifesto per tutte le
+// immagini di una cartella, con le uscite nella cartella di uscita e lo stesso nome
+int runManifestCommand(int argc, char* argv[]);
+
+#endif // MORPHOLOGY_BATCH_HPP
@@ -0,0 +1,713 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <sstream>
+#include <numeric>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <omp.h>
+
+#include "image.hpp"
+#include "morphology.hpp"
+#include "cli.hpp"
+#include "perf_counters.hpp"
+#include "trace.hpp"
+#include "throughput.hpp"
+#include "generator.hpp"
+#include "results_store.hpp"
+#include "alloc_tracker.hpp"
+#include "kernel_registry.hpp"
+
+// DRIVER DI BENCHMARK
+//
+// Sostituisce il ciclo fisso di main(): operazioni, versioni, thread, dimensioni e raggi si scelgono
+// da riga di comando, ogni misura ha warm-up e ripetizioni e produce statistiche (min, mediana, p95,
+// deviazione standard, Mpix/s) scritte in JSON e CSV con uno schema versionato.
+// Se disponibili, i contatori hardware (cicli, istruzioni, miss L1D/LLC e di branch, sommati su tutti
+// i thread) sono mediati sulle ripetizioni e riportati insieme a IPC e miss per pixel.
+// Il throughput assoluto (GB/s, confronti/s) è confrontato con la banda misurata all'avvio.
+// Dimensioni, raggi, forme e thread formano un prodotto cartesiano eseguito in un solo processo;
+// per le versioni parallele si riportano scalabilità forte o debole e, solo per quella forte, la stima
+// di Karp–Flatt (definita per un problema fisso, non per lo speedup scalato).
+// Per le versioni parallele si raccolgono per thread tempo di calcolo, attesa alle barriere e iterazioni:
+// sbilanciamento (massimo/medio) e percentuale di attesa accompagnano le tabelle di scalabilità.
+// Ogni esecuzione è aggiunta all'archivio dei risultati; "morpho_bench compare" la confronta con una precedente.
+// La versione "auto" sceglie per ogni chiamata la versione più veloce secondo il modello di costo calibrato:
+// le scelte, con il tempo previsto e quello misurato, sono scritte in un CSV a parte.
+
+const int BENCH_SCHEMA_VERSION = 7;
+
+struct BenchOptions {
+    std::vector<std::string> ops{"erosion", "dilation", "opening", "closing"};
+    std::vector<std::string> engines{"V1", "V2", "V3", "V4", "V1_parallel", "V2_parallel", "V3_parallel", "V4_parallel"};
+    std::vector<int> threads{1, 2, 4, 8};
+    std::vector<std::pair<int, int>> sizes{{400, 400}};
+    std::vector<int> radii{5};
+    std::vector<std::string> shapes{"disk"};
+    std::string scaling{"strong"};  // strong: problema fisso; weak: area proporzionale ai thread; none
+    std::string input{};        // Cartella o contenitore .mpk al posto delle immagini generate
+    int images{10};
+    int shapes_per_image{3};    // Forme massime per immagine nel profilo default
+    std::string profile{"default"}; // Profilo del generatore: default, sparse, dense, noisy, lines
+    int warmup{1};
+    int reps{5};
+    int tile_size{64};
+    unsigned seed{42};
+    bool batch{false};          // Misura le funzioni _imgvec invece del ciclo immagine per immagine
+    bool perf{true};            // Raccoglie i contatori hardware con perf_event_open
+    bool balance{true};         // Raccoglie il bilanciamento del carico delle versioni parallele
+    int bandwidth_mb{64};       // Dimensione degli array della sonda di banda (0 = nessuna sonda)
+    std::string json_path{"results/bench.json"};
+    std::string csv_path{"results/bench.csv"};
+    std::string scaling_csv_path{"results/bench_scaling.csv"};
+    std::string trace_path{};   // Timeline Chrome trace scritta all'uscita (anche con MORPHO_TRACE)
+    std::string store_path{"results/store.jsonl"}; // Archivio JSON-lines delle esecuzioni (vuoto = nessuno)
+    std::string decisions_path{"results/kernel_decisions.csv"}; // Scelte della versione "auto"
+};
+
+struct BenchStats {
+    double min{0}, median{0}, p95{0}, mean{0}, stddev{0};
+};
+
+struct BenchResult {
+    std::string op, engine;
+    int threads{1}, width{0}, height{0}, images{0}, radius{0};
+    int base_width{0}, base_height{0}; // Dimensione di partenza (diversa da width x height in scalabilità debole)
+    std::string shape;
+    double pixels{0};           // Pixel elaborati per ripetizione
+    std::vector<double> times;
+    BenchStats stats;
+    double mpix_per_s{0};
+    TrafficModel traffic;
+    ThroughputMetrics throughput; // Calcolate sulla mediana
+    PerfSample counters;        // Media per ripetizione
+    BalanceReport balance;      // Somma sulle ripetizioni misurate (solo versioni parallele)
+    AllocSample memory;         // Allocazioni e byte per ripetizione, picchi sull'insieme delle ripetizioni
+    std::map<std::string, int> auto_choices; // Versioni scelte da "auto" nelle ripetizioni misurate
+};
+
+// Scalabilità di una versione parallela rispetto alla sua esecuzione con un thread
+struct ScalingResult {
+    std::string op, engine, shape;
+    int radius{0}, base_width{0}, base_height{0};
+    int threads{1}, width{0}, height{0};
+    double median{0};
+    double speedup{0};          // Forte: T1/Tp; debole: speedup scalato p*T1/Tp (Gustafson)
+    double efficiency{0};
+    double karp_flatt{NAN};     // Frazione seriale stimata, solo in scalabilità forte e per p > 1
+    double imbalance{NAN};      // Calcolo massimo / medio fra i thread
+    double barrier_wait_fraction{NAN};
+    double lock_fraction{NAN};
+};
+
+// Funzione per calcolare le statistiche di una serie di tempi
+BenchStats computeStats(std::vector<double> times) {
+    BenchStats stats;
+    if (times.empty()) return stats;
+    std::sort(times.begin(), times.end());
+    size_t n = times.size();
+    stats.min = times.front();
+    stats.median = n % 2 ? times[n / 2] : (times[n / 2 - 1] + times[n / 2]) / 2.0;
+    stats.p95 = times[std::min(n - 1, (size_t)std::ceil(0.95 * n) - 1)];
+    stats.mean = std::accumulate(times.begin(), times.end(), 0.0) / n;
+    double sq = 0.0;
+    for (double t : times) sq += (t - stats.mean) * (t - stats.mean);
+    stats.stddev = n > 1 ? std::sqrt(sq / (n - 1)) : 0.0;
+    return stats;
+}
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " [opzioni]\n"
+              << "  --ops LISTA          operazioni (erosion,dilation,opening,closing)\n"
+              << "  --engines LISTA      versioni (V1,V2,V3,V4,V1_parallel,V2_parallel,V3_parallel,V4_parallel,auto)\n"
+              << "  --threads LISTA      numeri di thread per le versioni parallele (1,2,4,8)\n"
+              << "  --sizes LISTA        dimensioni delle immagini generate, LxA o N (400x400)\n"
+              << "  --radii LISTA        raggi dell'elemento strutturante (5)\n"
+              << "  --shapes LISTA       forme dell'elemento strutturante dal solo raggio: disk, square, cross, diamond, octagon, ellipse, rectangle, line (disk)\n"
+              << "  --scaling MODO       strong (problema fisso), weak (area x thread) o none (strong)\n"
+              << "  --config PERCORSO    legge le liste dalla sezione \"sweep\" di un file di configurazione\n"
+              << "  --input PERCORSO     cartella o contenitore .mpk da usare al posto delle immagini generate\n"
+              << "  --images N           immagini generate per dimensione (10)\n"
+              << "  --shapes-per-image N forme massime per immagine generata nel profilo default (3)\n"
+              << "  --profile NOME       profilo delle immagini generate: default, sparse, dense, noisy, lines\n"
+              << "  --warmup N           esecuzioni di warm-up non misurate (1)\n"
+              << "  --reps N             ripetizioni misurate (5)\n"
+              << "  --tile-size N        lato dei tile per V3 (64)\n"
+              << "  --seed N             seme del generatore (42)\n"
+              << "  --batch              misura le funzioni sul vettore di immagini (_imgvec)\n"
+              << "  --no-perf            non raccoglie i contatori hardware\n"
+              << "  --no-balance         non raccoglie il bilanciamento del carico per thread\n"
+              << "  --bandwidth-mb N     MB per array della sonda di banda, 0 per non eseguirla (64)\n"
+              << "  --json PERCORSO      file JSON dei risultati (results/bench.json)\n"
+              << "  --csv PERCORSO       file CSV dei risultati (results/bench.csv)\n"
+              << "  --scaling-csv PERC.  file CSV della scalabilità (results/bench_scaling.csv)\n"
+              << "  --trace PERCORSO     timeline Chrome trace / Perfetto scritta all'uscita\n"
+              << "  --store PERCORSO     archivio JSON-lines a cui aggiungere l'esecuzione (results/store.jsonl)\n"
+              << "  --no-store           non aggiunge l'esecuzione all'archivio\n"
+              << "  --decisions PERC.    file CSV delle scelte della versione auto (results/kernel_decisions.csv)\n"
+              << "Uso: " << program << " compare [--store PERCORSO] [--base SEL] [--candidate SEL] [--alpha P] [--min-change F] [--list]\n"
+              << "  confronta due esecuzioni dell'archivio e segnala i rallentamenti significativi\n";
+}
+
+// Funzione per applicare la sezione "sweep" di un file di configurazione (le opzioni successive la sovrascrivono)
+bool loadSweepConfig(const std::string& path, BenchOptions& options) {
+    std::ifstream file(path);
+    if (!file) {
+        std::cerr << "File di configurazione non leggibile: " << path << std::endl;
+        return false;
+    }
+    json config = json::parse(file, nullptr, false);
+    if (config.is_discarded() || !config.contains("sweep")) {
+        std::cerr << "Sezione \"sweep\" mancante in " << path << std::endl;
+        return false;
+    }
+    const json& sweep = config["sweep"];
+    // Una chiave del tipo sbagliato fa fallire il caricamento indicando quale, come readField in config.cpp
+    std::string key;
+    try {
+        if (sweep.contains(key = "ops")) options.ops = sweep[key].get<std::vector<std::string>>();
+        if (sweep.contains(key = "engines")) options.engines = sweep[key].get<std::vector<std::string>>();
+        if (sweep.contains(key = "threads")) options.threads = sweep[key].get<std::vector<int>>();
+        if (sweep.contains(key = "radii")) options.radii = sweep[key].get<std::vector<int>>();
+        if (sweep.contains(key = "shapes")) options.shapes = sweep[key].get<std::vector<std::string>>();
+        if (sweep.contains(key = "scaling")) options.scaling = sweep[key].get<std::string>();
+        if (sweep.contains(key = "sizes")) {
+            options.sizes.clear();
+            for (const auto& size : sweep[key]) {
+                auto parsed = parseSizeList(size.get<std::string>());
+                options.sizes.insert(options.sizes.end(), parsed.begin(), parsed.end());
+            }
+        }
+    } catch (const json::exception& e) {
+        std::cerr << "Valore non valido per sweep." << key << " in " << path << ": " << e.what() << std::endl;
+        return false;
+    } catch (const std::logic_error&) {
+        // parseSizeList usa std::stoi sulle dimensioni "LxA"
+        std::cerr << "Valore non valido per sweep." << key << " in " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (arg == "--batch") {
+            options.batch = true;
+            continue;
+        }
+        if (arg == "--no-perf") {
+            options.perf = false;
+            continue;
+        }
+        if (arg == "--no-balance") {
+            options.balance = false;
+            continue;
+        }
+        if (arg == "--no-store") {
+            options.store_path.clear();
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--ops") options.ops = splitList(value);
+        else if (arg == "--engines") options.engines = splitList(value);
+        else if (arg == "--threads") options.threads = parseIntList(value);
+        else if (arg == "--sizes") options.sizes = parseSizeList(value);
+        else if (arg == "--radii") options.radii = parseIntList(value);
+        else if (arg == "--shapes" || arg == "--shape") options.shapes = splitList(value);
+        else if (arg == "--scaling") options.scaling = value;
+        else if (arg == "--scaling-csv") options.scaling_csv_path = value;
+        else if (arg == "--config") {
+            if (!loadSweepConfig(value, options)) return false;
+        }
+        else if (arg == "--input") options.input = value;
+        else if (arg == "--images") options.images = std::stoi(value);
+        else if (arg == "--shapes-per-image") options.shapes_per_image = std::stoi(value);
+        else if (arg == "--profile") options.profile = value;
+        else if (arg == "--warmup") options.warmup = std::stoi(value);
+        else if (arg == "--reps") options.reps = std::stoi(value);
+        else if (arg == "--tile-size") options.tile_size = std::stoi(value);
+        else if (arg == "--seed") options.seed = std::stoul(value);
+        else if (arg == "--json") options.json_path = value;
+        else if (arg == "--csv") options.csv_path = value;
+        else if (arg == "--trace") options.trace_path = value;
+        else if (arg == "--store") options.store_path = value;
+        else if (arg == "--decisions") options.decisions_path = value;
+        else if (arg == "--bandwidth-mb") options.bandwidth_mb = std::stoi(value);
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    for (const auto& shape : options.shapes) {
+        const auto& shapes = availableStructuringElementShapes();
+        // "mask" richiede un file, qui le forme dipendono solo dal raggio
+        if (shape == "mask" || std::find(shapes.begin(), shapes.end(), shape) == shapes.end()) {
+            std::cerr << "Forma dell'elemento strutturante non valida: " << shape << std::endl;
+            return false;
+        }
+    }
+    for (const auto& engine : options.engines) {
+        if (engine != "auto" && !findKernel(engine)) {
+            std::cerr << "Versione non valida: " << engine << std::endl;
+            return false;
+        }
+    }
+    if (options.scaling != "strong" && options.scaling != "weak" && options.scaling != "none") {
+        std::cerr << "Modalità di scalabilità non valida: " << options.scaling << std::endl;
+        return false;
+    }
+    if (options.scaling == "weak" && !options.input.empty()) {
+        std::cerr << "La scalabilità debole richiede immagini generate (senza --input)" << std::endl;
+        return false;
+    }
+    // La scalabilità si misura rispetto all'esecuzione con un thread
+    if (options.scaling != "none" && std::find(options.threads.begin(), options.threads.end(), 1) == options.threads.end()) {
+        options.threads.insert(options.threads.begin(), 1);
+    }
+    options.reps = std::max(options.reps, 1);
+    options.warmup = std::max(options.warmup, 0);
+    return true;
+}
+
+// Funzione per misurare una combinazione (operazione, versione, thread) sulle immagini date
+BenchResult runMeasurement(const std::vector<STBImage>& images, const StructuringElement& se,
+    const std::string& op, const std::string& engine, int threads, const BenchOptions& options,
+    double machine_gb_per_s) {
+    BenchResult result;
+    result.op = op;
+    result.engine = engine;
+    result.threads = threads;
+    result.images = images.size();
+    for (const auto& img : images) result.pixels += (double)img.width * img.height;
+
+    omp_set_num_threads(threads);
+    auto runOnce = [&]() {
+        if (options.batch) {
+            applyOperationImgVec(images, se, op, engine, options.tile_size, DEFAULT_BACKGROUND_COLOR);
+        } else {
+            for (const auto& img : images) {
+                applyOperation(img, se, op, engine, options.tile_size, DEFAULT_BACKGROUND_COLOR);
+            }
+        }
+    };
+
+    for (int i = 0; i < options.warmup; i++) runOnce();
+    bool balance = options.balance && isParallelMode(engine);
+    if (balance) startBalance();
+    // Conteggi cumulativi: il registro delle scelte è circolare e non si può indicizzare per posizione
+    std::map<std::string, size_t> chosen_before = kernelDecisionStats().chosen;
+    AllocMeasure memory_measure;
+    memory_measure.begin();
+    PerfSample counters;
+    for (int i = 0; i < options.reps; i++) {
+        // I contatori si leggono fuori dall'intervallo cronometrato
+        PerfSample before = readPerfCounters();
+        double start = omp_get_wtime();
+        runOnce();
+        result.times.push_back(omp_get_wtime() - start);
+        PerfSample delta = readPerfCounters() - before;
+        if (i == 0) counters = delta;
+        else counters += delta;
+    }
+    result.memory = memory_measure.end();
+    result.memory.allocations /= options.reps;
+    result.memory.bytes_allocated /= options.reps;
+    if (balance) result.balance = stopBalance();
+    if (engine == "auto") {
+        for (const auto& chosen : kernelDecisionStats().chosen) {
+            int count = (int)(chosen.second - chosen_before[chosen.first]);
+            if (count > 0) result.auto_choices[chosen.first] = count;
+        }
+    }
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        if (counters.has(id)) counters.values[id] /= options.reps;
+    }
+    result.counters = counters;
+    result.stats = computeStats(result.times);
+    result.traffic = estimateTraffic(op, se, result.pixels);
+    result.throughput = computeThroughput(result.traffic, result.stats.median, machine_gb_per_s);
+    result.mpix_per_s = result.throughput.mpix_per_s;
+    return result;
+}
+
+// Campo CSV di un valore che può mancare (contatore non disponibile)
+std::string csvField(double value) {
+    if (std::isnan(value)) return "NA";
+    std::ostringstream stream;
+    stream << std::setprecision(9) << value;
+    return stream.str();
+}
+
+// Frazione seriale sperimentale di Karp–Flatt: e = (1/S - 1/p) / (1 - 1/p)
+double karpFlatt(double speedup, int threads) {
+    if (threads <= 1 || speedup <= 0) return NAN;
+    return (1.0 / speedup - 1.0 / threads) / (1.0 - 1.0 / threads);
+}
+
+// Funzione per calcolare la scalabilità delle versioni parallele rispetto alla misura con un thread
+std::vector<ScalingResult> computeScaling(const std::vector<BenchResult>& results, const std::string& mode) {
+    std::vector<ScalingResult> scaling;
+    if (mode == "none") return scaling;
+    for (const auto& r : results) {
+        if (!isParallelMode(r.engine)) continue;
+        const BenchResult* base = nullptr;
+        for (const auto& b : results) {
+            if (b.threads == 1 && b.op == r.op && b.engine == r.engine && b.shape == r.shape && b.radius == r.radius &&
+                b.base_width == r.base_width && b.base_height == r.base_height) {
+                base = &b;
+                break;
+            }
+        }
+        if (!base || r.stats.median <= 0) continue;
+
+        ScalingResult s;
+        s.op = r.op;
+        s.engine = r.engine;
+        s.shape = r.shape;
+        s.radius = r.radius;
+        s.base_width = r.base_width;
+        s.base_height = r.base_height;
+        s.threads = r.threads;
+        s.width = r.width;
+        s.height = r.height;
+        s.median = r.stats.median;
+        double ratio = base->stats.median / r.stats.median;
+        // In scalabilità debole il lavoro cresce con i thread: lo speedup è quello scalato,
+        // riportato all'area effettivamente elaborata
+        double work = mode == "weak" ? r.pixels / base->pixels : 1.0;
+        s.speedup = ratio * work;
+        s.efficiency = s.speedup / r.threads;
+        // Karp–Flatt presuppone un problema fisso: con lo speedup scalato non stima la frazione seriale
+        if (mode == "strong") s.karp_flatt = karpFlatt(s.speedup, r.threads);
+        s.imbalance = r.balance.imbalance;
+        s.barrier_wait_fraction = r.balance.barrier_wait_fraction;
+        s.lock_fraction = r.balance.lock_fraction;
+        scaling.push_back(s);
+    }
+    return scaling;
+}
+
+void writeScalingCsv(const std::string& path, const std::string& mode, const std::vector<ScalingResult>& scaling) {
+    std::ofstream out(path, std::ofstream::trunc);
+    out << "schema_version,scaling,op,engine,se_shape,se_radius,base_width,base_height,threads,width,height,median_s,speedup,efficiency,karp_flatt,"
+        << "imbalance,barrier_wait_fraction,lock_fraction\n";
+    out << std::setprecision(9);
+    for (const auto& s : scaling) {
+        out << BENCH_SCHEMA_VERSION << "," << mode << "," << s.op << "," << s.engine << "," << s.shape << "," << s.radius << ","
+            << s.base_width << "," << s.base_height << "," << s.threads << "," << s.width << "," << s.height << ","
+            << s.median << "," << s.speedup << "," << s.efficiency << ","
+            << csvField(s.karp_flatt) << ","
+            << csvField(s.imbalance) << "," << csvField(s.barrier_wait_fraction) << "," << csvField(s.lock_fraction) << "\n";
+    }
+}
+
+// Opzioni che determinano il carico misurato, registrate nel JSON e nell'archivio dei risultati
+json optionsJson(const BenchOptions& options) {
+    return {
+        {"warmup", options.warmup}, {"reps", options.reps}, {"batch", options.batch},
+        {"tile_size", options.tile_size}, {"seed", options.seed}, {"input", options.input}, {"profile", options.profile},
+        {"shapes_per_image", options.shapes_per_image}, {"omp_max_threads", omp_get_max_threads()},
+        {"perf_counters", perfCountersStatus()}, {"scaling", options.scaling}
+    };
+}
+
+void writeJson(const std::string& path, const BenchOptions& options, const BandwidthProbe& probe,
+    const std::vector<BenchResult>& results, const std::vector<ScalingResult>& scaling) {
+    json doc;
+    doc["schema"] = "morphology-bench";
+    doc["schema_version"] = BENCH_SCHEMA_VERSION;
+    doc["timestamp"] = (long long)std::time(nullptr);
+    doc["options"] = optionsJson(options);
+    doc["machine"] = {
+        {"copy_gb_per_s", probe.copy_gb_per_s}, {"triad_gb_per_s", probe.triad_gb_per_s},
+        {"probe_array_bytes", probe.array_bytes}, {"probe_threads", probe.threads}
+    };
+    doc["kernel_costs"] = json::array();
+    for (const auto& entry : kernelRegistry()) {
+        if (!entry.cost.calibrated) continue;
+        doc["kernel_costs"].push_back({
+            {"engine", entry.mode}, {"pixel_ns", entry.cost.pixel_ns}, {"check_ns", entry.cost.check_ns},
+            {"parallel_fraction", entry.cost.parallel_fraction}, {"parallel_calibrated", entry.cost.parallel_calibrated}
+        });
+    }
+    doc["results"] = json::array();
+    auto numberOrNull = [](double value) { return std::isnan(value) ? json(nullptr) : json(value); };
+    for (const auto& r : results) {
+        json per_thread = json::array();
+        for (const auto& t : r.balance.threads) {
+            per_thread.push_back({
+                {"compute_s", t.compute_ns * 1e-9}, {"barrier_s", t.barrier_ns * 1e-9}, {"lock_s", t.lock_ns * 1e-9},
+                {"iterations", t.iterations}, {"regions", t.regions}
+            });
+        }
+        json balance = {
+            {"threads", per_thread}, {"imbalance", numberOrNull(r.balance.imbalance)},
+            {"iteration_imbalance", numberOrNull(r.balance.iteration_imbalance)},
+            {"barrier_wait_fraction", numberOrNull(r.balance.barrier_wait_fraction)},
+            {"lock_fraction", numberOrNull(r.balance.lock_fraction)}
+        };
+        json counters = json::object();
+        for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+            counters[perfCounterName(id)] = r.counters.has(id) ? json(r.counters.values[id]) : json(nullptr);
+        }
+        json memory = {
+            {"allocations_per_rep", r.memory.allocations}, {"bytes_allocated_per_rep", r.memory.bytes_allocated},
+            {"peak_live_bytes", r.memory.peak_live_bytes}, {"peak_extra_bytes", r.memory.peak_extra_bytes},
+            {"retained_bytes", r.memory.retained_bytes}, {"peak_rss_bytes", r.memory.peak_rss_bytes}
+        };
+        doc["results"].push_back({
+            {"op", r.op}, {"engine", r.engine}, {"threads", r.threads},
+            {"width", r.width}, {"height", r.height}, {"images", r.images},
+            {"base_width", r.base_width}, {"base_height", r.base_height},
+            {"se_shape", r.shape}, {"se_radius", r.radius}, {"pixels", r.pixels},
+            {"times_s", r.times}, {"min_s", r.stats.min}, {"median_s", r.stats.median},
+            {"p95_s", r.stats.p95}, {"mean_s", r.stats.mean}, {"stddev_s", r.stats.stddev},
+            {"mpix_per_s", r.mpix_per_s}, {"read_gb_per_s", r.throughput.read_gb_per_s},
+            {"write_gb_per_s", r.throughput.write_gb_per_s}, {"ops_per_pixel", r.traffic.ops_per_pixel},
+            {"gops_per_s", r.throughput.gops_per_s}, {"ops_per_byte", r.throughput.ops_per_byte},
+            {"bandwidth_fraction", numberOrNull(r.throughput.bandwidth_fraction)}, {"counters", counters},
+            {"ipc", numberOrNull(r.counters.ipc())},
+            {"l1d_misses_per_pixel", numberOrNull(r.counters.perPixel(PERF_L1D_MISSES, r.pixels))},
+            {"llc_misses_per_pixel", numberOrNull(r.counters.perPixel(PERF_LLC_MISSES, r.pixels))},
+            {"branch_misses_per_pixel", numberOrNull(r.counters.perPixel(PERF_BRANCH_MISSES, r.pixels))},
+            {"balance", balance}, {"memory", memory}, {"auto_choices", r.auto_choices}
+        });
+    }
+    doc["scaling"] = json::array();
+    for (const auto& s : scaling) {
+        doc["scaling"].push_back({
+            {"op", s.op}, {"engine", s.engine}, {"se_shape", s.shape}, {"se_radius", s.radius},
+            {"base_width", s.base_width}, {"base_height", s.base_height}, {"threads", s.threads},
+            {"width", s.width}, {"height", s.height}, {"median_s", s.median}, {"speedup", s.speedup},
+            {"efficiency", s.efficiency}, {"karp_flatt", numberOrNull(s.karp_flatt)},
+            {"imbalance", numberOrNull(s.imbalance)}, {"barrier_wait_fraction", numberOrNull(s.barrier_wait_fraction)},
+            {"lock_fraction", numberOrNull(s.lock_fraction)}
+        });
+    }
+    AllocStats run = allocStats();
+    doc["memory"] = {
+        {"allocations", run.allocations}, {"bytes_allocated", run.bytes_allocated},
+        {"peak_live_bytes", run.run_peak_live_bytes}, {"peak_rss_bytes", peakRssBytes()}
+    };
+    std::ofstream out(path, std::ofstream::trunc);
+    out << doc.dump(2) << std::endl;
+}
+
+void writeCsv(const std::string& path, const std::vector<BenchResult>& results) {
+    std::ofstream out(path, std::ofstream::trunc);
+    out << "schema_version,op,engine,threads,width,height,base_width,base_height,images,se_shape,se_radius,reps,min_s,median_s,p95_s,mean_s,stddev_s,mpix_per_s,"
+        << "read_gb_per_s,write_gb_per_s,ops_per_pixel,gops_per_s,ops_per_byte,bandwidth_fraction";
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) out << "," << perfCounterName(id);
+    out << ",ipc,l1d_misses_per_pixel,llc_misses_per_pixel,branch_misses_per_pixel,"
+        << "imbalance,iteration_imbalance,barrier_wait_fraction,lock_fraction,"
+        << "allocations_per_rep,bytes_allocated_per_rep,peak_live_bytes,peak_extra_bytes,retained_bytes,peak_rss_bytes\n";
+    out << std::setprecision(9);
+    for (const auto& r : results) {
+        out << BENCH_SCHEMA_VERSION << "," << r.op << "," << r.engine << "," << r.threads << ","
+            << r.width << "," << r.height << "," << r.base_width << "," << r.base_height << "," << r.images << "," << r.shape << "," << r.radius << ","
+            << r.times.size() << "," << r.stats.min << "," << r.stats.median << "," << r.stats.p95 << ","
+            << r.stats.mean << "," << r.stats.stddev << "," << r.mpix_per_s << ","
+            << r.throughput.read_gb_per_s << "," << r.throughput.write_gb_per_s << "," << r.traffic.ops_per_pixel << ","
+            << r.throughput.gops_per_s << "," << r.throughput.ops_per_byte << "," << csvField(r.throughput.bandwidth_fraction);
+        for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+            out << "," << (r.counters.has(id) ? std::to_string(r.counters.values[id]) : "NA");
+        }
+        out << "," << csvField(r.counters.ipc())
+            << "," << csvField(r.counters.perPixel(PERF_L1D_MISSES, r.pixels))
+            << "," << csvField(r.counters.perPixel(PERF_LLC_MISSES, r.pixels))
+            << "," << csvField(r.counters.perPixel(PERF_BRANCH_MISSES, r.pixels))
+            << "," << csvField(r.balance.imbalance) << "," << csvField(r.balance.iteration_imbalance)
+            << "," << csvField(r.balance.barrier_wait_fraction) << "," << csvField(r.balance.lock_fraction)
+            << "," << r.memory.allocations << "," << r.memory.bytes_allocated << "," << r.memory.peak_live_bytes
+            << "," << r.memory.peak_extra_bytes << "," << r.memory.retained_bytes << "," << r.memory.peak_rss_bytes << "\n";
+    }
+}
+
+void createParentPath(const std::string& path) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+}
+
+int main(int argc, char* argv[]) {
+    // Confronto di due esecuzioni dell'archivio dei risultati
+    if (argc >= 2 && std::string(argv[1]) == "compare") {
+        return runCompareCommand(argc - 2, argv + 2);
+    }
+
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    startTracingFromEnv();
+    if (!options.trace_path.empty()) {
+        startTracing(options.trace_path);
+    }
+
+    // I contatori vanno aperti prima che OpenMP crei i thread, perché li ereditino
+    if (options.perf) {
+        openPerfCounters();
+        std::cout << "Contatori hardware: " << perfCountersStatus() << std::endl;
+    }
+
+    // Sonda di banda con tutti i thread disponibili: riferimento per la frazione di banda raggiunta
+    BandwidthProbe probe;
+    if (options.bandwidth_mb > 0) {
+        probe = measureMemoryBandwidth(options.bandwidth_mb);
+        std::cout << "Banda di memoria (" << probe.threads << " thread): copy " << probe.copy_gb_per_s
+                  << " GB/s, triad " << probe.triad_gb_per_s << " GB/s" << std::endl;
+    }
+
+    // Insiemi di immagini: generati per dimensione (anche quelle scalate della scalabilità debole) e
+    // riusati fra le combinazioni, oppure quello letto da --input
+    WorkloadProfile profile;
+    try {
+        profile = workloadProfile(options.profile);
+    } catch (const std::invalid_argument& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    if (profile.name == "default") profile.max_shapes = std::max(profile.min_shapes, options.shapes_per_image);
+    std::map<std::pair<int, int>, std::vector<STBImage>> generated;
+    auto imagesOfSize = [&](int width, int height) -> const std::vector<STBImage>& {
+        auto& images = generated[{width, height}];
+        if (images.empty()) {
+            images = generateWorkload(options.images, width, height, profile, options.seed);
+        }
+        return images;
+    };
+    std::vector<STBImage> input_images;
+    std::vector<std::pair<int, int>> base_sizes = options.sizes;
+    if (!options.input.empty()) {
+        input_images = loadImagesFromDirectoryParallel(options.input);
+        if (input_images.empty()) {
+            std::cerr << "Nessuna immagine caricata da " << options.input << std::endl;
+            return 1;
+        }
+        base_sizes = {{input_images.front().width, input_images.front().height}};
+    }
+
+    // Calibrazione del modello di costo prima delle misure, se la versione auto è richiesta
+    bool use_auto = std::find(options.engines.begin(), options.engines.end(), "auto") != options.engines.end();
+    if (use_auto) {
+        calibrateKernels();
+        std::cout << "Modello di costo (ns per pixel + ns per confronto, frazione parallela):" << std::endl;
+        for (const auto& entry : kernelRegistry()) {
+            std::cout << "  " << std::left << std::setw(12) << entry.mode << std::setprecision(3) << entry.cost.pixel_ns
+                      << " + " << entry.cost.check_ns;
+            if (entry.caps.parallel) {
+                std::cout << ", f = " << entry.cost.parallel_fraction << (entry.cost.parallel_calibrated ? "" : " (stimata)");
+            }
+            std::cout << std::setprecision(6) << std::endl;
+        }
+    }
+
+    std::vector<BenchResult> results;
+    std::cout << std::left << std::setw(10) << "Op" << std::setw(14) << "Engine" << std::setw(9) << "Threads"
+              << std::setw(12) << "Size" << std::setw(9) << "SE" << std::setw(14) << "Median[s]"
+              << std::setw(14) << "P95[s]" << std::setw(14) << "Stddev[s]" << std::setw(12) << "Mpix/s" << std::setw(10) << "GB/s"
+              << std::setw(10) << "%Banda" << "IPC" << std::endl;
+
+    for (const auto& [base_width, base_height] : base_sizes) {
+        for (const auto& shape : options.shapes) {
+            for (int radius : options.radii) {
+                StructuringElement se(makeStructuringElement({shape, radius}));
+                for (const auto& op : options.ops) {
+                    for (const auto& engine : options.engines) {
+                        // Le versioni sequenziali si misurano una sola volta
+                        bool parallel = isParallelMode(engine);
+                        std::vector<int> thread_list = parallel ? options.threads : std::vector<int>{1};
+                        for (int threads : thread_list) {
+                            // Scalabilità debole: l'area cresce in proporzione ai thread
+                            double scale = (options.scaling == "weak" && parallel) ? std::sqrt((double)threads) : 1.0;
+                            int width = (int)std::lround(base_width * scale), height = (int)std::lround(base_height * scale);
+                            const std::vector<STBImage>& images = options.input.empty() ? imagesOfSize(width, height) : input_images;
+                            if (se.width > width || se.height > height) continue;
+
+                            BenchResult r = runMeasurement(images, se, op, engine, threads, options, probe.triad_gb_per_s);
+                            r.width = images.front().width;
+                            r.height = images.front().height;
+                            r.base_width = base_width;
+                            r.base_height = base_height;
+                            r.shape = shape;
+                            r.radius = radius;
+                            std::cout << std::left << std::setw(10) << r.op << std::setw(14) << r.engine << std::setw(9) << r.threads
+                                      << std::setw(12) << (std::to_string(r.width) + "x" + std::to_string(r.height))
+                                      << std::setw(9) << (r.shape + std::to_string(r.radius))
+                                      << std::setw(14) << r.stats.median << std::setw(14) << r.stats.p95
+                                      << std::setw(14) << r.stats.stddev << std::setw(12) << r.mpix_per_s
+                                      << std::setw(10) << std::setprecision(3) << (r.throughput.read_gb_per_s + r.throughput.write_gb_per_s)
+                                      << std::setw(10) << csvField(std::round(1000.0 * r.throughput.bandwidth_fraction) / 10.0)
+                                      << std::setprecision(6)
+                                      << csvField(r.counters.ipc()) << std::endl;
+                            results.push_back(std::move(r));
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    std::vector<ScalingResult> scaling = computeScaling(results, options.scaling);
+    if (!scaling.empty()) {
+        std::cout << "\n=== Scalabilità " << (options.scaling == "weak" ? "debole" : "forte") << " ===\n" << std::endl;
+        std::cout << std::left << std::setw(10) << "Op" << std::setw(14) << "Engine" << std::setw(12) << "Base"
+                  << std::setw(9) << "SE" << std::setw(9) << "Threads" << std::setw(12) << "Speedup"
+                  << std::setw(12) << "Efficienza" << std::setw(12) << "Karp-Flatt" << std::setw(10) << "Sbil."
+                  << std::setw(10) << "%Barriera" << "%Critica" << std::endl;
+        for (const auto& s : scaling) {
+            std::cout << std::left << std::setw(10) << s.op << std::setw(14) << s.engine
+                      << std::setw(12) << (std::to_string(s.base_width) + "x" + std::to_string(s.base_height))
+                      << std::setw(9) << (s.shape + std::to_string(s.radius)) << std::setw(9) << s.threads
+                      << std::setw(12) << std::setprecision(4) << s.speedup << std::setw(12) << s.efficiency
+                      << std::setw(12) << csvField(s.karp_flatt) << std::setw(10) << csvField(std::round(1000.0 * s.imbalance) / 1000.0)
+                      << std::setw(10) << csvField(std::round(1000.0 * s.barrier_wait_fraction) / 10.0)
+                      << csvField(std::round(1000.0 * s.lock_fraction) / 10.0) << std::setprecision(6) << std::endl;
+        }
+    }
+
+    createParentPath(options.json_path);
+    createParentPath(options.csv_path);
+    writeJson(options.json_path, options, probe, results, scaling);
+    writeCsv(options.csv_path, results);
+    std::cout << "Risultati scritti in " << options.json_path << " e " << options.csv_path << std::endl;
+    if (use_auto) {
+        createParentPath(options.decisions_path);
+        if (writeKernelDecisions(options.decisions_path)) {
+            std::cout << "Scelte della versione auto scritte in " << options.decisions_path << std::endl;
+        } else {
+            std::cerr << "Impossibile scrivere " << options.decisions_path << std::endl;
+        }
+    }
+    if (!scaling.empty()) {
+        createParentPath(options.scaling_csv_path);
+        writeScalingCsv(options.scaling_csv_path, options.scaling, scaling);
+        std::cout << "Scalabilità scritta in " << options.scaling_csv_path << std::endl;
+    }
+    if (!options.store_path.empty()) {
+        std::vector<StoredResult> stored;
+        for (const auto& r : results) {
+            stored.push_back({r.op, r.engine, r.threads, r.width, r.height, r.images, r.shape, r.radius, options.batch, r.times});
+        }
+        if (appendRun(options.store_path, makeRunRecord("morpho_bench", optionsJson(options), stored))) {
+            std::cout << "Esecuzione aggiunta all'archivio " << options.store_path << std::endl;
+        } else {
+            std::cerr << "Impossibile scrivere l'archivio " << options.store_path << std::endl;
+        }
+    }
+    return 0;
+}
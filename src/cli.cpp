@@ -0,0 +1,32 @@
+#include "cli.hpp"
+
+#include <sstream>
+
+std::vector<std::string> splitList(const std::string& text, char sep) {
+    std::vector<std::string> items;
+    std::stringstream ss(text);
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+std::vector<int> parseIntList(const std::string& text) {
+    std::vector<int> values;
+    for (const auto& item : splitList(text)) values.push_back(std::stoi(item));
+    return values;
+}
+
+std::vector<std::pair<int, int>> parseSizeList(const std::string& text) {
+    std::vector<std::pair<int, int>> sizes;
+    for (const auto& item : splitList(text)) {
+        size_t x = item.find('x');
+        if (x == std::string::npos) {
+            sizes.emplace_back(std::stoi(item), std::stoi(item));
+        } else {
+            sizes.emplace_back(std::stoi(item.substr(0, x)), std::stoi(item.substr(x + 1)));
+        }
+    }
+    return sizes;
+}
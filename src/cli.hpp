@@ -0,0 +1,17 @@
+#ifndef MORPHOLOGY_CLI_HPP
+#define MORPHOLOGY_CLI_HPP
+
+#include <string>
+#include <vector>
+#include <utility>
+
+// Funzione per dividere una lista separata da virgole
+std::vector<std::string> splitList(const std::string& text, char sep = ',');
+
+// Funzione per leggere una lista di interi separati da virgole
+std::vector<int> parseIntList(const std::string& text);
+
+// Funzione per leggere una lista di dimensioni nella forma "LxA" oppure "N" per immagini quadrate
+std::vector<std::pair<int, int>> parseSizeList(const std::string& text);
+
+#endif // MORPHOLOGY_CLI_HPP
@@ -0,0 +1,163 @@
+#include "config.hpp"
+
+#include <stdexcept>
+
+// Funzione per leggere un campo facoltativo con il tipo del valore predefinito
+template <typename T>
+static void readField(const json& object, const char* key, const std::string& prefix, T& value) {
+    auto it = object.find(key);
+    if (it == object.end() || it->is_null()) return;
+    try {
+        value = it->get<T>();
+    } catch (const json::exception&) {
+        throw std::invalid_argument("Configurazione: tipo non valido per " + prefix + key + " (" + it->dump() + ")");
+    }
+}
+
+// Funzione per leggere un intero facoltativo compreso in [lo, hi]
+static void readInt(const json& object, const char* key, const std::string& prefix, int& value, int lo, int hi) {
+    auto it = object.find(key);
+    if (it != object.end() && !it->is_null() && !it->is_number_integer()) {
+        throw std::invalid_argument("Configurazione: " + prefix + key + " deve essere un intero (" + it->dump() + ")");
+    }
+    readField(object, key, prefix, value);
+    if (value < lo || value > hi) {
+        throw std::invalid_argument("Configurazione: " + prefix + key + " = " + std::to_string(value) +
+            " fuori dall'intervallo [" + std::to_string(lo) + ", " + std::to_string(hi) + "]");
+    }
+}
+
+static void readColor(const json& object, const char* key, uint8_t& value) {
+    int color = value;
+    readInt(object, key, "", color, 0, 255);
+    value = (uint8_t)color;
+}
+
+// Funzione per ottenere un oggetto annidato (vuoto se assente)
+static const json& section(const json& doc, const char* key) {
+    static const json empty = json::object();
+    auto it = doc.find(key);
+    if (it == doc.end() || it->is_null()) return empty;
+    if (!it->is_object()) throw std::invalid_argument(std::string("Configurazione: ") + key + " deve essere un oggetto");
+    return *it;
+}
+
+RunConfig parseRunConfig(const json& doc) {
+    if (!doc.is_object()) throw std::invalid_argument("Configurazione: il documento deve essere un oggetto JSON");
+    RunConfig config;
+    config.source = doc;
+
+    const json& size = section(doc, "image_size");
+    readInt(size, "width", "image_size.", config.width, 1, 1 << 20);
+    readInt(size, "height", "image_size.", config.height, 1, 1 << 20);
+    readInt(doc, "num_images", "", config.num_images, 0, 1 << 24);
+    readField(doc, "image_format", "", config.image_format);
+    std::string format = fileExtension("x." + config.image_format);
+    if (format != "pgm" && format != "pnm" && format != "pbm" && format != "jpg" && format != "jpeg" && format != "png") {
+        throw std::invalid_argument("Configurazione: image_format non supportato: " + config.image_format);
+    }
+    readInt(doc, "shape_per_image", "", config.shape_per_image, 0, 1 << 16);
+
+    std::string profile = config.workload.name;
+    readField(doc, "workload_profile", "", profile);
+    config.workload = workloadProfile(profile);
+    if (config.workload.name == "default") {
+        config.workload.max_shapes = std::max(config.workload.min_shapes, config.shape_per_image);
+    }
+
+    readField(doc, "seed", "", config.seed);
+    readField(doc, "in_memory", "", config.in_memory);
+    readColor(doc, "background_color", config.background_color);
+    readColor(doc, "foreground_color", config.foreground_color);
+    if (config.background_color == config.foreground_color) {
+        throw std::invalid_argument("Configurazione: background_color e foreground_color devono essere diversi");
+    }
+    readInt(doc, "tile_size", "", config.tile_size, 1, 1 << 16);
+
+    const json& sink = section(doc, "output_sink");
+    std::string mode = "async";
+    readField(sink, "mode", "output_sink.", mode);
+    config.output_sink.mode = parseOutputSinkMode(mode);
+    readInt(sink, "writers", "output_sink.", config.output_sink.writers, 1, 1024);
+    readInt(sink, "queue_size", "output_sink.", config.output_sink.queue_size, 1, 1 << 20);
+
+    readField(doc, "perf_counters", "", config.perf_counters);
+    readInt(doc, "bandwidth_probe_mb", "", config.bandwidth_probe_mb, 0, 1 << 20);
+    readField(doc, "results_store", "", config.results_store);
+
+    const json& se = section(doc, "structuring_element");
+    readField(se, "shape", "structuring_element.", config.se_shape);
+    const auto& shapes = availableStructuringElementShapes();
+    if (std::find(shapes.begin(), shapes.end(), config.se_shape) == shapes.end()) {
+        throw std::invalid_argument("Configurazione: forma dell'elemento strutturante non valida: " + config.se_shape);
+    }
+    readInt(se, "radius", "structuring_element.", config.se_radius, 0, 1024);
+    config.se_spec.shape = config.se_shape;
+    config.se_spec.radius = config.se_radius;
+    config.se_spec = parseStructuringElementSpec(se, config.se_spec);
+    StructuringElement built = makeStructuringElement(config.se_spec);
+    if (built.width > config.width || built.height > config.height) {
+        throw std::invalid_argument("Configurazione: l'elemento strutturante " + config.se_shape + " (" + std::to_string(built.width) + "x" +
+            std::to_string(built.height) + ") è più grande delle immagini");
+    }
+
+    readField(section(doc, "sweep"), "threads", "sweep.", config.sweep_threads);
+    for (int threads : config.sweep_threads) {
+        if (threads < 1 || threads > 4096) {
+            throw std::invalid_argument("Configurazione: sweep.threads contiene un numero di thread non valido: " + std::to_string(threads));
+        }
+    }
+    return config;
+}
+
+json loadConfigDocument(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Configurazione non trovata: " + path);
+    try {
+        return json::parse(file);
+    } catch (const json::parse_error& e) {
+        throw std::runtime_error("Configurazione non valida in " + path + ": " + e.what());
+    }
+}
+
+void applyConfigOverride(json& doc, const std::string& assignment) {
+    size_t eq = assignment.find('=');
+    if (eq == std::string::npos || eq == 0) {
+        throw std::invalid_argument("Modifica della configurazione non valida (atteso chiave=valore): " + assignment);
+    }
+    std::string key = assignment.substr(0, eq), text = assignment.substr(eq + 1);
+    json value = json::parse(text, nullptr, false);
+    if (value.is_discarded()) value = text;
+
+    json* node = &doc;
+    size_t start = 0;
+    for (size_t dot = key.find('.'); dot != std::string::npos; dot = key.find('.', start)) {
+        node = &(*node)[key.substr(start, dot - start)];
+        if (!node->is_object()) *node = json::object();
+        start = dot + 1;
+    }
+    (*node)[key.substr(start)] = value;
+}
+
+ConfigArgs extractConfigArgs(int& argc, char* argv[]) {
+    ConfigArgs args;
+    int kept = 1;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if ((arg == "--config" || arg == "--set") && i + 1 < argc) {
+            if (arg == "--config") args.path = argv[++i];
+            else args.overrides.push_back(argv[++i]);
+            continue;
+        }
+        argv[kept++] = argv[i];
+    }
+    argc = kept;
+    argv[argc] = nullptr;
+    return args;
+}
+
+RunConfig loadRunConfig(const ConfigArgs& args) {
+    json doc = loadConfigDocument(args.path);
+    for (const auto& assignment : args.overrides) applyConfigOverride(doc, assignment);
+    return parseRunConfig(doc);
+}
@@ -0,0 +1,70 @@
+#ifndef MORPHOLOGY_CONFIG_HPP
+#define MORPHOLOGY_CONFIG_HPP
+
+#include "image.hpp"
+#include "generator.hpp"
+#include "output_sink.hpp"
+
+// CONFIGURAZIONE DELL'ESECUZIONE
+//
+// settings/config.json viene letto una sola volta, all'avvio del comando che ne ha bisogno, in una
+// RunConfig con tipi e intervalli verificati; --config e --set da riga di comando scelgono il file e
+// ne modificano le chiavi prima della verifica. Da lì i valori si passano esplicitamente alle funzioni:
+// nessun percorso di calcolo consulta il documento JSON, e un file mancante o non valido produce un
+// messaggio di errore invece di interrompere il programma prima di main().
+
+const char* const DEFAULT_CONFIG_PATH = "settings/config.json";
+
+struct OutputSinkConfig {
+    OutputSinkMode mode{OutputSinkMode::Async};
+    int writers{2};
+    int queue_size{64};
+};
+
+struct RunConfig {
+    int width{400}, height{400};
+    int num_images{50};
+    std::string image_format{"pgm"};
+    int shape_per_image{3};
+    WorkloadProfile workload;       // Profilo "workload_profile", con shape_per_image applicato al profilo default
+    uint64_t seed{42};
+    bool in_memory{true};
+    uint8_t background_color{DEFAULT_BACKGROUND_COLOR};
+    uint8_t foreground_color{255};
+    int tile_size{64};
+    OutputSinkConfig output_sink;
+    bool perf_counters{true};
+    int bandwidth_probe_mb{64};
+    std::string results_store;      // Vuoto = nessun archivio
+    std::string se_shape{"disk"};
+    int se_radius{5};
+    StructuringElementSpec se_spec;     // Sezione "structuring_element" completa (forma, raggio, lati, maschera, ...)
+    std::vector<int> sweep_threads;     // "sweep.threads" per le misure parallele (vuoto = potenze di due fino al massimo di OpenMP)
+    json source;                    // Documento letto, con le modifiche da riga di comando (registrato nell'archivio)
+};
+
+// Funzione per costruire la configurazione da un documento JSON: le chiavi assenti mantengono il valore
+// predefinito, tipi e valori non validi lanciano std::invalid_argument con il nome della chiave
+RunConfig parseRunConfig(const json& doc);
+
+// Funzione per leggere un documento di configurazione (std::runtime_error se il file manca o non è JSON valido)
+json loadConfigDocument(const std::string& path);
+
+// Funzione per applicare "chiave.sottochiave=valore" a un documento; il valore si interpreta come JSON
+// (numeri, true/false, liste) e altrimenti come stringa
+void applyConfigOverride(json& doc, const std::string& assignment);
+
+// File e modifiche scelti da riga di comando
+struct ConfigArgs {
+    std::string path{DEFAULT_CONFIG_PATH};
+    std::vector<std::string> overrides;     // "chiave.sottochiave=valore", applicate in ordine
+};
+
+// Funzione per togliere dagli argomenti --config PERCORSO e --set CHIAVE=VALORE (in qualsiasi posizione)
+ConfigArgs extractConfigArgs(int& argc, char* argv[]);
+
+// Funzione per leggere il file, applicare le modifiche e verificare la configurazione
+// (std::invalid_argument o std::runtime_error con il motivo se non è valida)
+RunConfig loadRunConfig(const ConfigArgs& args);
+
+#endif // MORPHOLOGY_CONFIG_HPP
@@ -0,0 +1,224 @@
+#include "container.hpp"
+
+PackEncoding parsePackEncoding(const std::string& name) {
+    if (name == "raw") return PackEncoding::Raw;
+    if (name == "bits") return PackEncoding::BitPacked;
+    if (name == "rle") return PackEncoding::RLE;
+    throw std::invalid_argument("Invalid pack encoding: " + name);
+}
+
+// Funzione per codificare i pixel di un'immagine (1 canale) come corpo del contenitore
+std::vector<uint8_t> encodePackBody(const STBImage& img, PackEncoding encoding) {
+    size_t pixels = (size_t)img.width * img.height;
+    std::vector<uint8_t> body;
+    if (encoding == PackEncoding::Raw) {
+        body.assign(img.image_data, img.image_data + pixels);
+    } else if (encoding == PackEncoding::BitPacked) {
+        size_t row_bytes = (img.width + 7) / 8;
+        body.assign(row_bytes * img.height, 0);
+        for (int y = 0; y < img.height; y++) {
+            const uint8_t* row = img.image_data + (size_t)y * img.width;
+            uint8_t* out = body.data() + y * row_bytes;
+            for (int x = 0; x < img.width; x++)
+                if (row[x] >= 128) out[x >> 3] |= 0x80 >> (x & 7);
+        }
+    } else {
+        bool foreground = false;
+        size_t i = 0;
+        while (i < pixels) {
+            size_t run = 0;
+            while (i < pixels && (img.image_data[i] >= 128) == foreground) {
+                run++;
+                i++;
+            }
+            do {
+                uint8_t byte = run & 0x7F;
+                run >>= 7;
+                body.push_back(run ? byte | 0x80 : byte);
+            } while (run);
+            foreground = !foreground;
+        }
+    }
+    return body;
+}
+
+// Funzione per decodificare un corpo BitPacked o RLE in un buffer di width*height pixel
+bool decodePackBody(const uint8_t* body, size_t size, const PackEntry& entry, uint8_t* out) {
+    size_t pixels = (size_t)entry.width * entry.height;
+    if (entry.encoding == (uint32_t)PackEncoding::BitPacked) {
+        size_t row_bytes = (entry.width + 7) / 8;
+        if (size < row_bytes * entry.height) return false;
+        for (uint32_t y = 0; y < entry.height; y++) {
+            const uint8_t* row = body + y * row_bytes;
+            uint8_t* dst = out + (size_t)y * entry.width;
+            for (uint32_t x = 0; x < entry.width; x++)
+                dst[x] = (row[x >> 3] >> (7 - (x & 7))) & 1 ? 255 : 0;
+        }
+        return true;
+    }
+    if (entry.encoding == (uint32_t)PackEncoding::RLE) {
+        size_t pos = 0, filled = 0;
+        bool foreground = false;
+        while (pos < size) {
+            size_t run = 0;
+            int shift = 0;
+            uint8_t byte;
+            do {
+                if (pos >= size || shift > 56) return false;
+                byte = body[pos++];
+                run |= (size_t)(byte & 0x7F) << shift;
+                shift += 7;
+            } while (byte & 0x80);
+            if (run > pixels - filled) return false;
+            std::memset(out + filled, foreground ? 255 : 0, run);
+            filled += run;
+            foreground = !foreground;
+        }
+        return filled == pixels;
+    }
+    return false;
+}
+
+// Funzione per impacchettare le immagini di una cartella in un contenitore .mpk.
+// Le immagini non binarie sono sempre salvate Raw, perché BitPacked/RLE perderebbero i livelli di grigio.
+bool packImagesToContainer(const std::string& directory, const std::string& output, PackEncoding encoding) {
+    std::vector<std::string> filenames = listImageFiles(directory);
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    if (!out) return false;
+
+    PackHeader header{};
+    std::memcpy(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC));
+    header.version = PACK_VERSION;
+    out.write((const char*)&header, sizeof(header));
+
+    std::vector<PackEntry> entries;
+    std::string names;
+    uint64_t offset = sizeof(header);
+    const char padding[PACK_ALIGNMENT] = {};
+    auto alignOutput = [&]() {
+        size_t pad = (PACK_ALIGNMENT - offset % PACK_ALIGNMENT) % PACK_ALIGNMENT;
+        out.write(padding, pad);
+        offset += pad;
+    };
+
+    // Caricamento e codifica in parallelo a blocchi, scrittura sequenziale nell'ordine dei nomi
+    const size_t chunk = 256;
+    int kept_raw = 0;
+    for (size_t first = 0; first < filenames.size(); first += chunk) {
+        size_t count = std::min(chunk, filenames.size() - first);
+        std::vector<STBImage> slots(count);
+        std::vector<std::vector<uint8_t>> bodies(count);
+        std::vector<PackEncoding> used(count, encoding);
+        std::vector<char> loaded(count, 0);
+
+        #pragma omp parallel for schedule(dynamic) shared(filenames, slots, bodies, used, loaded, first, count, encoding) default(none)
+        for (size_t i = 0; i < count; i++) {
+            if (!slots[i].loadImage(filenames[first + i])) continue;
+            if (encoding != PackEncoding::Raw && !isBinaryPixels(slots[i].image_data, (size_t)slots[i].width * slots[i].height))
+                used[i] = PackEncoding::Raw;
+            bodies[i] = encodePackBody(slots[i], used[i]);
+            loaded[i] = 1;
+        }
+
+        for (size_t i = 0; i < count; i++) {
+            if (!loaded[i]) continue;
+            if (used[i] != encoding) kept_raw++;
+            alignOutput();
+            std::string name = std::filesystem::path(filenames[first + i]).filename().string();
+            PackEntry entry{};
+            entry.body_offset = offset;
+            entry.body_size = bodies[i].size();
+            entry.name_offset = (uint32_t)names.size();
+            entry.name_length = (uint32_t)name.size();
+            entry.width = slots[i].width;
+            entry.height = slots[i].height;
+            entry.encoding = (uint32_t)used[i];
+            entries.push_back(entry);
+            names += name;
+            out.write((const char*)bodies[i].data(), bodies[i].size());
+            offset += bodies[i].size();
+        }
+    }
+
+    alignOutput();
+    header.num_entries = entries.size();
+    header.index_offset = offset;
+    out.write((const char*)entries.data(), entries.size() * sizeof(PackEntry));
+    offset += entries.size() * sizeof(PackEntry);
+    header.names_offset = offset;
+    out.write(names.data(), names.size());
+    out.seekp(0);
+    out.write((const char*)&header, sizeof(header));
+
+    if (kept_raw > 0)
+        std::cerr << kept_raw << " immagini non binarie salvate in formato raw" << std::endl;
+    std::cout << entries.size() << " immagini impacchettate in " << output << std::endl;
+    return (bool)out;
+}
+
+// Funzione per caricare tutte le immagini di un contenitore .mpk con un solo mmap.
+// I corpi Raw diventano viste senza copia nel file; BitPacked e RLE sono decodificati in parallelo.
+std::vector<STBImage> loadImagesFromContainer(const std::string& path, bool binarize) {
+    std::vector<STBImage> images;
+    auto file = MappedFile::open(path);
+    PackHeader header;
+    if (!file || file->length < sizeof(header)) {
+        std::cerr << "Contenitore non leggibile: " << path << std::endl;
+        return images;
+    }
+    std::memcpy(&header, file->data, sizeof(header));
+    if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION ||
+        header.index_offset > file->length ||
+        header.num_entries > (file->length - header.index_offset) / sizeof(PackEntry) ||
+        header.names_offset > file->length) {
+        std::cerr << "Contenitore non valido: " << path << std::endl;
+        return images;
+    }
+
+    size_t n = header.num_entries;
+    std::vector<STBImage> slots(n);
+    std::vector<char> loaded(n, 0);
+
+    #pragma omp parallel for schedule(dynamic) shared(file, header, slots, loaded, n, path, binarize) default(none)
+    for (size_t i = 0; i < n; i++) {
+        TraceScope decode_trace("decode", "io");
+        PackEntry entry;
+        std::memcpy(&entry, file->data + header.index_offset + i * sizeof(PackEntry), sizeof(entry));
+        size_t pixels = (size_t)entry.width * entry.height;
+        if (entry.body_offset > file->length || entry.body_size > file->length - entry.body_offset ||
+            entry.name_offset > file->length - header.names_offset ||
+            entry.name_length > file->length - header.names_offset - entry.name_offset || pixels == 0)
+            continue;
+
+        STBImage& img = slots[i];
+        const uint8_t* body = file->data + entry.body_offset;
+        img.width = entry.width;
+        img.height = entry.height;
+        img.channels = 1;
+        img.filename = path + "/" + std::string((const char*)file->data + header.names_offset + entry.name_offset, entry.name_length);
+        img.allocated_with_stb = false;
+
+        if (entry.encoding == (uint32_t)PackEncoding::Raw) {
+            if (entry.body_size < pixels) continue;
+            img.image_data = file->data + entry.body_offset;
+            img.mapping = file;
+            if (binarize && !isBinaryPixels(img.image_data, pixels))
+                binarizePixels(img.image_data, pixels);
+        } else {
+            img.image_data = (uint8_t*)trackedMalloc(pixels);
+            if (!decodePackBody(body, entry.body_size, entry, img.image_data)) {
+                img.freeImage();
+                continue;
+            }
+        }
+        loaded[i] = 1;
+    }
+
+    images.reserve(n);
+    for (size_t i = 0; i < n; i++) {
+        if (loaded[i]) {
+            images.push_back(std::move(slots[i]));
+        }
+    }
+    return images;
+}
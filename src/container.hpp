@@ -0,0 +1,63 @@
+#ifndef MORPHOLOGY_CONTAINER_HPP
+#define MORPHOLOGY_CONTAINER_HPP
+
+#include "image.hpp"
+
+// CONTENITORE DI IMMAGINI .mpk
+//
+// Molte immagini piccole in un unico file mappabile in memoria:
+// [PackHeader][corpi, allineati a PACK_ALIGNMENT byte][indice: num_entries x PackEntry][nomi]
+// I campi sono little-endian. I corpi Raw sono usati senza copia come viste nel file mappato.
+
+enum class PackEncoding : uint32_t {
+    Raw = 0,        // 1 byte per pixel
+    BitPacked = 1,  // 1 bit per pixel (1 = 255), righe allineate al byte, MSB per primo
+    RLE = 2         // run alternati sfondo/primo piano (si parte dallo sfondo), lunghezze in varint LEB128
+};
+
+PackEncoding parsePackEncoding(const std::string& name);
+
+const char PACK_MAGIC[4] = {'M', 'P', 'K', '1'};
+
+const uint32_t PACK_VERSION = 1;
+
+const size_t PACK_ALIGNMENT = 64;
+
+struct PackHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t num_entries;
+    uint64_t index_offset;
+    uint64_t names_offset;
+};
+
+struct PackEntry {
+    uint64_t body_offset;
+    uint64_t body_size;
+    uint32_t name_offset;   // Relativo a names_offset
+    uint32_t name_length;
+    uint32_t width;
+    uint32_t height;
+    uint32_t encoding;
+    uint32_t reserved;
+};
+
+static_assert(sizeof(PackHeader) == 32, "PackHeader layout");
+
+static_assert(sizeof(PackEntry) == 40, "PackEntry layout");
+
+// Funzione per codificare i pixel di un'immagine (1 canale) come corpo del contenitore
+std::vector<uint8_t> encodePackBody(const STBImage& img, PackEncoding encoding);
+
+// Funzione per decodificare un corpo BitPacked o RLE in un buffer di width*height pixel
+bool decodePackBody(const uint8_t* body, size_t size, const PackEntry& entry, uint8_t* out);
+
+// Funzione per impacchettare le immagini di una cartella in un contenitore .mpk.
+// Le immagini non binarie sono sempre salvate Raw, perché BitPacked/RLE perderebbero i livelli di grigio.
+bool packImagesToContainer(const std::string& directory, const std::string& output, PackEncoding encoding);
+
+// Funzione per caricare tutte le immagini di un contenitore .mpk con un solo mmap.
+// I corpi Raw diventano viste senza copia nel file; BitPacked e RLE sono decodificati in parallelo.
+std::vector<STBImage> loadImagesFromContainer(const std::string& path, bool binarize = true);
+
+#endif // MORPHOLOGY_CONTAINER_HPP
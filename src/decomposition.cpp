@@ -0,0 +1,597 @@
+#include "morphology.hpp"
+
+#include "trace.hpp"
+
+#include <omp.h>
+#include <cstdlib>
+#include <limits>
+
+// SCOMPOSIZIONE DELL'ELEMENTO STRUTTURANTE E VERSIONE V4
+//
+// Erosione e dilatazione binarie sono minimo e massimo sui vicini attivi, quindi un elemento strutturante
+// che è somma di Minkowski di pezzi più piccoli (rettangolo = segmento orizzontale + verticale, rombo =
+// croce 3x3 ripetuta, ottagono = rettangolo + rombo) si calcola con una passata per pezzo, e un'unione
+// (croce, corde) con il minimo/massimo dei risultati dei pezzi. Ogni passata calcola solo i pixel i cui
+// vicini cadono nell'immagine: così i pixel interni coincidono con V1 e il bordo riceve il colore di sfondo.
+
+// PIANO
+
+static bool activeAt(const StructuringElement& se, int dy, int dx) {
+    int i = dy + se.anchor_y, j = dx + se.anchor_x;
+    return i >= 0 && i < se.height && j >= 0 && j < se.width && se.kernel[i][j] == 1;
+}
+
+// Verifica che nel riquadro del piano siano attivi esattamente i pixel della regola (u, v relativi al centro)
+template <typename Rule>
+static bool matchesRule(const StructuringElement& se, const StructuringElementPlan& plan, Rule rule) {
+    int cx = (plan.x0 + plan.x1) / 2, cy = (plan.y0 + plan.y1) / 2;
+    for (int dy = plan.y0; dy <= plan.y1; dy++) {
+        for (int dx = plan.x0; dx <= plan.x1; dx++) {
+            if (activeAt(se, dy, dx) != rule(dx - cx, dy - cy)) return false;
+        }
+    }
+    return true;
+}
+
+// Funzione per costruire il piano di un tipo, se la maschera lo rispetta
+static bool tryPlan(const StructuringElement& se, SEDecomposition kind, int radius_hint, StructuringElementPlan& plan) {
+    int hx = (plan.x1 - plan.x0) / 2, hy = (plan.y1 - plan.y0) / 2;
+    bool odd = (plan.x1 - plan.x0) % 2 == 0 && (plan.y1 - plan.y0) % 2 == 0;
+    plan.kind = kind;
+    switch (kind) {
+        case SEDecomposition::Separable:
+            return matchesRule(se, plan, [](int, int) { return true; });
+        case SEDecomposition::Cross:
+            return odd && matchesRule(se, plan, [](int u, int v) { return u == 0 || v == 0; });
+        case SEDecomposition::Diamond:
+            plan.radius = hx;
+            return odd && hx == hy && matchesRule(se, plan, [hx](int u, int v) { return std::abs(u) + std::abs(v) <= hx; });
+        case SEDecomposition::Octagon: {
+            if (!odd) return false;
+            // Rettangolo di semilati (hx - b, hy - b) dilatato dal rombo di raggio b
+            int first = radius_hint > 0 ? radius_hint : 1, last = radius_hint > 0 ? radius_hint : std::min(hx, hy);
+            for (int b = first; b <= last && b <= std::min(hx, hy); b++) {
+                int ax = hx - b, ay = hy - b;
+                plan.radius = b;
+                if (matchesRule(se, plan, [ax, ay, b](int u, int v) {
+                        return std::max(std::abs(u) - ax, 0) + std::max(std::abs(v) - ay, 0) <= b;
+                    })) return true;
+            }
+            return false;
+        }
+        case SEDecomposition::Chords: {
+            plan.chords.clear();
+            plan.lengths.clear();
+            for (int dy = plan.y0; dy <= plan.y1; dy++) {
+                for (int dx = plan.x0; dx <= plan.x1; dx++) {
+                    if (!activeAt(se, dy, dx)) continue;
+                    int length = 1;
+                    while (dx + length <= plan.x1 && activeAt(se, dy, dx + length)) length++;
+                    plan.chords.push_back({dy, dx, length});
+                    if (std::find(plan.lengths.begin(), plan.lengths.end(), length) == plan.lengths.end()) plan.lengths.push_back(length);
+                    dx += length;
+                }
+            }
+            std::sort(plan.lengths.begin(), plan.lengths.end());
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+StructuringElementPlan planStructuringElement(const StructuringElement& se) {
+    StructuringElementPlan plan;
+    bool any = false;
+    for (int i = 0; i < se.height; i++) {
+        for (int j = 0; j < se.width; j++) {
+            if (se.kernel[i][j] != 1) continue;
+            plan.active++;
+            int dy = i - se.anchor_y, dx = j - se.anchor_x;
+            if (!any) {
+                plan.x0 = plan.x1 = dx;
+                plan.y0 = plan.y1 = dy;
+                any = true;
+            }
+            plan.x0 = std::min(plan.x0, dx);
+            plan.x1 = std::max(plan.x1, dx);
+            plan.y0 = std::min(plan.y0, dy);
+            plan.y1 = std::max(plan.y1, dy);
+        }
+    }
+    // Nessun pixel attivo: nessuna corda, l'erosione dà 255 e la dilatazione 0 come in V1
+    if (!any) return plan;
+
+    if (se.decomposition != SEDecomposition::None && se.decomposition != SEDecomposition::Chords &&
+        tryPlan(se, se.decomposition, se.decomposition_radius, plan)) return plan;
+    for (SEDecomposition kind : {SEDecomposition::Separable, SEDecomposition::Cross, SEDecomposition::Diamond, SEDecomposition::Octagon}) {
+        if (tryPlan(se, kind, 0, plan)) return plan;
+    }
+    tryPlan(se, SEDecomposition::Chords, 0, plan);
+    return plan;
+}
+
+// Confronti per pixel della scomposizione: una passata van Herk costa circa tre confronti, la croce 3x3 quattro
+static double decomposedChecks(const StructuringElementPlan& plan) {
+    switch (plan.kind) {
+        case SEDecomposition::Separable: return 3.0 * ((plan.x1 > plan.x0) + (plan.y1 > plan.y0)) + 1.0;
+        case SEDecomposition::Cross: return 7.0;
+        case SEDecomposition::Diamond: return 4.0 * plan.radius + 1.0;
+        case SEDecomposition::Octagon: return 6.0 + 4.0 * plan.radius;
+        default: return 3.0 * plan.lengths.size() + plan.chords.size() + 1.0;
+    }
+}
+
+// Confronti per pixel del percorso diretto: uno per pixel attivo, ma su registri SIMD da 16 byte (16 pixel
+// uint8_t, 4 float) mentre prefissi e suffissi van Herk sono sequenziali lungo la riga
+template <typename T>
+static double directChecks(const StructuringElementPlan& plan) {
+    return std::max(plan.active * sizeof(T) / 16.0, 1.0);
+}
+
+template <typename T>
+static bool directIsCheaper(const StructuringElementPlan& plan) {
+    return directChecks<T>(plan) <= decomposedChecks(plan);
+}
+
+double structuringElementPlanChecks(const StructuringElementPlan& plan) {
+    return std::min(directChecks<uint8_t>(plan), decomposedChecks(plan));
+}
+
+std::string decompositionName(SEDecomposition kind) {
+    switch (kind) {
+        case SEDecomposition::Separable: return "separable";
+        case SEDecomposition::Diamond: return "diamond";
+        case SEDecomposition::Octagon: return "octagon";
+        case SEDecomposition::Cross: return "cross";
+        case SEDecomposition::Chords: return "chords";
+        default: return "none";
+    }
+}
+
+// PASSATE
+//
+// Tutte le passate sono modelli sul tipo di pixel T (uint8_t, uint16_t, float): minimo e massimo si
+// scrivono come confronti che il compilatore traduce nelle istruzioni SIMD min/max del tipo. La
+// versione binaria V4 è l'istanza uint8_t con l'ingresso normalizzato a 0/255.
+
+template <typename T, bool Erode>
+static inline T pick(T a, T b) {
+    return Erode ? (a < b ? a : b) : (a > b ? a : b);
+}
+
+// Elemento neutro di minimo/massimo: +inf/-inf per i float, massimo/minimo per gli interi
+template <typename T, bool Erode>
+static constexpr T identityValue() {
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return Erode ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+    else
+        return Erode ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+}
+
+// Regione (estremi inclusi) in cui i valori di un buffer sono calcolati da pixel dell'immagine
+struct ValidRegion {
+    int x0, y0, x1, y1;
+    bool empty() const { return x0 > x1 || y0 > y1; }
+};
+
+// Minimo/massimo su tutte le finestre di lunghezza length di src[0..n-1] (van Herk / Gil-Werman):
+// prefissi e suffissi per blocchi di length elementi, dst[k] = finestra [k, k + length - 1]
+template <typename T, bool Erode>
+static void slidingWindow(const T* src, int n, int length, T* g, T* h, T* dst) {
+    if (length == 1) {
+        std::copy(src, src + n, dst);
+        return;
+    }
+    for (int k = 0; k < n; k++) g[k] = k % length == 0 ? src[k] : pick<T, Erode>(g[k - 1], src[k]);
+    for (int k = n - 1; k >= 0; k--) h[k] = (k == n - 1 || (k + 1) % length == 0) ? src[k] : pick<T, Erode>(h[k + 1], src[k]);
+    #pragma omp simd
+    for (int k = 0; k <= n - length; k++) dst[k] = pick<T, Erode>(h[k], g[k + length - 1]);
+}
+
+// Passata orizzontale: out(x) = min/max di in(x + offset .. x + offset + length - 1)
+template <typename T, bool Erode>
+static ValidRegion horizontalPass(const T* in, T* out, int width, ValidRegion valid, int offset, int length, bool parallel) {
+    ValidRegion next{std::max(valid.x0 - offset, 0), valid.y0, std::min(valid.x1 - offset - length + 1, width - 1), valid.y1};
+    if (next.empty()) return next;
+    int n = valid.x1 - valid.x0 + 1;
+    #pragma omp parallel if(parallel) shared(in, out, width, valid, next, offset, length, n) default(none)
+    {
+        std::vector<T> g(n), h(n), windows(n);
+        #pragma omp for schedule(static)
+        for (int y = valid.y0; y <= valid.y1; y++) {
+            slidingWindow<T, Erode>(in + (size_t)y * width + valid.x0, n, length, g.data(), h.data(), windows.data());
+            T* row = out + (size_t)y * width;
+            for (int x = next.x0; x <= next.x1; x++) row[x] = windows[x + offset - valid.x0];
+        }
+    }
+    return next;
+}
+
+// Passata verticale: prefissi e suffissi per blocchi di righe, vettorizzati lungo la riga
+template <typename T, bool Erode>
+static ValidRegion verticalPass(const T* in, T* out, int width, int height, ValidRegion valid, int offset, int length, bool parallel) {
+    ValidRegion next{valid.x0, std::max(valid.y0 - offset, 0), valid.x1, std::min(valid.y1 - offset - length + 1, height - 1)};
+    if (next.empty()) return next;
+    int n = valid.y1 - valid.y0 + 1, x0 = valid.x0, span = valid.x1 - valid.x0 + 1;
+    auto row = [&](const T* base, int k) { return base + (size_t)(valid.y0 + k) * width + x0; };
+    if (length == 1) {
+        #pragma omp parallel for if(parallel) schedule(static) shared(in, out, width, next, offset, x0, span) default(none)
+        for (int y = next.y0; y <= next.y1; y++)
+            std::copy(in + (size_t)(y + offset) * width + x0, in + (size_t)(y + offset) * width + x0 + span, out + (size_t)y * width + x0);
+        return next;
+    }
+    std::vector<T> g((size_t)n * span), h((size_t)n * span);
+    int blocks = (n + length - 1) / length;
+    #pragma omp parallel for if(parallel) schedule(static) shared(in, g, h, n, length, span, blocks, row) default(none)
+    for (int b = 0; b < blocks; b++) {
+        int first = b * length, last = std::min(first + length, n) - 1;
+        for (int k = first; k <= last; k++) {
+            const T* src = row(in, k);
+            T* gk = g.data() + (size_t)k * span;
+            if (k == first) std::copy(src, src + span, gk);
+            else {
+                const T* prev = gk - span;
+                #pragma omp simd
+                for (int x = 0; x < span; x++) gk[x] = pick<T, Erode>(prev[x], src[x]);
+            }
+        }
+        for (int k = last; k >= first; k--) {
+            const T* src = row(in, k);
+            T* hk = h.data() + (size_t)k * span;
+            if (k == last) std::copy(src, src + span, hk);
+            else {
+                const T* next_row = hk + span;
+                #pragma omp simd
+                for (int x = 0; x < span; x++) hk[x] = pick<T, Erode>(next_row[x], src[x]);
+            }
+        }
+    }
+    #pragma omp parallel for if(parallel) schedule(static) shared(out, g, h, width, valid, next, offset, length, x0, span) default(none)
+    for (int y = next.y0; y <= next.y1; y++) {
+        int k = y + offset - valid.y0;
+        const T* hk = h.data() + (size_t)k * span;
+        const T* gk = g.data() + (size_t)(k + length - 1) * span;
+        T* dst = out + (size_t)y * width + x0;
+        #pragma omp simd
+        for (int x = 0; x < span; x++) dst[x] = pick<T, Erode>(hk[x], gk[x]);
+    }
+    return next;
+}
+
+// Passata della croce 3x3 centrata (un passo del rombo)
+template <typename T, bool Erode>
+static ValidRegion crossPass(const T* in, T* out, int width, ValidRegion valid, bool parallel) {
+    ValidRegion next{valid.x0 + 1, valid.y0 + 1, valid.x1 - 1, valid.y1 - 1};
+    if (next.empty()) return next;
+    #pragma omp parallel for if(parallel) schedule(static) shared(in, out, width, next) default(none)
+    for (int y = next.y0; y <= next.y1; y++) {
+        const T* up = in + (size_t)(y - 1) * width;
+        const T* mid = in + (size_t)y * width;
+        const T* down = in + (size_t)(y + 1) * width;
+        T* dst = out + (size_t)y * width;
+        #pragma omp simd
+        for (int x = next.x0; x <= next.x1; x++)
+            dst[x] = pick<T, Erode>(pick<T, Erode>(pick<T, Erode>(up[x], down[x]), pick<T, Erode>(mid[x - 1], mid[x + 1])), mid[x]);
+    }
+    return next;
+}
+
+// Unione dei risultati di due pezzi: a = min/max(a, b) sull'intersezione delle regioni valide
+template <typename T, bool Erode>
+static ValidRegion unionPass(T* a, const T* b, int width, ValidRegion va, ValidRegion vb, bool parallel) {
+    ValidRegion next{std::max(va.x0, vb.x0), std::max(va.y0, vb.y0), std::min(va.x1, vb.x1), std::min(va.y1, vb.y1)};
+    if (next.empty()) return next;
+    #pragma omp parallel for if(parallel) schedule(static) shared(a, b, width, next) default(none)
+    for (int y = next.y0; y <= next.y1; y++) {
+        T* dst = a + (size_t)y * width;
+        const T* src = b + (size_t)y * width;
+        #pragma omp simd
+        for (int x = next.x0; x <= next.x1; x++) dst[x] = pick<T, Erode>(dst[x], src[x]);
+    }
+    return next;
+}
+
+// Regione dei pixel di uscita: quelli per cui V1 calcola un valore (l'elemento centrato cade nell'immagine)
+struct OutputRegion {
+    int x0, y0, x1, y1;
+};
+
+// Percorso diretto: per ogni riga di uscita un minimo/massimo vettorizzato per pixel attivo, senza buffer
+template <typename T, bool Erode>
+static void directPass(const T* in, T* out, int width, const StructuringElement& se, OutputRegion region, bool parallel) {
+    std::vector<std::pair<int, int>> offsets = compileStructuringElement(se);
+    #pragma omp parallel for if(parallel) schedule(static) shared(in, out, width, offsets, region) default(none)
+    for (int y = region.y0; y <= region.y1; y++) {
+        T* dst = out + (size_t)y * width;
+        std::fill(dst + region.x0, dst + region.x1 + 1, identityValue<T, Erode>());
+        for (const auto& [dy, dx] : offsets) {
+            const T* src = in + (size_t)(y + dy) * width + dx;
+            #pragma omp simd
+            for (int x = region.x0; x <= region.x1; x++) dst[x] = pick<T, Erode>(dst[x], src[x]);
+        }
+    }
+}
+
+// Corde: per ogni riga di ingresso le finestre scorrevoli di ogni lunghezza distinta, in un anello di
+// (altezza del riquadro) righe; ogni pixel di uscita combina una finestra per corda
+template <typename T, bool Erode>
+static void chordsPass(const T* in, T* out, int width, const StructuringElementPlan& plan, OutputRegion region, bool parallel) {
+    int ring_rows = plan.y1 - plan.y0 + 1, tables = plan.lengths.size();
+    std::vector<int> chord_table(plan.chords.size());
+    for (size_t c = 0; c < plan.chords.size(); c++)
+        chord_table[c] = std::find(plan.lengths.begin(), plan.lengths.end(), plan.chords[c].length) - plan.lengths.begin();
+
+    #pragma omp parallel if(parallel) shared(in, out, width, plan, region, ring_rows, tables, chord_table) default(none)
+    {
+        // Righe di uscita contigue per thread, così ogni riga di ingresso dell'anello si calcola una volta
+        int threads = omp_get_num_threads(), id = omp_get_thread_num();
+        int rows = region.y1 - region.y0 + 1;
+        int first = region.y0 + (int)((long long)rows * id / threads), last = region.y0 + (int)((long long)rows * (id + 1) / threads) - 1;
+        std::vector<T> ring((size_t)ring_rows * tables * width), g(width), h(width);
+        std::vector<int> ring_source(ring_rows, -1);
+        auto table = [&](int source_row, int t) { return ring.data() + ((size_t)(source_row % ring_rows) * tables + t) * width; };
+
+        for (int y = first; y <= last; y++) {
+            for (int dy = plan.y0; dy <= plan.y1; dy++) {
+                int source = y + dy, slot = source % ring_rows;
+                if (ring_source[slot] == source) continue;
+                ring_source[slot] = source;
+                for (int t = 0; t < tables; t++)
+                    slidingWindow<T, Erode>(in + (size_t)source * width, width, plan.lengths[t], g.data(), h.data(), table(source, t));
+            }
+            T* dst = out + (size_t)y * width;
+            std::fill(dst + region.x0, dst + region.x1 + 1, identityValue<T, Erode>());
+            for (size_t c = 0; c < plan.chords.size(); c++) {
+                const T* windows = table(y + plan.chords[c].dy, chord_table[c]) + plan.chords[c].dx;
+                #pragma omp simd
+                for (int x = region.x0; x <= region.x1; x++) dst[x] = pick<T, Erode>(dst[x], windows[x]);
+            }
+        }
+    }
+}
+
+// Funzione per eseguire erosione (Erode = true) o dilatazione di un buffer di pixel di tipo T: scrive in
+// out la regione interna, lasciando invariato il bordo. a contiene l'ingresso e viene usato come appoggio
+template <typename T, bool Erode>
+static void minMaxFilter(std::vector<T>& a, T* out, int width, int height, const StructuringElement& se,
+                         const StructuringElementPlan& plan, MinMaxPath path, bool parallel) {
+    OutputRegion region{se.anchor_x, se.anchor_y, width - se.anchor_x - 1, height - se.anchor_y - 1};
+    if (region.x0 > region.x1 || region.y0 > region.y1) return;
+
+    if (path == MinMaxPath::Direct || (path == MinMaxPath::Auto && directIsCheaper<T>(plan))) {
+        directPass<T, Erode>(a.data(), out, width, se, region, parallel);
+        return;
+    }
+    if (plan.kind == SEDecomposition::Chords) {
+        chordsPass<T, Erode>(a.data(), out, width, plan, region, parallel);
+        return;
+    }
+
+    size_t n = (size_t)width * height;
+    std::vector<T> b(n);
+    ValidRegion valid{0, 0, width - 1, height - 1};
+    int cx = (plan.x0 + plan.x1) / 2, cy = (plan.y0 + plan.y1) / 2;
+    int shift_x = cx, shift_y = cy;
+    std::vector<T>* final_buffer = &a;
+    switch (plan.kind) {
+        case SEDecomposition::Separable:
+            valid = horizontalPass<T, Erode>(a.data(), b.data(), width, valid, plan.x0, plan.x1 - plan.x0 + 1, parallel);
+            valid = verticalPass<T, Erode>(b.data(), a.data(), width, height, valid, plan.y0, plan.y1 - plan.y0 + 1, parallel);
+            shift_x = shift_y = 0;
+            break;
+        case SEDecomposition::Cross: {
+            std::vector<T> c(n);
+            ValidRegion horizontal = horizontalPass<T, Erode>(a.data(), b.data(), width, valid, plan.x0 - cx, plan.x1 - plan.x0 + 1, parallel);
+            ValidRegion vertical = verticalPass<T, Erode>(a.data(), c.data(), width, height, valid, plan.y0 - cy, plan.y1 - plan.y0 + 1, parallel);
+            valid = unionPass<T, Erode>(b.data(), c.data(), width, horizontal, vertical, parallel);
+            final_buffer = &b;
+            break;
+        }
+        case SEDecomposition::Octagon: {
+            int hx = (plan.x1 - plan.x0) / 2 - plan.radius, hy = (plan.y1 - plan.y0) / 2 - plan.radius;
+            valid = horizontalPass<T, Erode>(a.data(), b.data(), width, valid, -hx, 2 * hx + 1, parallel);
+            valid = verticalPass<T, Erode>(b.data(), a.data(), width, height, valid, -hy, 2 * hy + 1, parallel);
+            [[fallthrough]];    // Il rombo dopo il rettangolo
+        }
+        case SEDecomposition::Diamond:
+            for (int step = 0; step < plan.radius && !valid.empty(); step++) {
+                valid = crossPass<T, Erode>(final_buffer->data(), (final_buffer == &a ? b : a).data(), width, valid, parallel);
+                final_buffer = final_buffer == &a ? &b : &a;
+            }
+            break;
+        default:
+            break;
+    }
+
+    const T* computed = final_buffer->data();
+    #pragma omp parallel for if(parallel) schedule(static) shared(out, computed, width, region, shift_x, shift_y) default(none)
+    for (int y = region.y0; y <= region.y1; y++) {
+        const T* row = computed + (size_t)(y + shift_y) * width + shift_x;
+        std::copy(row + region.x0, row + region.x1 + 1, out + (size_t)y * width + region.x0);
+    }
+}
+
+// Funzione per eseguire erosione o dilatazione binaria con il piano dell'elemento strutturante
+template <bool Erode>
+static STBImage decomposedOperation(const STBImage& img, const StructuringElement& se, const StructuringElementPlan& plan,
+                                    uint8_t background, bool parallel) {
+    TraceScope pass_trace(Erode ? "erosion_V4" : "dilation_V4", "stage");
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+    size_t n = (size_t)img.width * img.height;
+    // Come in V1 l'erosione guarda solo i pixel a 0 e la dilatazione quelli a 255
+    std::vector<uint8_t> a(n);
+    const uint8_t* src = img.image_data;
+    #pragma omp parallel for simd if(parallel: parallel) schedule(static) shared(a, src, n) default(none)
+    for (size_t i = 0; i < n; i++) a[i] = Erode ? (src[i] == 0 ? 0 : 255) : (src[i] == 255 ? 255 : 0);
+    minMaxFilter<uint8_t, Erode>(a, result.image_data, img.width, img.height, se, plan, MinMaxPath::Auto, parallel);
+    return result;
+}
+
+// Funzioni per le quattro operazioni con un piano già calcolato: apertura e chiusura lo usano per entrambe
+// le passate, i vettori di immagini per tutte le immagini
+static STBImage erosionPlanned(const STBImage& img, const StructuringElement& se, const StructuringElementPlan& plan, uint8_t background, bool parallel) {
+    return decomposedOperation<true>(img, se, plan, background, parallel);
+}
+
+static STBImage dilationPlanned(const STBImage& img, const StructuringElement& se, const StructuringElementPlan& plan, uint8_t background, bool parallel) {
+    return decomposedOperation<false>(img, se, plan, background, parallel);
+}
+
+static STBImage openingPlanned(const STBImage& img, const StructuringElement& se, const StructuringElementPlan& plan, uint8_t background, bool parallel) {
+    return dilationPlanned(erosionPlanned(img, se, plan, background, parallel), se, plan, background, parallel);
+}
+
+static STBImage closingPlanned(const STBImage& img, const StructuringElement& se, const StructuringElementPlan& plan, uint8_t background, bool parallel) {
+    return erosionPlanned(dilationPlanned(img, se, plan, background, parallel), se, plan, background, parallel);
+}
+
+using PlannedOperation = STBImage (*)(const STBImage&, const StructuringElement&, const StructuringElementPlan&, uint8_t, bool);
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO SEQUENZIALE
+
+// Funzione per eseguire l'erosione con la scomposizione dell'elemento strutturante
+STBImage erosion_V4(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return erosionPlanned(img, se, planStructuringElement(se), background, false);
+}
+
+// Funzione per eseguire la dilatazione con la scomposizione dell'elemento strutturante
+STBImage dilation_V4(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return dilationPlanned(img, se, planStructuringElement(se), background, false);
+}
+
+// Funzione per eseguire l'apertura con la scomposizione dell'elemento strutturante
+STBImage opening_V4(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return openingPlanned(img, se, planStructuringElement(se), background, false);
+}
+
+// Funzione per eseguire la chiusura con la scomposizione dell'elemento strutturante
+STBImage closing_V4(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return closingPlanned(img, se, planStructuringElement(se), background, false);
+}
+
+// Funzione per applicare una versione V4 a ogni immagine di un vettore, con un solo piano per tutte
+template <PlannedOperation F>
+static std::unordered_map<std::string, STBImage> eachImage(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    StructuringElementPlan plan = planStructuringElement(se);
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (auto &img : imgs) {
+        imgs_results[img.filename] = F(img, se, plan, background, false);
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> erosion_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImage<erosionPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> dilation_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImage<dilationPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> opening_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImage<openingPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> closing_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImage<closingPlanned>(imgs, se, background);
+}
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO PARALLELO
+
+// Funzione per eseguire l'erosione con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage erosion_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return erosionPlanned(img, se, planStructuringElement(se), background, true);
+}
+
+// Funzione per eseguire la dilatazione con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage dilation_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return dilationPlanned(img, se, planStructuringElement(se), background, true);
+}
+
+// Funzione per eseguire l'apertura con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage opening_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return openingPlanned(img, se, planStructuringElement(se), background, true);
+}
+
+// Funzione per eseguire la chiusura con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage closing_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return closingPlanned(img, se, planStructuringElement(se), background, true);
+}
+
+// Funzione per applicare una versione V4 sequenziale alle immagini di un vettore, in parallelo sulle immagini
+template <PlannedOperation F>
+static std::unordered_map<std::string, STBImage> eachImageParallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    StructuringElementPlan plan = planStructuringElement(se);
+    std::vector<STBImage> results(imgs.size());
+    #pragma omp parallel for schedule(dynamic) shared(imgs, se, plan, background, results) default(none)
+    for (size_t i = 0; i < imgs.size(); i++) {
+        TraceScope image_trace("image", "image");
+        results[i] = F(imgs[i], se, plan, background, false);
+    }
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (size_t i = 0; i < imgs.size(); i++) imgs_results[imgs[i].filename] = std::move(results[i]);
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> erosion_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImageParallel<erosionPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> dilation_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImageParallel<dilationPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> opening_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImageParallel<openingPlanned>(imgs, se, background);
+}
+
+std::unordered_map<std::string, STBImage> closing_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    return eachImageParallel<closingPlanned>(imgs, se, background);
+}
+
+// VERSIONE V4 IN SCALA DI GRIGI
+
+// Funzione per eseguire erosione o dilatazione in scala di grigi con lo stesso nucleo della versione binaria
+template <typename T, bool Erode>
+static GrayImage<T> grayOperation(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path, bool parallel) {
+    TraceScope pass_trace(Erode ? "erosion_gray" : "dilation_gray", "stage");
+    GrayImage<T> result;
+    result.initialize(img.width, img.height, background);
+    result.filename = img.filename;
+    std::vector<T> a(img.data);
+    minMaxFilter<T, Erode>(a, result.data.data(), img.width, img.height, se, planStructuringElement(se), path, parallel);
+    return result;
+}
+
+template <typename T>
+GrayImage<T> erosion_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path, bool parallel) {
+    return grayOperation<T, true>(img, se, background, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> dilation_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path, bool parallel) {
+    return grayOperation<T, false>(img, se, background, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> opening_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path, bool parallel) {
+    return dilation_gray(erosion_gray(img, se, background, path, parallel), se, background, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> closing_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path, bool parallel) {
+    return erosion_gray(dilation_gray(img, se, background, path, parallel), se, background, path, parallel);
+}
+
+// Istanze per i tipi di pixel supportati
+#define INSTANTIATE_GRAY_OPERATIONS(T) \
+    template GrayImage<T> erosion_gray<T>(const GrayImage<T>&, const StructuringElement&, T, MinMaxPath, bool); \
+    template GrayImage<T> dilation_gray<T>(const GrayImage<T>&, const StructuringElement&, T, MinMaxPath, bool); \
+    template GrayImage<T> opening_gray<T>(const GrayImage<T>&, const StructuringElement&, T, MinMaxPath, bool); \
+    template GrayImage<T> closing_gray<T>(const GrayImage<T>&, const StructuringElement&, T, MinMaxPath, bool);
+
+INSTANTIATE_GRAY_OPERATIONS(uint8_t)
+INSTANTIATE_GRAY_OPERATIONS(uint16_t)
+INSTANTIATE_GRAY_OPERATIONS(float)
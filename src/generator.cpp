@@ -0,0 +1,151 @@
+#include "generator.hpp"
+
+#include <cmath>
+#include <stdexcept>
+#include <omp.h>
+
+static uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+CounterRng::CounterRng(uint64_t seed, uint64_t stream) : key(splitmix64(seed ^ splitmix64(stream))) {}
+
+uint64_t CounterRng::next() {
+    return splitmix64(key + 0x9E3779B97F4A7C15ull * ++counter);
+}
+
+int CounterRng::uniformInt(int lo, int hi) {
+    if (hi <= lo) return lo;
+    return lo + (int)(next() % (uint64_t)(hi - lo + 1));
+}
+
+double CounterRng::uniform() {
+    return (next() >> 11) * (1.0 / 9007199254740992.0); // 53 bit di mantissa
+}
+
+WorkloadProfile workloadProfile(const std::string& name) {
+    WorkloadProfile profile;
+    profile.name = name;
+    if (name == "default") {
+        return profile;
+    }
+    if (name == "sparse") {
+        profile.max_shapes = 2;
+        profile.size_scale = 0.5;
+        return profile;
+    }
+    if (name == "dense") {
+        profile.min_shapes = 4;
+        profile.max_shapes = 256;
+        double weights[SHAPE_COUNT] = {3, 1, 3, 1, 0};
+        std::copy(weights, weights + SHAPE_COUNT, profile.shape_weights);
+        profile.target_density = 0.6;
+        return profile;
+    }
+    if (name == "noisy") {
+        profile.noise = 0.02;
+        return profile;
+    }
+    if (name == "lines") {
+        profile.min_shapes = 8;
+        profile.max_shapes = 64;
+        double weights[SHAPE_COUNT] = {0, 0, 0, 0, 1};
+        std::copy(weights, weights + SHAPE_COUNT, profile.shape_weights);
+        return profile;
+    }
+    throw std::invalid_argument("Invalid workload profile: " + name);
+}
+
+// Sceglie il tipo di forma secondo i pesi del profilo
+static int pickShape(CounterRng& rng, const WorkloadProfile& profile) {
+    double total = 0.0;
+    for (double w : profile.shape_weights) total += std::max(w, 0.0);
+    if (total <= 0.0) return SHAPE_RECTANGLE;
+    double u = rng.uniform() * total;
+    for (int shape = 0; shape < SHAPE_COUNT; shape++) {
+        u -= std::max(profile.shape_weights[shape], 0.0);
+        if (u < 0.0) return shape;
+    }
+    return SHAPE_COUNT - 1;
+}
+
+STBImage generateWorkloadImage(int width, int height, const WorkloadProfile& profile, uint64_t seed, int index, int color) {
+    STBImage img;
+    img.initializeBinary(width, height, 255 - color);
+    CounterRng rng(seed, (uint64_t)index);
+
+    // Le dimensioni delle forme seguono il lato minore dell'immagine
+    double s = std::max(profile.size_scale * std::min(width, height) / 400.0, 0.05);
+    auto scaled = [s](double value) { return std::max(1, (int)std::lround(value * s)); };
+
+    size_t pixels = (size_t)width * height, foreground = 0;
+    int min_shapes = std::max(0, profile.min_shapes);
+    int max_shapes = std::max(min_shapes, profile.max_shapes);
+    int num_shapes = profile.target_density > 0 ? max_shapes : rng.uniformInt(min_shapes, max_shapes);
+
+    for (int j = 0; j < num_shapes; j++) {
+        if (profile.target_density > 0 && j >= min_shapes && foreground >= profile.target_density * pixels) break;
+        int x = rng.uniformInt(0, width - 1);
+        int y = rng.uniformInt(0, height - 1);
+        switch (pickShape(rng, profile)) {
+            case SHAPE_RECTANGLE:
+                foreground += drawRectangle(img, x, y, rng.uniformInt(scaled(20), scaled(200)), rng.uniformInt(scaled(20), scaled(200)), color);
+                break;
+            case SHAPE_FRAME:
+                foreground += drawHollowRectangle(img, x, y, rng.uniformInt(scaled(40), scaled(140)), rng.uniformInt(scaled(40), scaled(140)), scaled(10), color);
+                break;
+            case SHAPE_CIRCLE:
+                foreground += drawCircle(img, x, y, rng.uniformInt(scaled(10), scaled(60)), color);
+                break;
+            case SHAPE_RING: {
+                int outer = rng.uniformInt(scaled(30), scaled(80));
+                foreground += drawHollowCircle(img, x, y, outer, rng.uniformInt(scaled(10), std::max(scaled(10), outer - scaled(10))), color);
+                break;
+            }
+            default:
+                foreground += drawLine(img, x, y, rng.uniformInt(0, width - 1), rng.uniformInt(0, height - 1), color);
+                break;
+        }
+    }
+
+    // Rumore sale e pepe: si salta direttamente al prossimo pixel da invertire (distanza geometrica)
+    if (profile.noise > 0) {
+        double log_keep = std::log1p(-std::min(profile.noise, 0.999999));
+        for (size_t i = 0; ; i++) {
+            double gap = std::floor(std::log1p(-rng.uniform()) / log_keep);
+            if (gap >= (double)(pixels - i)) break;
+            i += (size_t)gap;
+            img.image_data[i] = img.image_data[i] == color ? 255 - color : color;
+        }
+    }
+    return img;
+}
+
+std::vector<STBImage> generateWorkload(int numImages, int width, int height, const WorkloadProfile& profile,
+    uint64_t seed, int color, const std::string& extension) {
+    std::vector<STBImage> images(std::max(numImages, 0));
+
+    #pragma omp parallel for schedule(dynamic) shared(images, numImages, width, height, profile, seed, color, extension) default(none)
+    for (int i = 0; i < numImages; i++) {
+        images[i] = generateWorkloadImage(width, height, profile, seed, i, color);
+        images[i].filename = "image_" + std::to_string(i + 1) + "." + extension;
+    }
+    return images;
+}
+
+// Funzione per generare immagini binarie con forme casuali
+int generateBinaryImages(int numImages, int width, int height, const WorkloadProfile& profile,
+    uint64_t seed, int color, const std::string& extension) {
+    std::vector<STBImage> images = generateWorkload(numImages, width, height, profile, seed, color, extension);
+
+    // Salva le immagini generate
+    int failed = 0;
+    #pragma omp parallel for schedule(dynamic) shared(images) default(none) reduction(+:failed)
+    for (size_t i = 0; i < images.size(); i++) {
+        if (!images[i].saveImage("images/basis/" + images[i].filename)) failed++;
+    }
+    return failed;
+}
@@ -0,0 +1,53 @@
+#ifndef MORPHOLOGY_GENERATOR_HPP
+#define MORPHOLOGY_GENERATOR_HPP
+
+#include "image.hpp"
+
+// GENERATORE DI CARICHI SINTETICI
+//
+// Ogni immagine ha un proprio generatore basato su contatore, derivato da (seme, indice immagine):
+// il risultato non dipende dal numero di thread né dall'ordine di esecuzione, quindi le immagini
+// si generano in parallelo e due esecuzioni con lo stesso seme producono gli stessi pixel.
+// Un profilo stabilisce quante forme disegnare, quali, quanto grandi, la densità di primo piano da
+// raggiungere e il rumore sale e pepe da aggiungere.
+
+// Generatore pseudo-casuale basato su contatore: il valore n-esimo è una funzione di (chiave, n)
+struct CounterRng {
+    uint64_t key;
+    uint64_t counter{0};
+
+    CounterRng(uint64_t seed, uint64_t stream);
+
+    uint64_t next();
+    int uniformInt(int lo, int hi);     // Intero in [lo, hi]
+    double uniform();                   // Reale in [0, 1)
+};
+
+enum WorkloadShape { SHAPE_RECTANGLE, SHAPE_FRAME, SHAPE_CIRCLE, SHAPE_RING, SHAPE_LINE, SHAPE_COUNT };
+
+struct WorkloadProfile {
+    std::string name{"default"};
+    int min_shapes{1};
+    int max_shapes{3};
+    double shape_weights[SHAPE_COUNT]{1, 1, 1, 1, 1}; // Rettangolo, cornice, cerchio, anello, linea
+    double size_scale{1.0};     // Dimensione delle forme (1 = quelle di generateBinaryImage su un lato di 400 px)
+    double target_density{0.0}; // Frazione di primo piano da raggiungere aggiungendo forme fino a max_shapes (0 = nessuna)
+    double noise{0.0};          // Probabilità di invertire ogni pixel dopo il disegno
+};
+
+// Funzione per ottenere un profilo predefinito: default, sparse, dense, noisy, lines
+WorkloadProfile workloadProfile(const std::string& name);
+
+// Funzione per generare un'immagine del carico; l'indice seleziona il flusso del generatore
+STBImage generateWorkloadImage(int width, int height, const WorkloadProfile& profile, uint64_t seed, int index, int color = 255);
+
+// Funzione per generare in memoria e in parallelo numImages immagini, chiamate image_<i>.<extension>
+std::vector<STBImage> generateWorkload(int numImages, int width, int height, const WorkloadProfile& profile,
+    uint64_t seed, int color = 255, const std::string& extension = "pgm");
+
+// Funzione per generare immagini binarie con forme casuali e salvarle in images/basis;
+// restituisce il numero di immagini che non è stato possibile scrivere
+int generateBinaryImages(int numImages, int width, int height, const WorkloadProfile& profile,
+    uint64_t seed, int color, const std::string& extension);
+
+#endif // MORPHOLOGY_GENERATOR_HPP
@@ -0,0 +1,361 @@
+#include "grayscale.hpp"
+
+#include "morphology.hpp"
+
+#include <omp.h>
+#include <cmath>
+#include <limits>
+#include <sstream>
+
+// Valore in 0..1 di un pixel (i float sono già in questa scala)
+template <typename T>
+static double toUnit(T value) {
+    if constexpr (std::is_floating_point_v<T>) return value;
+    else return (double)value / std::numeric_limits<T>::max();
+}
+
+// Pixel di tipo T da un valore in 0..1, arrotondato e saturato per gli interi
+template <typename T>
+static T fromUnit(double unit) {
+    if constexpr (std::is_floating_point_v<T>) return (T)unit;
+    else return (T)std::lround(std::clamp(unit, 0.0, 1.0) * std::numeric_limits<T>::max());
+}
+
+// Funzione per leggere l'intestazione di un PFM a un canale: "Pf", larghezza, altezza e scala
+// (negativa = little endian); restituisce la posizione dei dati o 0 se non valida
+static size_t parsePFMHeader(const uint8_t* data, size_t length, int& width, int& height, bool& little_endian) {
+    if (length < 3 || data[0] != 'P' || data[1] != 'f') return 0;
+    std::string text((const char*)data + 2, std::min(length - 2, (size_t)256));
+    std::istringstream header(text);
+    double scale = 0;
+    if (!(header >> width >> height >> scale) || width <= 0 || height <= 0 || scale == 0) return 0;
+    // Un solo carattere di spazio separa l'intestazione dai dati
+    size_t pos = (size_t)header.tellg();
+    if (pos >= text.size() || !isspace((unsigned char)text[pos])) return 0;
+    little_endian = scale < 0;
+    return 2 + pos + 1;
+}
+
+template <typename T>
+bool loadGrayImage(const std::string& name, GrayImage<T>& img) {
+    TraceScope load_trace("load", "io");
+    std::string ext = fileExtension(name);
+    if (ext == "pgm" || ext == "pnm" || ext == "pfm") {
+        auto file = MappedFile::open(name);
+        if (!file) return false;
+        int width = 0, height = 0;
+        if (ext == "pfm") {
+            bool little_endian = true;
+            size_t offset = parsePFMHeader(file->data, file->length, width, height, little_endian);
+            size_t pixels = (size_t)width * height;
+            if (offset == 0 || file->length - offset < pixels * 4) return false;
+            img.initialize(width, height, T{});
+            // Le righe del PFM vanno dal basso verso l'alto
+            for (int y = 0; y < height; y++) {
+                const uint8_t* row = file->data + offset + (size_t)(height - 1 - y) * width * 4;
+                for (int x = 0; x < width; x++) {
+                    const uint8_t* p = row + x * 4;
+                    uint32_t word = little_endian ? p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24
+                                                  : p[3] | p[2] << 8 | p[1] << 16 | (uint32_t)p[0] << 24;
+                    float value;
+                    std::memcpy(&value, &word, 4);
+                    img.data[(size_t)y * width + x] = fromUnit<T>(value);
+                }
+            }
+        } else {
+            PNMHeader header;
+            if (!parsePNMHeader(file->data, file->length, header, 65535) || header.format != '5') return false;
+            size_t pixels = (size_t)header.width * header.height;
+            int bytes = header.maxval > 255 ? 2 : 1;
+            if (file->length - header.data_offset < pixels * bytes) return false;
+            const uint8_t* body = file->data + header.data_offset;
+            img.initialize(header.width, header.height, T{});
+            for (size_t i = 0; i < pixels; i++) {
+                // I campioni a 16 bit sono big endian
+                int value = bytes == 2 ? (body[2 * i] << 8) | body[2 * i + 1] : body[i];
+                img.data[i] = fromUnit<T>((double)value / header.maxval);
+            }
+        }
+        img.filename = name;
+        return true;
+    }
+    int width, height, channels;
+    uint8_t* pixels = stbi_load(name.c_str(), &width, &height, &channels, 1);
+    if (!pixels) return false;
+    img.initialize(width, height, T{});
+    for (size_t i = 0; i < (size_t)width * height; i++) img.data[i] = fromUnit<T>(pixels[i] / 255.0);
+    stbi_image_free(pixels);
+    img.filename = name;
+    return true;
+}
+
+template <typename T>
+bool saveGrayImage(const std::string& name, const GrayImage<T>& img) {
+    TraceScope save_trace("save", "io");
+    std::string ext = fileExtension(name);
+    size_t pixels = (size_t)img.width * img.height;
+    if (ext == "pfm") {
+        std::string header = "Pf\n" + std::to_string(img.width) + " " + std::to_string(img.height) + "\n-1.0\n";
+        std::vector<uint8_t> buffer(header.size() + pixels * 4);
+        std::memcpy(buffer.data(), header.data(), header.size());
+        for (int y = 0; y < img.height; y++) {
+            uint8_t* row = buffer.data() + header.size() + (size_t)(img.height - 1 - y) * img.width * 4;
+            for (int x = 0; x < img.width; x++) {
+                float value = (float)toUnit(img.data[(size_t)y * img.width + x]);
+                uint32_t word;
+                std::memcpy(&word, &value, 4);
+                // Little endian indipendentemente dalla macchina (scala negativa nell'intestazione)
+                for (int b = 0; b < 4; b++) row[x * 4 + b] = (word >> (8 * b)) & 0xFF;
+            }
+        }
+        return writeFileAtOnce(name, buffer.data(), buffer.size());
+    }
+    bool wide = !std::is_same_v<T, uint8_t>;
+    if (ext == "pgm" || ext == "pnm") {
+        std::string header = "P5\n" + std::to_string(img.width) + " " + std::to_string(img.height) + "\n" + (wide ? "65535\n" : "255\n");
+        std::vector<uint8_t> buffer(header.size() + pixels * (wide ? 2 : 1));
+        std::memcpy(buffer.data(), header.data(), header.size());
+        uint8_t* body = buffer.data() + header.size();
+        for (size_t i = 0; i < pixels; i++) {
+            if (wide) {
+                uint16_t value = fromUnit<uint16_t>(toUnit(img.data[i]));
+                body[2 * i] = value >> 8;
+                body[2 * i + 1] = value & 0xFF;
+            } else {
+                body[i] = fromUnit<uint8_t>(toUnit(img.data[i]));
+            }
+        }
+        return writeFileAtOnce(name, buffer.data(), buffer.size());
+    }
+    std::vector<uint8_t> bytes(pixels);
+    for (size_t i = 0; i < pixels; i++) bytes[i] = fromUnit<uint8_t>(toUnit(img.data[i]));
+    return stbi_write_png(name.c_str(), img.width, img.height, 1, bytes.data(), img.width) != 0;
+}
+
+template bool loadGrayImage<uint8_t>(const std::string&, GrayImage<uint8_t>&);
+template bool loadGrayImage<uint16_t>(const std::string&, GrayImage<uint16_t>&);
+template bool loadGrayImage<float>(const std::string&, GrayImage<float>&);
+template bool saveGrayImage<uint8_t>(const std::string&, const GrayImage<uint8_t>&);
+template bool saveGrayImage<uint16_t>(const std::string&, const GrayImage<uint16_t>&);
+template bool saveGrayImage<float>(const std::string&, const GrayImage<float>&);
+
+// Funzione per eseguire il comando "gray" con un tipo di pixel
+template <typename T>
+static int runGrayOperation(const std::string& operation, const std::string& input, const std::string& output,
+                            const StructuringElement& se, T background, MinMaxPath path, bool parallel, int repeat) {
+    GrayImage<T> img;
+    if (!loadGrayImage(input, img)) {
+        std::cerr << "Impossibile leggere " << input << std::endl;
+        return 1;
+    }
+    if (img.width < se.width || img.height < se.height) {
+        std::cerr << "Elemento strutturante " << se.width << "x" << se.height << " più grande dell'immagine" << std::endl;
+        return 1;
+    }
+    GrayImage<T> (*apply)(const GrayImage<T>&, const StructuringElement&, T, MinMaxPath, bool) =
+        operation == "erosion" ? erosion_gray<T> : operation == "dilation" ? dilation_gray<T> :
+        operation == "opening" ? opening_gray<T> : closing_gray<T>;
+
+    GrayImage<T> result;
+    double best = 0;
+    for (int r = 0; r < repeat; r++) {
+        double start = omp_get_wtime();
+        result = apply(img, se, background, path, parallel);
+        double elapsed = omp_get_wtime() - start;
+        best = r == 0 ? elapsed : std::min(best, elapsed);
+    }
+    std::cout << operation << " " << img.width << "x" << img.height << " in " << best << " sec ("
+              << (double)img.width * img.height / best / 1e6 << " Mpix/s)" << std::endl;
+    if (!saveGrayImage(output, result)) {
+        std::cerr << "Impossibile scrivere " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int runGrayCommand(int argc, char* argv[], const StructuringElementSpec& se_spec, uint8_t background) {
+    if (argc < 3) {
+        std::cerr << "Uso: gray <operazione> <ingresso> <uscita> [--type uint8|uint16|float] [--path auto|direct|decomposed]"
+                  << " [--parallel] [--background valore] [--repeat n]" << std::endl;
+        return 2;
+    }
+    std::string operation = argv[0], input = argv[1], output = argv[2];
+    const auto& operations = availableOperations();
+    if (std::find(operations.begin(), operations.end(), operation) == operations.end()) {
+        std::cerr << "Operazione sconosciuta: " << operation << std::endl;
+        return 2;
+    }
+    std::string type = "uint8", path_name = "auto";
+    bool parallel = false;
+    int repeat = 1;
+    // Lo sfondo della configurazione (0..255) si riscala all'intervallo del tipo, salvo --background
+    double background_unit = background / 255.0, background_value = 0;
+    bool explicit_background = false;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--parallel") {
+            parallel = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--type") type = value;
+        else if (arg == "--path") path_name = value;
+        else if (arg == "--repeat") repeat = std::max(1, std::stoi(value));
+        else if (arg == "--background") {
+            background_value = std::stod(value);
+            explicit_background = true;
+        } else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+    }
+    MinMaxPath path;
+    if (path_name == "auto") path = MinMaxPath::Auto;
+    else if (path_name == "direct") path = MinMaxPath::Direct;
+    else if (path_name == "decomposed") path = MinMaxPath::Decomposed;
+    else {
+        std::cerr << "Percorso sconosciuto: " << path_name << " (auto, direct, decomposed)" << std::endl;
+        return 2;
+    }
+
+    StructuringElement se;
+    try {
+        se = makeStructuringElement(se_spec);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Elemento strutturante " << se_spec.shape << " " << se.width << "x" << se.height << ", scomposizione "
+              << decompositionName(planStructuringElement(se).kind) << ", pixel " << type << std::endl;
+
+    if (type == "uint8") {
+        uint8_t value = explicit_background ? (uint8_t)std::clamp(background_value, 0.0, 255.0) : fromUnit<uint8_t>(background_unit);
+        return runGrayOperation<uint8_t>(operation, input, output, se, value, path, parallel, repeat);
+    }
+    if (type == "uint16") {
+        uint16_t value = explicit_background ? (uint16_t)std::clamp(background_value, 0.0, 65535.0) : fromUnit<uint16_t>(background_unit);
+        return runGrayOperation<uint16_t>(operation, input, output, se, value, path, parallel, repeat);
+    }
+    if (type == "float") {
+        float value = explicit_background ? (float)background_value : fromUnit<float>(background_unit);
+        return runGrayOperation<float>(operation, input, output, se, value, path, parallel, repeat);
+    }
+    std::cerr << "Tipo di pixel sconosciuto: " << type << " (uint8, uint16, float)" << std::endl;
+    return 2;
+}
+
+// Funzione per eseguire il comando "weighted" con un tipo di pixel
+template <typename T>
+static int runWeightedOperation(const std::string& operation, const std::string& input, const std::string& output,
+                                const WeightedStructuringElement& se, WeightedPath path, bool parallel, int repeat, bool subtract) {
+    GrayImage<T> img;
+    if (!loadGrayImage(input, img)) {
+        std::cerr << "Impossibile leggere " << input << std::endl;
+        return 1;
+    }
+    GrayImage<T> (*apply)(const GrayImage<T>&, const WeightedStructuringElement&, WeightedPath, bool) =
+        operation == "erosion" ? erosion_weighted<T> : operation == "dilation" ? dilation_weighted<T> :
+        operation == "opening" ? opening_weighted<T> : closing_weighted<T>;
+
+    GrayImage<T> result;
+    double best = 0;
+    for (int r = 0; r < repeat; r++) {
+        double start = omp_get_wtime();
+        result = apply(img, se, path, parallel);
+        double elapsed = omp_get_wtime() - start;
+        best = r == 0 ? elapsed : std::min(best, elapsed);
+    }
+    std::cout << operation << " " << img.width << "x" << img.height << " in " << best << " sec ("
+              << (double)img.width * img.height / best / 1e6 << " Mpix/s)" << std::endl;
+    if (subtract) {
+        // Top-hat: ingresso meno apertura/erosione (sfondo della sfera che rotola sotto l'immagine),
+        // chiusura/dilatazione meno ingresso
+        bool below = operation == "erosion" || operation == "opening";
+        for (size_t i = 0; i < result.data.size(); i++) {
+            double difference = below ? (double)img.data[i] - result.data[i] : (double)result.data[i] - img.data[i];
+            if constexpr (std::is_floating_point_v<T>) result.data[i] = (T)difference;
+            else result.data[i] = (T)std::clamp(difference, 0.0, (double)std::numeric_limits<T>::max());
+        }
+    }
+    if (!saveGrayImage(output, result)) {
+        std::cerr << "Impossibile scrivere " << output << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int runWeightedCommand(int argc, char* argv[], StructuringElementSpec se_spec) {
+    if (argc < 3) {
+        std::cerr << "Uso: weighted <operazione> <ingresso> <uscita> [--type uint8|uint16|float] [--path auto|direct|separable]"
+                  << " [--shape ball|paraboloid|paraboloid_unbounded|weights|<forma piatta>] [--radius r] [--scale s] [--weights file.json]"
+                  << " [--parallel] [--subtract] [--repeat n]" << std::endl;
+        return 2;
+    }
+    std::string operation = argv[0], input = argv[1], output = argv[2];
+    const auto& operations = availableOperations();
+    if (std::find(operations.begin(), operations.end(), operation) == operations.end()) {
+        std::cerr << "Operazione sconosciuta: " << operation << std::endl;
+        return 2;
+    }
+    std::string type = "uint8", path_name = "auto";
+    bool parallel = false, subtract = false;
+    int repeat = 1;
+    for (int i = 3; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--parallel" || arg == "--subtract") {
+            (arg == "--parallel" ? parallel : subtract) = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--type") type = value;
+        else if (arg == "--path") path_name = value;
+        else if (arg == "--repeat") repeat = std::max(1, std::stoi(value));
+        else if (arg == "--shape") se_spec.shape = value;
+        else if (arg == "--radius") se_spec.radius = std::stoi(value);
+        else if (arg == "--scale") se_spec.scale = std::stod(value);
+        else if (arg == "--weights") {
+            se_spec.shape = "weights";
+            se_spec.path = value;
+        } else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+    }
+    WeightedPath path;
+    if (path_name == "auto") path = WeightedPath::Auto;
+    else if (path_name == "direct") path = WeightedPath::Direct;
+    else if (path_name == "separable") path = WeightedPath::Separable;
+    else {
+        std::cerr << "Percorso sconosciuto: " << path_name << " (auto, direct, separable)" << std::endl;
+        return 2;
+    }
+
+    WeightedStructuringElement se;
+    try {
+        se = makeWeightedStructuringElement(se_spec);
+        if (path == WeightedPath::Separable && se.paraboloid_k <= 0) throw std::invalid_argument("Il percorso separabile richiede paraboloid_unbounded");
+        if (path == WeightedPath::Direct && se.paraboloid_k > 0) {
+            throw std::invalid_argument("paraboloid_unbounded non ha un supporto finito: richiede il percorso separabile");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    std::cout << "Elemento strutturante " << se_spec.shape << " " << se.width << "x" << se.height
+              << (se.paraboloid_k > 0 ? ", paraboloide illimitato separabile" : ", percorso diretto")
+              << ", pixel " << type << std::endl;
+
+    if (type == "uint8") return runWeightedOperation<uint8_t>(operation, input, output, se, path, parallel, repeat, subtract);
+    if (type == "uint16") return runWeightedOperation<uint16_t>(operation, input, output, se, path, parallel, repeat, subtract);
+    if (type == "float") return runWeightedOperation<float>(operation, input, output, se, path, parallel, repeat, subtract);
+    std::cerr << "Tipo di pixel sconosciuto: " << type << " (uint8, uint16, float)" << std::endl;
+    return 2;
+}
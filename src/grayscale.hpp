@@ -0,0 +1,31 @@
+#ifndef MORPHOLOGY_GRAYSCALE_HPP
+#define MORPHOLOGY_GRAYSCALE_HPP
+
+#include "image.hpp"
+
+// IMMAGINI IN SCALA DI GRIGI
+//
+// Lettura e scrittura di GrayImage<T> per le operazioni *_gray e *_weighted (morphology.hpp). Formati:
+// PGM (P5) a 8 e 16 bit, PFM a un canale ("Pf") e, solo in lettura e a 8 bit, i formati di stb_image.
+// I valori si riscalano all'intervallo del tipo di pixel (uint8_t 0..255, uint16_t 0..65535, float
+// 0..1): un PGM con maxval uguale al massimo del tipo si legge e si scrive senza perdite.
+
+// Funzione per caricare un'immagine in scala di grigi (false se il file non si legge)
+template <typename T>
+bool loadGrayImage(const std::string& name, GrayImage<T>& img);
+
+// Funzione per salvare un'immagine in scala di grigi (formato dall'estensione: pfm, pgm/pnm, altrimenti png
+// a 8 bit); i PGM sono a 8 bit per uint8_t e a 16 bit per gli altri tipi
+template <typename T>
+bool saveGrayImage(const std::string& name, const GrayImage<T>& img);
+
+// Comando "gray <operazione> <ingresso> <uscita> [opzioni]": operazione in scala di grigi con
+// l'elemento strutturante della configurazione
+int runGrayCommand(int argc, char* argv[], const StructuringElementSpec& se_spec, uint8_t background);
+
+// Comando "weighted <operazione> <ingresso> <uscita> [opzioni]": operazione con un elemento strutturante
+// non piatto (sfera, paraboloide o altezze da file); --subtract scrive il top-hat, ad esempio l'immagine
+// meno lo sfondo stimato dall'apertura con la sfera
+int runWeightedCommand(int argc, char* argv[], StructuringElementSpec se_spec);
+
+#endif // MORPHOLOGY_GRAYSCALE_HPP
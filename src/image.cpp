@@ -0,0 +1,318 @@
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "image.hpp"
+#include "container.hpp"
+
+#include <sstream>
+#include <ctime>
+#include <cmath>
+
+// change OMP_NUM_THREADS environment variable to run with 1 to X threads...
+// check configuration in drop down menu
+// XXX check working directory so that ./images and ./output are valid !
+
+// Estensione di un file in minuscolo, senza il punto (es. "pgm")
+std::string fileExtension(const std::string& name) {
+    std::string ext = std::filesystem::path(name).extension().string();
+    if (!ext.empty() && ext[0] == '.') ext.erase(0, 1);
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return std::tolower(c); });
+    return ext;
+}
+
+// Scrive un buffer su file con un'unica chiamata write (ripetuta solo in caso di scrittura parziale)
+bool writeFileAtOnce(const std::string& name, const uint8_t* data, size_t length) {
+#ifdef _WIN32
+    std::ofstream out(name, std::ios::binary | std::ios::trunc);
+    out.write((const char*)data, length);
+    return (bool)out;
+#else
+    int fd = ::open(name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+    size_t written = 0;
+    while (written < length) {
+        ssize_t n = write(fd, data + written, length - written);
+        if (n <= 0) {
+            close(fd);
+            return false;
+        }
+        written += n;
+    }
+    return close(fd) == 0;
+#endif
+}
+
+// Funzione per leggere l'intestazione PNM, saltando spazi e commenti
+bool parsePNMHeader(const uint8_t* data, size_t length, PNMHeader& header, int max_maxval) {
+    if (length < 3 || data[0] != 'P' || (data[1] != '4' && data[1] != '5')) return false;
+    header.format = data[1];
+    size_t pos = 2;
+    int fields = header.format == '5' ? 3 : 2;
+    int values[3] = {0, 0, 1};
+    for (int f = 0; f < fields; f++) {
+        while (pos < length && (isspace(data[pos]) || data[pos] == '#')) {
+            if (data[pos] == '#') {
+                while (pos < length && data[pos] != '\n') pos++;
+            } else {
+                pos++;
+            }
+        }
+        if (pos >= length || !isdigit(data[pos])) return false;
+        long value = 0;
+        while (pos < length && isdigit(data[pos])) {
+            value = value * 10 + (data[pos++] - '0');
+            if (value > (1L << 30)) return false;
+        }
+        values[f] = (int)value;
+    }
+    // Un solo carattere di spazio separa l'intestazione dai dati
+    if (pos >= length || !isspace(data[pos])) return false;
+    header.width = values[0];
+    header.height = values[1];
+    header.maxval = values[2];
+    header.data_offset = pos + 1;
+    return header.width > 0 && header.height > 0 && header.maxval > 0 && header.maxval <= max_maxval;
+}
+
+// Funzione per creare un cammino di cartelle
+void createPath(const std::string &path) {
+    std::istringstream ss(path);
+    std::string partialPath;
+    std::vector<std::string> directories;
+    
+    // Dividere il percorso nelle singole directory
+    while (std::getline(ss, partialPath, '/')) {
+        directories.push_back(partialPath);
+    }
+
+    std::string currentPath;
+    for (const auto &dir : directories) {
+        if (!currentPath.empty()) {
+            currentPath += "/";
+        }
+        currentPath += dir;
+
+        struct stat info;
+        if (stat(currentPath.c_str(), &info) != 0) { // Se la cartella non esiste
+            MKDIR(currentPath.c_str());
+        }
+    }
+}
+
+// Funzione per binarizzare un buffer di pixel a 0/255 esatti (vettorizzata con OpenMP SIMD)
+void binarizePixels(uint8_t* data, size_t n, uint8_t threshold) {
+    #pragma omp simd
+    for (size_t i = 0; i < n; i++) {
+        data[i] = data[i] >= threshold ? 255 : 0;
+    }
+}
+
+// Funzione per verificare se un buffer contiene solo 0 e 255 (evita scritture inutili su viste mappate)
+bool isBinaryPixels(const uint8_t* data, size_t n) {
+    int non_binary = 0;
+    #pragma omp simd reduction(|:non_binary)
+    for (size_t i = 0; i < n; i++) {
+        non_binary |= (data[i] != 0) & (data[i] != 255);
+    }
+    return non_binary == 0;
+}
+
+// Funzione per elencare i file di una cartella in ordine deterministico (nome file)
+std::vector<std::string> listImageFiles(const std::string& directory) {
+    std::vector<std::string> filenames;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            filenames.push_back(entry.path().string());
+        }
+    }
+    std::sort(filenames.begin(), filenames.end());
+    return filenames;
+}
+
+// Funzione per caricare immagini in un vettore (accetta anche un contenitore .mpk)
+std::vector<STBImage> loadImagesFromDirectory(const std::string& directory) {
+    if (std::filesystem::is_regular_file(directory) && fileExtension(directory) == "mpk") {
+        return loadImagesFromContainer(directory, false);
+    }
+    std::vector<STBImage> images;
+    for (const auto& entry : std::filesystem::directory_iterator(directory)) {
+        if (entry.is_regular_file()) {
+            std::string filename = entry.path().string();
+            STBImage img;
+            if (img.loadImage(filename)) {
+                images.push_back(std::move(img));
+            }
+        }
+    }
+    return images;
+}
+
+// Funzione per caricare in parallelo le immagini di una cartella (o di un contenitore .mpk), in ordine
+// deterministico e binarizzandole durante il caricamento, così gli artefatti JPEG non alterano i test == 0 / == 255
+std::vector<STBImage> loadImagesFromDirectoryParallel(const std::string& directory, bool binarize) {
+    if (std::filesystem::is_regular_file(directory) && fileExtension(directory) == "mpk") {
+        return loadImagesFromContainer(directory, binarize);
+    }
+    std::vector<std::string> filenames = listImageFiles(directory);
+
+    // Slot preallocati: ogni thread decodifica nella propria posizione, senza sezioni critiche
+    std::vector<STBImage> slots(filenames.size());
+    std::vector<char> loaded(filenames.size(), 0);
+
+    #pragma omp parallel for schedule(dynamic) shared(filenames, slots, loaded, binarize) default(none)
+    for (size_t i = 0; i < filenames.size(); i++) {
+        if (slots[i].loadImage(filenames[i])) {
+            // loadImage forza un solo canale: il buffer ha width * height byte qualunque sia il file
+            slots[i].channels = 1;
+            size_t pixels = (size_t)slots[i].width * slots[i].height;
+            if (binarize && !isBinaryPixels(slots[i].image_data, pixels)) {
+                binarizePixels(slots[i].image_data, pixels);
+            }
+            loaded[i] = 1;
+        }
+    }
+
+    std::vector<STBImage> images;
+    images.reserve(filenames.size());
+    for (size_t i = 0; i < slots.size(); i++) {
+        if (loaded[i]) {
+            images.push_back(std::move(slots[i]));
+        }
+    }
+    return images;
+}
+
+// Riempie le colonne [x0, x1] della riga y (già ritagliate) e restituisce i pixel cambiati
+static size_t fillSpan(STBImage &img, int y, int x0, int x1, int color) {
+    x0 = std::max(x0, 0);
+    x1 = std::min(x1, img.width - 1);
+    if (y < 0 || y >= img.height || x0 > x1) return 0;
+    uint8_t* row = img.image_data + (size_t)y * img.width;
+    size_t changed = 0;
+    for (int x = x0; x <= x1; x++) changed += row[x] != (uint8_t)color;
+    std::memset(row + x0, color, x1 - x0 + 1);
+    return changed;
+}
+
+// Radice intera per difetto: il più grande r con r*r <= v (v >= 0)
+static int isqrtFloor(long long v) {
+    long long r = (long long)std::sqrt((double)v);
+    while (r * r > v) r--;
+    while ((r + 1) * (r + 1) <= v) r++;
+    return (int)r;
+}
+
+// Disegna un rettangolo pieno
+size_t drawRectangle(STBImage &img, int x, int y, int w, int h, int color) {
+    size_t changed = 0;
+    for (int i = std::max(y, 0); i < std::min(y + h, img.height); i++)
+        changed += fillSpan(img, i, x, x + w - 1, color);
+    return changed;
+}
+
+// Disegna una cornice rettangolare (rettangolo con buco)
+size_t drawHollowRectangle(STBImage &img, int x, int y, int w, int h, int thickness, int color) {
+    size_t changed = drawRectangle(img, x, y, w, thickness, color);
+    changed += drawRectangle(img, x, y + h - thickness, w, thickness, color);
+    changed += drawRectangle(img, x, y, thickness, h, color);
+    changed += drawRectangle(img, x + w - thickness, y, thickness, h, color);
+    return changed;
+}
+
+// Disegna un cerchio pieno, riga per riga sul solo riquadro che lo contiene
+size_t drawCircle(STBImage &img, int cx, int cy, int radius, int color) {
+    size_t changed = 0;
+    if (radius < 0) return 0;
+    for (int y = std::max(cy - radius, 0); y <= std::min(cy + radius, img.height - 1); y++) {
+        int half = isqrtFloor((long long)radius * radius - (long long)(y - cy) * (y - cy));
+        changed += fillSpan(img, y, cx - half, cx + half, color);
+    }
+    return changed;
+}
+
+// Disegna un anello (cerchio con buco): per ogni riga uno o due segmenti
+size_t drawHollowCircle(STBImage &img, int cx, int cy, int outerRadius, int innerRadius, int color) {
+    size_t changed = 0;
+    if (outerRadius < 0) return 0;
+    for (int y = std::max(cy - outerRadius, 0); y <= std::min(cy + outerRadius, img.height - 1); y++) {
+        long long dy2 = (long long)(y - cy) * (y - cy);
+        int outer = isqrtFloor((long long)outerRadius * outerRadius - dy2);
+        long long inner2 = (long long)innerRadius * innerRadius - dy2;
+        if (inner2 <= 0) {
+            changed += fillSpan(img, y, cx - outer, cx + outer, color);
+            continue;
+        }
+        // Colonne con dx*dx >= inner2, cioè |dx| >= ceil(sqrt(inner2))
+        int inner = isqrtFloor(inner2);
+        if ((long long)inner * inner < inner2) inner++;
+        if (inner > outer) continue;
+        changed += fillSpan(img, y, cx - outer, cx - inner, color);
+        changed += fillSpan(img, y, cx + inner, cx + outer, color);
+    }
+    return changed;
+}
+
+// Disegna una linea
+size_t drawLine(STBImage &img, int x1, int y1, int x2, int y2, int color) {
+    int dx = abs(x2 - x1), dy = abs(y2 - y1);
+    int sx = x1 < x2 ? 1 : -1, sy = y1 < y2 ? 1 : -1, err = dx - dy;
+    size_t changed = 0;
+
+    while (true) {
+        if (x1 >= 0 && x1 < img.width && y1 >= 0 && y1 < img.height) {
+            uint8_t& pixel = img.image_data[y1 * img.width + x1];
+            changed += pixel != (uint8_t)color;
+            pixel = color;
+        }
+        if (x1 == x2 && y1 == y2) break;
+        int e2 = err * 2;
+        if (e2 > -dy) { err -= dy; x1 += sx; }
+        if (e2 < dx) { err += dx; y1 += sy; }
+    }
+    return changed;
+}
+
+// Funzione per generare in memoria un'immagine binaria con numShapes forme casuali
+STBImage generateBinaryImage(int width, int height, int numShapes, int color) {
+    STBImage img;
+    img.initializeBinary(width, height, 255 - color);
+    for (int j = 0; j < numShapes; j++) {
+        int shapeType = rand() % 5; // 0: Rettangolo, 1: Cornice rettangolare, 2: Cerchio, 3: Anello, 4: Linea
+
+        if (shapeType == 0) {
+            int x = rand() % std::max(1, img.width - 50);
+            int y = rand() % std::max(1, img.height - 50);
+            int w = rand() % (img.width - x);
+            int h = rand() % (img.height - y);
+            drawRectangle(img, x, y, w, h, color);
+        } 
+        else if (shapeType == 1) {
+            int x = rand() % std::max(1, img.width - 100);
+            int y = rand() % std::max(1, img.height - 100);
+            int w = rand() % 100 + 40;
+            int h = rand() % 100 + 40;
+            int thickness = 10;
+            drawHollowRectangle(img, x, y, w, h, thickness, color);
+        } 
+        else if (shapeType == 2) {
+            int cx = rand() % std::max(1, img.width - 50);
+            int cy = rand() % std::max(1, img.height - 50);
+            int radius = rand() % 50 + 10;
+            drawCircle(img, cx, cy, radius, color);
+        } 
+        else if (shapeType == 3) {
+            int cx = rand() % std::max(1, img.width - 50);
+            int cy = rand() % std::max(1, img.height - 50);
+            int outerRadius = rand() % 50 + 30;
+            int innerRadius = rand() % (outerRadius - 10) + 10;
+            drawHollowCircle(img, cx, cy, outerRadius, innerRadius, color);
+        } 
+        else {
+            int x1 = rand() % img.width;
+            int y1 = rand() % img.height;
+            int x2 = rand() % img.width;
+            int y2 = rand() % img.height;
+            drawLine(img, x1, y1, x2, y2, color);
+        }
+    }
+    return img;
+}
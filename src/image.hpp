@@ -0,0 +1,487 @@
+#ifndef MORPHOLOGY_IMAGE_HPP
+#define MORPHOLOGY_IMAGE_HPP
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <cstring>
+#include <cstdint>
+
+#include <sys/stat.h>  // Per creare cartelle
+#include <sys/types.h>
+#ifdef _WIN32
+    #include <direct.h>
+    #define MKDIR(path) _mkdir(path)
+#else
+    #include <unistd.h>
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #define MKDIR(path) mkdir(path, 0777)
+#endif
+
+#include "alloc_tracker.hpp"
+
+// Le allocazioni di stb_image e stb_image_write passano dai contatori della memoria
+#define STBI_MALLOC(size) trackedMalloc(size)
+#define STBI_REALLOC(ptr, size) trackedRealloc(ptr, size)
+#define STBI_FREE(ptr) trackedFree(ptr)
+#define STBIW_MALLOC(size) trackedMalloc(size)
+#define STBIW_REALLOC(ptr, size) trackedRealloc(ptr, size)
+#define STBIW_FREE(ptr) trackedFree(ptr)
+
+#include <stb/stb_image.h>
+#include <stb/stb_image_write.h>
+
+#include <nlohmann/json.hpp>
+
+#include "trace.hpp"
+
+using json = nlohmann::json;
+
+// Colore dei pixel di sfondo e di bordo dei risultati se la configurazione non ne indica un altro
+const uint8_t DEFAULT_BACKGROUND_COLOR = 0;
+
+// Estensione di un file in minuscolo, senza il punto (es. "pgm")
+std::string fileExtension(const std::string& name);
+
+// File mappato in memoria (MAP_PRIVATE: eventuali scritture restano locali al processo)
+struct MappedFile {
+    uint8_t* data{nullptr};
+    size_t length{0};
+#ifdef _WIN32
+    std::vector<uint8_t> buffer;
+#endif
+
+    MappedFile() {}
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data) munmap(data, length);
+#endif
+    }
+
+    static std::shared_ptr<MappedFile> open(const std::string& name) {
+        auto file = std::make_shared<MappedFile>();
+#ifdef _WIN32
+        std::ifstream in(name, std::ios::binary);
+        if (!in) return nullptr;
+        file->buffer.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+        file->data = file->buffer.data();
+        file->length = file->buffer.size();
+#else
+        int fd = ::open(name.c_str(), O_RDONLY);
+        if (fd < 0) return nullptr;
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            close(fd);
+            return nullptr;
+        }
+        void* addr = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        close(fd);
+        if (addr == MAP_FAILED) return nullptr;
+        file->data = (uint8_t*)addr;
+        file->length = info.st_size;
+#endif
+        return file;
+    }
+};
+
+// Scrive un buffer su file con un'unica chiamata write (ripetuta solo in caso di scrittura parziale)
+bool writeFileAtOnce(const std::string& name, const uint8_t* data, size_t length);
+
+// Intestazione di un file PNM binario (P4 = PBM a 1 bit, P5 = PGM a 8 bit)
+struct PNMHeader {
+    char format{0};     // '4' oppure '5'
+    int width{0}, height{0}, maxval{1};
+    size_t data_offset{0};
+};
+
+// Funzione per leggere l'intestazione PNM, saltando spazi e commenti (maxval fino a max_maxval: 255 per le
+// maschere binarie, 65535 per i PGM a 16 bit in scala di grigi)
+bool parsePNMHeader(const uint8_t* data, size_t length, PNMHeader& header, int max_maxval = 255);
+
+struct STBImage {
+    int width{0}, height{0}, channels{0};
+    uint8_t *image_data{nullptr};
+    std::string filename{};
+    bool allocated_with_stb{false};
+    std::shared_ptr<MappedFile> mapping{}; // Se presente, image_data è una vista nel file mappato
+
+    STBImage(){}
+
+    ~STBImage() {
+        freeImage();
+    }
+
+    // Costruttore di copia
+    STBImage(const STBImage& other) {
+        width = other.width;
+        height = other.height;
+        channels = other.channels;
+        filename = other.filename;
+        allocated_with_stb = false;
+        if (other.image_data) {
+            image_data = (uint8_t*)trackedMalloc(width * height * channels);
+            std::copy(other.image_data, other.image_data + (width * height * channels), image_data);
+        }
+    }
+
+    // Operatore di assegnazione di copia
+    STBImage& operator=(const STBImage& other) {
+        if (this != &other) {
+            freeImage();
+            width = other.width;
+            height = other.height;
+            channels = other.channels;
+            filename = other.filename;
+            allocated_with_stb = false;
+            if (other.image_data) {
+                image_data = (uint8_t*)trackedMalloc(width * height * channels);
+                std::copy(other.image_data, other.image_data + (width * height * channels), image_data);
+            }
+        }
+        return *this;
+    }
+
+    // Costruttore di spostamento
+    STBImage(STBImage&& other) noexcept {
+        width = other.width;
+        height = other.height;
+        channels = other.channels;
+        image_data = other.image_data;
+        filename = other.filename;
+        allocated_with_stb = other.allocated_with_stb;
+        mapping = std::move(other.mapping);
+        other.image_data = nullptr;
+    }
+
+    // Operatore di assegnazione di spostamento
+    STBImage& operator=(STBImage&& other) noexcept {
+        if (this != &other) {
+            freeImage();
+            width = other.width;
+            height = other.height;
+            channels = other.channels;
+            image_data = other.image_data;
+            allocated_with_stb = other.allocated_with_stb;
+            mapping = std::move(other.mapping);
+            other.image_data = nullptr;
+        }
+        return *this;
+    }
+
+    // Funzione per caricare un'immagine (PGM/PBM nativi, altri formati tramite stb_image)
+    bool loadImage(const std::string &name) {
+        TraceScope load_trace("load", "io");
+        freeImage(); // Libera l'immagine precedente se esiste
+        std::string ext = fileExtension(name);
+        if (ext == "pgm" || ext == "pbm" || ext == "pnm")
+            return loadPNM(name);
+        image_data = stbi_load(name.c_str(), &width, &height, &channels, 1); // Immagine binaria (1 canale)
+        if (!image_data)
+            return false;
+        else {
+            channels = 1; // stbi_load ha convertito a 1 canale, indipendentemente dal file
+            filename = name;
+            allocated_with_stb = true; // Indica che l'immagine è stata allocata con stbi_load
+            return true;
+        }
+    }
+
+    // Funzione per caricare un PGM (P5) o PBM (P4) tramite mmap.
+    // Un PGM a 8 bit con maxval 255 non viene copiato: image_data punta direttamente al corpo del file.
+    bool loadPNM(const std::string &name) {
+        freeImage();
+        auto file = MappedFile::open(name);
+        PNMHeader header;
+        if (!file || !parsePNMHeader(file->data, file->length, header))
+            return false;
+
+        size_t pixels = (size_t)header.width * header.height;
+        size_t row_bytes = header.format == '4' ? (header.width + 7) / 8 : header.width;
+        if (file->length - header.data_offset < row_bytes * header.height)
+            return false;
+        const uint8_t* body = file->data + header.data_offset;
+
+        width = header.width;
+        height = header.height;
+        channels = 1;
+        filename = name;
+        allocated_with_stb = false;
+
+        if (header.format == '5' && header.maxval == 255) {
+            image_data = file->data + header.data_offset;
+            mapping = std::move(file);
+            return true;
+        }
+
+        image_data = (uint8_t*)trackedMalloc(pixels);
+        if (header.format == '5') {
+            // Riscala i valori a 0..255
+            for (size_t i = 0; i < pixels; i++)
+                image_data[i] = (uint8_t)((body[i] * 255 + header.maxval / 2) / header.maxval);
+        } else {
+            // PBM: bit a 1 = nero (0), bit a 0 = bianco (255), righe allineate al byte
+            for (int y = 0; y < height; y++) {
+                const uint8_t* row = body + y * row_bytes;
+                uint8_t* out = image_data + (size_t)y * width;
+                for (int x = 0; x < width; x++)
+                    out[x] = (row[x >> 3] >> (7 - (x & 7))) & 1 ? 0 : 255;
+            }
+        }
+        return true;
+    }
+
+    // Funzione per salvare l'immagine (formato scelto dall'estensione: pgm, pbm, altrimenti jpg);
+    // false se il file non è stato scritto per intero
+    bool saveImage(const std::string &newName) const {
+        TraceScope save_trace("save", "io");
+        std::string ext = fileExtension(newName);
+        if (ext == "pgm" || ext == "pnm") return savePNM(newName, false);
+        if (ext == "pbm") return savePNM(newName, true);
+        return stbi_write_jpg(newName.c_str(), width, height, channels, image_data, width) != 0;
+    }
+
+    // Funzione per salvare in PGM (8 bit) o PBM (1 bit impacchettato) con un'unica write
+    bool savePNM(const std::string &newName, bool packed) const {
+        if (!image_data || channels != 1)
+            return false;
+        std::string header = std::string(packed ? "P4\n" : "P5\n") + std::to_string(width) + " " + std::to_string(height) + "\n" + (packed ? "" : "255\n");
+        size_t row_bytes = packed ? (width + 7) / 8 : width;
+        std::vector<uint8_t> buffer(header.size() + row_bytes * height, 0);
+        std::memcpy(buffer.data(), header.data(), header.size());
+        uint8_t* body = buffer.data() + header.size();
+        if (!packed) {
+            std::memcpy(body, image_data, (size_t)width * height);
+        } else {
+            for (int y = 0; y < height; y++) {
+                const uint8_t* row = image_data + (size_t)y * width;
+                uint8_t* out = body + y * row_bytes;
+                for (int x = 0; x < width; x++)
+                    if (row[x] < 128) out[x >> 3] |= 0x80 >> (x & 7);
+            }
+        }
+        return writeFileAtOnce(newName, buffer.data(), buffer.size());
+    }
+
+    void freeImage() {
+        if (image_data) {
+            if (mapping)
+                mapping.reset();
+            else if (allocated_with_stb)
+                stbi_image_free(image_data);
+            else
+                trackedFree(image_data);
+            image_data = nullptr;
+        }
+    }
+
+    // Funzione per inizializzare un'immagine binaria
+    void initializeBinary(int w, int h, int color) {
+        freeImage();
+        width = w;
+        height = h;
+        channels = 1; // Immagine binaria con 1 canale
+        image_data = (uint8_t*)trackedMalloc(width * height * channels);
+        allocated_with_stb = false;
+
+        // Inizializza l'immagine a nera (tutti i pixel sono 0)
+        for (int i = 0; i < width * height * channels; i++) {
+            image_data[i] = color; // 0 = nero, 255 = bianco
+        }
+    }
+};
+
+// Immagine in scala di grigi a un canale con pixel di tipo T (uint8_t, uint16_t o float), per le
+// operazioni *_gray; lettura e scrittura in grayscale.hpp
+template <typename T>
+struct GrayImage {
+    int width{0}, height{0};
+    std::vector<T> data;
+    std::string filename{};
+
+    // Funzione per inizializzare l'immagine a un valore costante
+    void initialize(int w, int h, T value) {
+        width = w;
+        height = h;
+        data.assign((size_t)w * h, value);
+    }
+};
+
+// Scomposizione esatta con cui la versione V4 calcola un elemento strutturante (morphology.hpp)
+enum class SEDecomposition {
+    None,           // Da ricavare dalla maschera
+    Separable,      // Rettangolo: una passata orizzontale e una verticale
+    Diamond,        // Rombo di raggio r: r passate della croce 3x3
+    Octagon,        // Quadrato seguito da un rombo
+    Cross,          // Unione di un segmento orizzontale e uno verticale
+    Chords          // Unione di corde orizzontali (ellisse, linea, maschere qualsiasi)
+};
+
+// Funzione per portare l'ancora al centro di un kernel aggiungendo righe e colonne vuote: le versioni
+// leggono i vicini fino a anchor_x / anchor_y pixel su entrambi i lati
+std::vector<std::vector<int>> centreStructuringElement(std::vector<std::vector<int>> kernel, int anchor_x, int anchor_y);
+
+struct StructuringElement {
+    std::vector<std::vector<int>> kernel;
+    int width, height;
+    int anchor_x, anchor_y; 
+    SEDecomposition decomposition{SEDecomposition::None};  // Registrata dalla forma che l'ha generato
+    int decomposition_radius{0};                            // Octagon: raggio del rombo
+
+    StructuringElement(std::vector<std::vector<int>> k): 
+        kernel(std::move(k)),
+        width(kernel.empty() ? 0 : kernel[0].size()), 
+        height(kernel.size()),
+        anchor_x(width / 2), 
+        anchor_y(height / 2) {}
+
+    // Maschera con l'ancora in (ax, ay), ricentrata
+    StructuringElement(std::vector<std::vector<int>> k, int ax, int ay):
+        StructuringElement(centreStructuringElement(std::move(k), ax, ay)) {}
+
+    StructuringElement() : width(0), height(0), anchor_x(0), anchor_y(0) {}
+
+    // Funzione per cambiare il kernel
+    void setKernel(std::vector<std::vector<int>> new_kernel) {
+        kernel = std::move(new_kernel);
+        width = kernel.empty() ? 0 : kernel[0].size();
+        height = kernel.size();
+        anchor_x = width / 2;
+        anchor_y = height / 2;
+        decomposition = SEDecomposition::None;
+        decomposition_radius = 0;
+    }
+
+    // Funzione per stampare il kernel
+    void print() const {
+        std::cout << "Elemento Strutturante:" << std::endl;
+        for (const auto& row : kernel) {
+            for (int val : row) {
+                std::cout << val << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
+
+    void saveImage(const std::string& filename) const {
+        int rows = kernel.size();
+        int cols = kernel[0].size();
+        std::vector<unsigned char> image(rows * cols, 0); // Inizializza tutta l'immagine a nero (0)
+
+        // Riempie l'immagine con i valori del kernel
+        for (int i = 0; i < rows; ++i) {
+            for (int j = 0; j < cols; ++j) {
+                image[i * cols + j] = kernel[i][j] ? 255 : 0; // 255 = bianco, 0 = nero
+            }
+        }
+
+        // Salva l'immagine in formato JPG
+        stbi_write_jpg(filename.c_str(), cols, rows, 1, image.data(), 100);
+
+        //std::cout << "Immagine salvata come: " << filename << std::endl;
+    }
+};
+
+// Funzione per creare un cammino di cartelle
+void createPath(const std::string &path);
+
+// Funzione per binarizzare un buffer di pixel a 0/255 esatti (vettorizzata con OpenMP SIMD)
+void binarizePixels(uint8_t* data, size_t n, uint8_t threshold = 128);
+
+// Funzione per verificare se un buffer contiene solo 0 e 255 (evita scritture inutili su viste mappate)
+bool isBinaryPixels(const uint8_t* data, size_t n);
+
+// Funzione per elencare i file di una cartella in ordine deterministico (nome file)
+std::vector<std::string> listImageFiles(const std::string& directory);
+
+// Funzione per caricare immagini in un vettore (accetta anche un contenitore .mpk)
+std::vector<STBImage> loadImagesFromDirectory(const std::string& directory);
+
+// Funzione per caricare in parallelo le immagini di una cartella (o di un contenitore .mpk), in ordine
+// deterministico e binarizzandole durante il caricamento, così gli artefatti JPEG non alterano i test == 0 / == 255
+std::vector<STBImage> loadImagesFromDirectoryParallel(const std::string& directory, bool binarize = true);
+
+// Funzioni di disegno ritagliate sui bordi; restituiscono il numero di pixel cambiati
+
+// Disegna un rettangolo pieno
+size_t drawRectangle(STBImage &img, int x, int y, int w, int h, int color);
+
+// Disegna una cornice rettangolare (rettangolo con buco)
+size_t drawHollowRectangle(STBImage &img, int x, int y, int w, int h, int thickness, int color);
+
+// Disegna un cerchio pieno
+size_t drawCircle(STBImage &img, int cx, int cy, int radius, int color);
+
+// Disegna un anello (cerchio con buco)
+size_t drawHollowCircle(STBImage &img, int cx, int cy, int outerRadius, int innerRadius, int color);
+
+// Disegna una linea
+size_t drawLine(STBImage &img, int x1, int y1, int x2, int y2, int color);
+
+// Funzione per generare in memoria un'immagine binaria con numShapes forme casuali
+STBImage generateBinaryImage(int width, int height, int numShapes, int color);
+
+// Parametri di un elemento strutturante. Le forme che dipendono solo dal raggio (disk, square, cross,
+// diamond, octagon) ignorano gli altri campi; per le altre i campi a 0 si ricavano dal raggio
+struct StructuringElementSpec {
+    std::string shape{"disk"};
+    int radius{5};
+    int width{0}, height{0};    // rectangle: lati; ellipse: assi (0 = 2r+1 e r+1)
+    int length{0};              // line: lunghezza in pixel (0 = 2r+1)
+    double angle{0};            // line: gradi in senso antiorario dall'asse x
+    std::string path;           // mask: immagine (pixel >= 128 attivi) o JSON {"kernel": [[0,1,..],..], "anchor": [x, y]};
+                                // weights: JSON {"weights": [[s, null, ..],..], "anchor": [x, y]}
+    int anchor_x{-1}, anchor_y{-1};     // mask, weights: ancora (negativa = centro o quella del JSON)
+    double scale{1.0};          // ball, paraboloid: altezza in unità di intensità per pixel di raggio
+
+    StructuringElementSpec() = default;
+    // Forma che dipende solo dal raggio, con gli altri campi ai valori predefiniti
+    StructuringElementSpec(std::string shape, int radius) : shape(std::move(shape)), radius(radius) {}
+};
+
+// Funzione per leggere i parametri da un oggetto JSON ("shape", "radius", "width", ...); i campi assenti
+// mantengono i valori di spec (std::invalid_argument se un campo ha un tipo non valido)
+StructuringElementSpec parseStructuringElementSpec(const json& object, StructuringElementSpec spec = {});
+
+// Funzione per costruire un elemento strutturante con la scomposizione registrata dalla sua forma
+// (std::invalid_argument per forme o parametri non validi, std::runtime_error se la maschera non si legge)
+StructuringElement makeStructuringElement(const StructuringElementSpec& spec);
+
+// Funzione per generare un elemento strutturante senza leggere file: come makeStructuringElement, ma
+// std::invalid_argument anche per "mask". Le dimensioni dipendono dalla forma (line e rectangle non sono
+// quadrati): si leggono da width e height
+StructuringElement generateStructuringElement(const StructuringElementSpec& spec);
+
+// Forme accettate da makeStructuringElement (tutte tranne "mask" anche da generateStructuringElement)
+const std::vector<std::string>& availableStructuringElementShapes();
+
+// Elemento strutturante non piatto: altezza s(b) per ogni spostamento b del supporto. La dilatazione è
+// max_b f(x + b) + s(b), l'erosione min_b f(x + b) - s(b) (spostamenti non riflessi, come in V1)
+struct WeightedStructuringElement {
+    std::vector<std::vector<double>> weights;   // Altezze (ignorate fuori dal supporto)
+    std::vector<std::vector<int>> support;      // 1 = spostamento nel supporto
+    int width{0}, height{0};
+    int anchor_x{0}, anchor_y{0};
+    // > 0: paraboloide s(b) = -paraboloid_k * |b|^2 a supporto illimitato ("paraboloid_unbounded"),
+    // calcolabile solo per righe e colonne; weights e support ne riportano la parte nel disco di raggio
+    // spec.radius, ma non bastano a calcolarlo
+    double paraboloid_k{0};
+};
+
+// Funzione per costruire un elemento strutturante non piatto: "ball" (calotta sferica di raggio r,
+// s(b) = scale * (sqrt(r^2 - |b|^2) - r)), "paraboloid" (s(b) = -scale * |b|^2 / (2r), il paraboloide
+// osculatore della sfera, troncato al disco di raggio r), "paraboloid_unbounded" (lo stesso paraboloide
+// su tutta l'immagine), "weights" (altezze da JSON) o una forma piatta (altezze 0)
+WeightedStructuringElement makeWeightedStructuringElement(const StructuringElementSpec& spec);
+
+// Forme non piatte accettate da makeWeightedStructuringElement oltre a quelle piatte
+const std::vector<std::string>& availableWeightedShapes();
+
+#endif // MORPHOLOGY_IMAGE_HPP
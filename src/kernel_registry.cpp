@@ -0,0 +1,352 @@
+#include "kernel_registry.hpp"
+
+#include "trace.hpp"
+
+#include <omp.h>
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+
+// Adattatori per le versioni senza tiling, che non ricevono tile_size
+template <STBImage (*F)(const STBImage&, const StructuringElement&, uint8_t)>
+static STBImage untiled(const STBImage& img, const StructuringElement& se, int, uint8_t background) {
+    return F(img, se, background);
+}
+
+template <std::unordered_map<std::string, STBImage> (*F)(const std::vector<STBImage>&, const StructuringElement&, uint8_t)>
+static std::unordered_map<std::string, STBImage> untiledBatch(const std::vector<STBImage>& imgs, const StructuringElement& se, int, uint8_t background) {
+    return F(imgs, se, background);
+}
+
+static std::vector<KernelEntry>& registryStorage() {
+    static std::vector<KernelEntry> registry = {
+        {"V1", {false, false, true, 0, false},
+            {untiled<erosion_V1>, untiled<dilation_V1>, untiled<opening_V1>, untiled<closing_V1>},
+            {untiledBatch<erosion_V1_imgvec>, untiledBatch<dilation_V1_imgvec>, untiledBatch<opening_V1_imgvec>, untiledBatch<closing_V1_imgvec>}, {}},
+        {"V2", {false, false, false, 0, false},
+            {untiled<erosion_V2>, untiled<dilation_V2>, untiled<opening_V2>, untiled<closing_V2>},
+            {untiledBatch<erosion_V2_imgvec>, untiledBatch<dilation_V2_imgvec>, untiledBatch<opening_V2_imgvec>, untiledBatch<closing_V2_imgvec>}, {}},
+        {"V3", {false, true, false, 0, false},
+            {erosion_V3, dilation_V3, opening_V3, closing_V3},
+            {erosion_V3_imgvec, dilation_V3_imgvec, opening_V3_imgvec, closing_V3_imgvec}, {}},
+        {"V1_parallel", {true, false, true, 0, false},
+            {untiled<erosion_V1_parallel>, untiled<dilation_V1_parallel>, untiled<opening_V1_parallel>, untiled<closing_V1_parallel>},
+            {untiledBatch<erosion_V1_imgvec_parallel>, untiledBatch<dilation_V1_imgvec_parallel>, untiledBatch<opening_V1_imgvec_parallel>, untiledBatch<closing_V1_imgvec_parallel>}, {}},
+        {"V2_parallel", {true, false, false, 0, false},
+            {untiled<erosion_V2_parallel>, untiled<dilation_V2_parallel>, untiled<opening_V2_parallel>, untiled<closing_V2_parallel>},
+            {untiledBatch<erosion_V2_imgvec_parallel>, untiledBatch<dilation_V2_imgvec_parallel>, untiledBatch<opening_V2_imgvec_parallel>, untiledBatch<closing_V2_imgvec_parallel>}, {}},
+        {"V3_parallel", {true, true, false, 0, false},
+            {erosion_V3_parallel, dilation_V3_parallel, opening_V3_parallel, closing_V3_parallel},
+            {erosion_V3_imgvec_parallel, dilation_V3_imgvec_parallel, opening_V3_imgvec_parallel, closing_V3_imgvec_parallel}, {}},
+        {"V4", {false, false, false, 0, true},
+            {untiled<erosion_V4>, untiled<dilation_V4>, untiled<opening_V4>, untiled<closing_V4>},
+            {untiledBatch<erosion_V4_imgvec>, untiledBatch<dilation_V4_imgvec>, untiledBatch<opening_V4_imgvec>, untiledBatch<closing_V4_imgvec>}, {}},
+        {"V4_parallel", {true, false, false, 0, true},
+            {untiled<erosion_V4_parallel>, untiled<dilation_V4_parallel>, untiled<opening_V4_parallel>, untiled<closing_V4_parallel>},
+            {untiledBatch<erosion_V4_imgvec_parallel>, untiledBatch<dilation_V4_imgvec_parallel>, untiledBatch<opening_V4_imgvec_parallel>, untiledBatch<closing_V4_imgvec_parallel>}, {}},
+    };
+    return registry;
+}
+
+const std::vector<KernelEntry>& kernelRegistry() {
+    return registryStorage();
+}
+
+const std::vector<std::string>& availableOperations() {
+    static const std::vector<std::string> operations{"erosion", "dilation", "opening", "closing"};
+    return operations;
+}
+
+const std::vector<std::string>& availableModes() {
+    static const std::vector<std::string> modes = [] {
+        std::vector<std::string> names;
+        for (const auto& entry : kernelRegistry()) names.push_back(entry.mode);
+        return names;
+    }();
+    return modes;
+}
+
+const KernelEntry* findKernel(const std::string& mode) {
+    for (const auto& entry : kernelRegistry()) {
+        if (entry.mode == mode) return &entry;
+    }
+    return nullptr;
+}
+
+int operationIndex(const std::string& operation) {
+    const auto& operations = availableOperations();
+    for (size_t i = 0; i < operations.size(); i++) {
+        if (operations[i] == operation) return (int)i;
+    }
+    return -1;
+}
+
+bool isParallelMode(const std::string& mode) {
+    if (mode == "auto") return true;
+    const KernelEntry* entry = findKernel(mode);
+    return entry && entry->caps.parallel;
+}
+
+bool kernelSupports(const KernelEntry& entry, const KernelFeatures& features) {
+    if (features.se_width > features.width || features.se_height > features.height) return false;
+    if (entry.caps.max_se_size > 0 && std::max(features.se_width, features.se_height) > entry.caps.max_se_size) return false;
+    if (entry.caps.tiled && features.tile_size <= 0) return false;
+    return true;
+}
+
+// Frazione di pixel a 255 su un campione di circa 4096 pixel distribuiti su tutta l'immagine
+static double sampleDensity(const STBImage& img) {
+    size_t n = (size_t)img.width * img.height, step = std::max<size_t>(1, n / 4096), sampled = 0, foreground = 0;
+    for (size_t i = 0; i < n; i += step, sampled++) foreground += img.image_data[i] == 255;
+    return sampled > 0 ? (double)foreground / sampled : 0.0;
+}
+
+KernelFeatures measureFeatures(const STBImage& img, const StructuringElement& se, int tile_size) {
+    KernelFeatures features;
+    features.width = img.width;
+    features.height = img.height;
+    features.se_width = se.width;
+    features.se_height = se.height;
+    for (const auto& row : se.kernel) {
+        for (int value : row) features.se_active += value == 1;
+    }
+    features.se_plan_checks = structuringElementPlanChecks(planStructuringElement(se));
+    features.threads = omp_get_max_threads();
+    features.tile_size = tile_size;
+    features.density = sampleDensity(img);
+    return features;
+}
+
+// Confronti per pixel di una passata: q è la probabilità che un vicino attivo decida il risultato
+// (un pixel a 0 per l'erosione, a 255 per la dilatazione)
+static double checksPerPixel(const KernelEntry& entry, const KernelFeatures& f, bool erode) {
+    if (entry.caps.decomposed) return f.se_plan_checks;
+    double active = std::max(f.se_active, 1);
+    if (!entry.caps.early_exit) return active;
+    double q = erode ? 1.0 - f.density : f.density;
+    double visited = q <= 1e-9 ? active : (1.0 - std::pow(1.0 - q, active)) / q;
+    // V1 scorre anche le posizioni inattive del kernel
+    return visited * (double)f.se_width * f.se_height / active;
+}
+
+static double amdahlSpeedup(double fraction, int threads) {
+    if (threads <= 1) return 1.0;
+    return 1.0 / ((1.0 - fraction) + fraction / threads);
+}
+
+double predictKernelTime(const KernelEntry& entry, const std::string& operation, const KernelFeatures& f) {
+    double interior = (double)std::max(f.width - f.se_width + 1, 0) * std::max(f.height - f.se_height + 1, 0);
+    double per_image = 0;
+    auto pass = [&](bool erode) { per_image += interior * (entry.cost.pixel_ns + entry.cost.check_ns * checksPerPixel(entry, f, erode)); };
+    if (operation == "erosion") pass(true);
+    else if (operation == "dilation") pass(false);
+    else { pass(true); pass(false); }
+
+    double speedup = 1.0;
+    if (entry.caps.parallel) {
+        // Sul vettore di immagini le versioni parallele distribuiscono le immagini: non più thread che immagini
+        int threads = f.images > 1 ? std::min(f.threads, f.images) : f.threads;
+        speedup = amdahlSpeedup(entry.cost.parallel_fraction, threads);
+    }
+    return per_image * f.images * 1e-9 / speedup;
+}
+
+// Tempo minimo di tre esecuzioni dell'erosione
+static double timeErosion(const KernelEntry& entry, const STBImage& img, const StructuringElement& se) {
+    double best = 1e30;
+    for (int rep = 0; rep < 3; rep++) {
+        double start = omp_get_wtime();
+        STBImage result = entry.single[0](img, se, 64, DEFAULT_BACKGROUND_COLOR);
+        best = std::min(best, omp_get_wtime() - start);
+    }
+    return best;
+}
+
+void calibrateKernels() {
+    static std::once_flag calibrated;
+    std::call_once(calibrated, [] {
+        TraceScope calibration_trace("calibrate_kernels", "stage");
+        // Immagine piena: l'erosione non esce mai in anticipo, quindi i confronti per pixel sono noti
+        const int size = 128;
+        STBImage full;
+        full.initializeBinary(size, size, 255);
+        StructuringElement small_se(makeStructuringElement({"disk", 1})), large_se(makeStructuringElement({"disk", 4}));
+        KernelFeatures small_f = measureFeatures(full, small_se, 64), large_f = measureFeatures(full, large_se, 64);
+
+        int max_threads = omp_get_max_threads();
+        for (auto& entry : registryStorage()) {
+            omp_set_num_threads(1);
+            double k_small = entry.caps.early_exit ? small_se.width * small_se.height : small_f.se_active;
+            double k_large = entry.caps.early_exit ? large_se.width * large_se.height : large_f.se_active;
+            if (entry.caps.decomposed) {
+                k_small = small_f.se_plan_checks;
+                k_large = large_f.se_plan_checks;
+            }
+            double n_small = (double)(size - small_se.width + 1) * (size - small_se.height + 1);
+            double n_large = (double)(size - large_se.width + 1) * (size - large_se.height + 1);
+            double u_small = timeErosion(entry, full, small_se) * 1e9 / n_small;
+            double t_large = timeErosion(entry, full, large_se);
+            double u_large = t_large * 1e9 / n_large;
+
+            entry.cost.check_ns = (u_large - u_small) / (k_large - k_small);
+            entry.cost.pixel_ns = u_small - entry.cost.check_ns * k_small;
+            if (entry.cost.check_ns <= 0 || entry.cost.pixel_ns < 0) {
+                entry.cost.pixel_ns = 0;
+                entry.cost.check_ns = u_large / k_large;
+            }
+            entry.cost.calibrated = true;
+
+            omp_set_num_threads(max_threads);
+            if (entry.caps.parallel) {
+                if (max_threads > 1) {
+                    double t_parallel = timeErosion(entry, full, large_se);
+                    double fraction = (1.0 - t_parallel / t_large) / (1.0 - 1.0 / max_threads);
+                    entry.cost.parallel_fraction = std::min(std::max(fraction, 0.0), 0.99);
+                    entry.cost.parallel_calibrated = true;
+                } else {
+                    // Un solo thread disponibile: frazione parallela stimata
+                    entry.cost.parallel_fraction = 0.9;
+                }
+            }
+        }
+        omp_set_num_threads(max_threads);
+    });
+}
+
+KernelDecision selectKernel(const std::string& operation, const KernelFeatures& features) {
+    KernelDecision decision;
+    decision.operation = operation;
+    decision.features = features;
+    double best = 1e30;
+    for (const auto& entry : kernelRegistry()) {
+        if (!kernelSupports(entry, features)) continue;
+        double predicted = predictKernelTime(entry, operation, features);
+        decision.candidates.emplace_back(entry.mode, predicted);
+        if (predicted < best) {
+            best = predicted;
+            decision.chosen = entry.mode;
+            decision.predicted_s = predicted;
+        }
+    }
+    // Elemento strutturante più grande dell'immagine: ogni versione restituisce solo il bordo
+    if (decision.chosen.empty()) decision.chosen = kernelRegistry().front().mode;
+    return decision;
+}
+
+static std::mutex decisions_mutex;
+static std::deque<KernelDecision> decisions;
+static size_t decisions_measured = 0;   // Scelte con un tempo misurato, su cui si media l'errore
+static double error_sum = 0, abs_error_sum = 0;
+static KernelDecisionStats decision_stats;
+
+static void recordDecision(KernelDecision decision) {
+    std::lock_guard<std::mutex> lock(decisions_mutex);
+    decision_stats.count++;
+    decision_stats.chosen[decision.chosen]++;
+    if (decision.actual_s > 0) {
+        double error = 100.0 * (decision.predicted_s - decision.actual_s) / decision.actual_s;
+        decisions_measured++;
+        error_sum += error;
+        abs_error_sum += std::fabs(error);
+        decision_stats.max_abs_error_percent = std::max(decision_stats.max_abs_error_percent, std::fabs(error));
+    }
+    if (decisions.size() == max_kernel_decisions) decisions.pop_front();
+    decisions.push_back(std::move(decision));
+}
+
+std::vector<KernelDecision> kernelDecisions() {
+    std::lock_guard<std::mutex> lock(decisions_mutex);
+    return std::vector<KernelDecision>(decisions.begin(), decisions.end());
+}
+
+KernelDecisionStats kernelDecisionStats() {
+    std::lock_guard<std::mutex> lock(decisions_mutex);
+    KernelDecisionStats stats = decision_stats;
+    stats.retained = decisions.size();
+    if (decisions_measured > 0) {
+        stats.mean_error_percent = error_sum / decisions_measured;
+        stats.mean_abs_error_percent = abs_error_sum / decisions_measured;
+    }
+    return stats;
+}
+
+void clearKernelDecisions() {
+    std::lock_guard<std::mutex> lock(decisions_mutex);
+    decisions.clear();
+    decisions_measured = 0;
+    error_sum = abs_error_sum = 0;
+    decision_stats = KernelDecisionStats();
+}
+
+bool writeKernelDecisions(const std::string& path) {
+    std::ofstream csv(path, std::ofstream::trunc);
+    if (!csv) return false;
+    csv << "Operation,Chosen,Width,Height,Images,Density,SE_Width,SE_Height,SE_Active,Threads,Tile_Size,Predicted_s,Actual_s,Error_Percent,Candidates\n";
+    csv << std::setprecision(6);
+    for (const auto& d : kernelDecisions()) {
+        const KernelFeatures& f = d.features;
+        csv << d.operation << "," << d.chosen << "," << f.width << "," << f.height << "," << f.images << ","
+            << f.density << "," << f.se_width << "," << f.se_height << "," << f.se_active << "," << f.threads << ","
+            << f.tile_size << "," << d.predicted_s << "," << d.actual_s << ","
+            << (d.actual_s > 0 ? 100.0 * (d.predicted_s - d.actual_s) / d.actual_s : 0.0) << ",";
+        for (size_t i = 0; i < d.candidates.size(); i++) {
+            csv << (i ? ";" : "") << d.candidates[i].first << "=" << d.candidates[i].second;
+        }
+        csv << "\n";
+    }
+    return true;
+}
+
+// Funzione per applicare un'operazione morfologica con la versione indicata a una singola immagine
+STBImage applyOperation(const STBImage& img, const StructuringElement& se, const std::string& operation, const std::string& mode, int tile_size, uint8_t background) {
+    int op = operationIndex(operation);
+    if (op < 0) throw std::invalid_argument("Invalid operation or mode");
+    if (mode == "auto") {
+        calibrateKernels();
+        KernelDecision decision = selectKernel(operation, measureFeatures(img, se, tile_size));
+        const KernelEntry* entry = findKernel(decision.chosen);
+        TraceScope kernel_trace(traceEnabled() ? traceIntern(operation + " auto " + entry->mode) : "", "kernel");
+        double start = omp_get_wtime();
+        STBImage result = entry->single[op](img, se, tile_size, background);
+        decision.actual_s = omp_get_wtime() - start;
+        recordDecision(std::move(decision));
+        return result;
+    }
+    const KernelEntry* entry = findKernel(mode);
+    if (!entry) throw std::invalid_argument("Invalid operation or mode");
+    TraceScope kernel_trace(traceEnabled() ? traceIntern(operation + " " + mode) : "", "kernel");
+    return entry->single[op](img, se, tile_size, background);
+}
+
+// Funzione per applicare un'operazione morfologica con la versione indicata a un vettore di immagini
+std::unordered_map<std::string, STBImage> applyOperationImgVec(const std::vector<STBImage>& imgs, const StructuringElement& se, const std::string& operation, const std::string& mode, int tile_size, uint8_t background) {
+    int op = operationIndex(operation);
+    if (op < 0) throw std::invalid_argument("Invalid operation or mode");
+    if (mode == "auto") {
+        if (imgs.empty()) return {};
+        calibrateKernels();
+        // Caratteristiche della prima immagine, con la densità media del vettore: l'elemento strutturante
+        // si misura (e si pianifica) una volta sola
+        KernelFeatures features = measureFeatures(imgs.front(), se, tile_size);
+        double density = 0;
+        for (const auto& img : imgs) density += sampleDensity(img);
+        features.density = density / imgs.size();
+        features.images = (int)imgs.size();
+        KernelDecision decision = selectKernel(operation, features);
+        const KernelEntry* entry = findKernel(decision.chosen);
+        TraceScope kernel_trace(traceEnabled() ? traceIntern(operation + " auto " + entry->mode) : "", "kernel");
+        double start = omp_get_wtime();
+        auto results = entry->batch[op](imgs, se, tile_size, background);
+        decision.actual_s = omp_get_wtime() - start;
+        recordDecision(std::move(decision));
+        return results;
+    }
+    const KernelEntry* entry = findKernel(mode);
+    if (!entry) throw std::invalid_argument("Invalid operation or mode");
+    TraceScope kernel_trace(traceEnabled() ? traceIntern(operation + " " + mode) : "", "kernel");
+    return entry->batch[op](imgs, se, tile_size, background);
+}
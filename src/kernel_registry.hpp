@@ -0,0 +1,119 @@
+#ifndef MORPHOLOGY_KERNEL_REGISTRY_HPP
+#define MORPHOLOGY_KERNEL_REGISTRY_HPP
+
+#include "morphology.hpp"
+
+#include <map>
+
+// REGISTRO DELLE VERSIONI E SCELTA AUTOMATICA
+//
+// Ogni versione (V1, V2, V3, V4, sequenziali e _parallel) è una voce del registro con le funzioni delle
+// quattro operazioni, le capacità dichiarate (dimensione dell'elemento strutturante, tiling, uscita
+// anticipata, parallelismo) e un modello di costo. Tutte le versioni accettano qualsiasi maschera e
+// riempiono il bordo con il colore di sfondo, quindi forma e bordo non distinguono le voci. applyOperation e applyOperationImgVec cercano la voce invece di
+// confrontare stringhe una per una.
+//
+// La versione "auto" stima il tempo di ogni versione applicabile per (dimensione dell'immagine, densità
+// di primo piano, elemento strutturante, thread) e usa la più veloce. Il modello conta i confronti per
+// pixel: V1 scorre tutto il kernel fermandosi al primo pixel che decide il risultato, V2 e V3 scorrono
+// la lista dei pixel attivi, V4 esegue le passate del piano di scomposizione. Il tempo è t = pixel * (c0 + c1 * confronti) / S(thread), con S dato dalla
+// legge di Amdahl. c0 e c1 si calibrano per ogni versione su due immagini piene (raggio 1 e 4, nessuna
+// uscita anticipata), la frazione parallela confrontando un thread con tutti quelli disponibili.
+// Ogni scelta è registrata con il tempo previsto e quello misurato, per verificare il modello: il
+// registro tiene solo le ultime scelte (un processo di lunga durata come il server non cresce senza
+// limite), mentre errore di previsione e conteggio per versione si accumulano su tutte.
+
+using KernelFunc = STBImage (*)(const STBImage&, const StructuringElement&, int tile_size, uint8_t background);
+using BatchKernelFunc = std::unordered_map<std::string, STBImage> (*)(const std::vector<STBImage>&, const StructuringElement&, int tile_size, uint8_t background);
+
+// Capacità dichiarate da una versione
+struct KernelCapabilities {
+    bool parallel{false};
+    bool tiled{false};                  // Usa tile_size
+    bool early_exit{false};             // Interrompe la scansione del kernel al primo pixel decisivo
+    int max_se_size{0};                 // Lato massimo dell'elemento strutturante (0 = nessun limite)
+    bool decomposed{false};             // Calcola la scomposizione dell'elemento strutturante (V4)
+};
+
+// Modello di costo calibrato
+struct KernelCost {
+    double pixel_ns{0};                 // c0: costo fisso per pixel di uscita
+    double check_ns{0};                 // c1: costo per confronto con un vicino
+    double parallel_fraction{0};        // Frazione di Amdahl (solo versioni parallele)
+    bool calibrated{false};
+    bool parallel_calibrated{false};    // false se la calibrazione aveva un solo thread (frazione stimata)
+};
+
+struct KernelEntry {
+    std::string mode;
+    KernelCapabilities caps;
+    KernelFunc single[4];               // Nell'ordine di availableOperations()
+    BatchKernelFunc batch[4];
+    KernelCost cost;
+};
+
+// Caratteristiche del problema usate dal modello di costo
+struct KernelFeatures {
+    int width{0}, height{0}, images{1};
+    double density{0};                  // Frazione di pixel a 255
+    int se_width{0}, se_height{0}, se_active{0};
+    double se_plan_checks{0};           // Confronti per pixel del piano di V4 (planStructuringElement)
+    int threads{1};
+    int tile_size{0};
+};
+
+// Scelta della versione "auto", con il tempo previsto e (dopo l'esecuzione) quello misurato
+struct KernelDecision {
+    std::string operation, chosen;
+    KernelFeatures features;
+    double predicted_s{0}, actual_s{0};
+    std::vector<std::pair<std::string, double>> candidates;    // Tempo previsto di ogni versione applicabile
+};
+
+// Riepilogo di tutte le scelte di "auto" dall'ultimo clearKernelDecisions (anche quelle uscite dal registro)
+struct KernelDecisionStats {
+    size_t count{0};
+    size_t retained{0};                 // Scelte ancora nel registro
+    double mean_abs_error_percent{0};   // Errore relativo medio |previsto - misurato| / misurato
+    double max_abs_error_percent{0};
+    double mean_error_percent{0};       // Con segno: positivo se il modello sovrastima
+    std::map<std::string, size_t> chosen;
+};
+
+const std::vector<KernelEntry>& kernelRegistry();
+
+// Funzione per trovare una versione per nome (nullptr se non esiste)
+const KernelEntry* findKernel(const std::string& mode);
+
+// Indice dell'operazione in availableOperations() (-1 se non esiste)
+int operationIndex(const std::string& operation);
+
+// Versioni che usano più thread: le _parallel e "auto", che può sceglierne una
+bool isParallelMode(const std::string& mode);
+
+// Funzione per verificare se una versione supporta il problema
+bool kernelSupports(const KernelEntry& entry, const KernelFeatures& features);
+
+// Funzione per misurare le caratteristiche di un'immagine (densità stimata su un campione di pixel)
+KernelFeatures measureFeatures(const STBImage& img, const StructuringElement& se, int tile_size);
+
+// Funzione per stimare il tempo in secondi di un'operazione con una versione
+double predictKernelTime(const KernelEntry& entry, const std::string& operation, const KernelFeatures& features);
+
+// Funzione per calibrare i modelli di costo (una volta per processo; chiamarla prima delle misure
+// evita che la calibrazione cada dentro la prima chiamata "auto")
+void calibrateKernels();
+
+// Funzione per scegliere la versione più veloce prevista fra quelle applicabili
+KernelDecision selectKernel(const std::string& operation, const KernelFeatures& features);
+
+// Registro delle scelte di "auto" (le ultime max_kernel_decisions) e riepilogo di tutte
+constexpr size_t max_kernel_decisions = 4096;
+std::vector<KernelDecision> kernelDecisions();
+KernelDecisionStats kernelDecisionStats();
+void clearKernelDecisions();
+
+// Funzione per scrivere le scelte in CSV (versione, tempi previsto e misurato, candidati)
+bool writeKernelDecisions(const std::string& path);
+
+#endif // MORPHOLOGY_KERNEL_REGISTRY_HPP
@@ -0,0 +1,477 @@
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iomanip>
+#include <functional>
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <map>
+#include <unordered_map>
+#include <omp.h>
+
+#include "image.hpp"
+#include "morphology.hpp"
+#include "cli.hpp"
+#include "generator.hpp"
+
+// MICROBENCHMARK DELLE PRIMITIVE
+//
+// Misura le singole primitive isolate dal resto della pipeline: erosione e dilatazione di ogni
+// versione, compilazione dell'elemento strutturante, initializeBinary, binarizzazione, copia di
+// un'immagine e inserimento nella mappa dei risultati come nelle funzioni _imgvec.
+// Ogni primitiva è misurata a cache calda (stessi buffer, iterazioni ripetute fino a un tempo minimo
+// per campione) e a cache fredda (prima di ogni iterazione si scrive un buffer più grande della LLC,
+// fuori dall'intervallo cronometrato). Il risultato è in ns/pixel, confrontato con un file di
+// riferimento salvato in precedenza sulla stessa macchina.
+
+const int MICROBENCH_SCHEMA_VERSION = 1;
+
+struct MicroOptions {
+    std::vector<std::pair<int, int>> sizes{{64, 64}, {256, 256}, {1024, 1024}, {4096, 4096}, {8192, 8192}};
+    std::vector<std::string> variants{"hot", "cold"};
+    std::vector<std::string> filters{};     // Sottostringhe del nome delle primitive da eseguire (vuoto = tutte)
+    std::string shape{"disk"};
+    int radius{5};
+    int tile_size{64};
+    int threads{0};             // 0 = numero di thread predefinito di OpenMP
+    int samples{5};
+    double min_sample_ms{20};   // Durata minima di un campione a cache calda
+    double max_case_s{3};       // Tempo massimo per una combinazione (almeno un campione viene sempre misurato)
+    int flush_mb{64};           // Buffer scritto prima di ogni iterazione a cache fredda
+    int map_images{16};         // Immagini inserite nella mappa per iterazione (meno se superano map_mb)
+    int map_mb{256};            // Memoria massima delle immagini del pool di map_insert
+    unsigned seed{42};
+    double threshold{0.10};     // Variazione relativa oltre la quale si segnala una differenza dal riferimento
+    std::string json_path{"results/microbench.json"};
+    std::string baseline_path{"results/microbench_baseline.json"};
+    bool save_baseline{false};
+};
+
+// Dati di una dimensione condivisi dalle primitive
+struct MicroFixture {
+    int width{0}, height{0}, tile_size{64};
+    STBImage input;             // Immagine binaria generata
+    std::vector<uint8_t> gray;  // Livelli di grigio da binarizzare
+    StructuringElement se;
+    STBImage scratch;           // Destinazione di initializeBinary
+    std::vector<STBImage> pool; // Immagini spostate nella mappa dei risultati
+    std::vector<std::string> names;
+    std::unordered_map<std::string, STBImage> results;
+};
+
+// Una primitiva: setup (non cronometrato, prima di ogni iterazione) e corpo misurato
+struct MicroCase {
+    std::string name;
+    std::function<double(const MicroFixture&)> pixels; // Pixel elaborati per iterazione
+    std::function<void(MicroFixture&)> run;
+    std::function<void(MicroFixture&)> setup{};
+    bool once{false};           // Non dipende dalla dimensione dell'immagine: misurata una volta sola
+};
+
+struct MicroResult {
+    std::string name, variant;
+    int width{0}, height{0};
+    double pixels{0};
+    int samples{0};
+    long long iterations{0};    // Iterazioni totali misurate
+    double median_ns{0}, min_ns{0}; // Per iterazione
+    double ns_per_pixel{0};     // Dalla mediana
+    double baseline_ns_per_pixel{NAN};
+    double ratio{NAN};          // Corrente / riferimento
+};
+
+void printUsage(const char* program) {
+    std::cout << "Uso: " << program << " [opzioni]\n"
+              << "  --sizes LISTA        dimensioni delle immagini, LxA o N (64,256,1024,4096,8192)\n"
+              << "  --variants LISTA     hot e/o cold (hot,cold)\n"
+              << "  --filter LISTA       esegue solo le primitive il cui nome contiene una delle parole\n"
+              << "  --list               elenca le primitive ed esce\n"
+              << "  --shape NOME         forma dell'elemento strutturante, disk o square (disk)\n"
+              << "  --radius N           raggio dell'elemento strutturante (5)\n"
+              << "  --tile-size N        lato dei tile per V3 (64)\n"
+              << "  --threads N          thread delle versioni parallele (predefinito di OpenMP)\n"
+              << "  --samples N          campioni per combinazione (5)\n"
+              << "  --min-sample-ms N    durata minima di un campione a cache calda (20)\n"
+              << "  --max-case-s N       tempo massimo per combinazione in secondi (3)\n"
+              << "  --flush-mb N         MB scritti per svuotare la cache prima delle iterazioni fredde (64)\n"
+              << "  --map-images N       immagini inserite nella mappa per iterazione (16)\n"
+              << "  --map-mb N           memoria massima delle immagini inserite nella mappa (256)\n"
+              << "  --seed N             seme del generatore (42)\n"
+              << "  --threshold N        variazione relativa segnalata rispetto al riferimento (0.10)\n"
+              << "  --json PERCORSO      file JSON dei risultati (results/microbench.json)\n"
+              << "  --baseline PERCORSO  file di riferimento (results/microbench_baseline.json)\n"
+              << "  --save-baseline      salva i risultati come nuovo riferimento\n";
+}
+
+std::vector<MicroCase> buildCases() {
+    std::vector<MicroCase> cases;
+    auto imagePixels = [](const MicroFixture& f) { return (double)f.width * f.height; };
+
+    for (const std::string op : {"erosion", "dilation"}) {
+        for (const auto& mode : availableModes()) {
+            cases.push_back({op + "/" + mode, imagePixels, [op, mode](MicroFixture& f) {
+                STBImage result = applyOperation(f.input, f.se, op, mode, f.tile_size, DEFAULT_BACKGROUND_COLOR);
+                (void)result;
+            }});
+        }
+    }
+    cases.push_back({"se_compile", [](const MicroFixture& f) { return (double)f.se.width * f.se.height; },
+        [](MicroFixture& f) {
+            auto active_pixels = compileStructuringElement(f.se);
+            if (active_pixels.empty()) std::abort();
+        }, {}, true});
+    cases.push_back({"initialize_binary", imagePixels, [](MicroFixture& f) {
+        f.scratch.initializeBinary(f.width, f.height, 0);
+    }});
+    cases.push_back({"binarize", imagePixels, [](MicroFixture& f) {
+        // Il ciclo è senza salti: il costo non cambia quando il buffer è già binario
+        binarizePixels(f.gray.data(), f.gray.size());
+    }});
+    cases.push_back({"image_copy", imagePixels, [](MicroFixture& f) {
+        STBImage copy(f.input);
+        (void)copy;
+    }});
+    cases.push_back({"map_insert", [](const MicroFixture& f) { return (double)f.width * f.height * f.pool.size(); },
+        [](MicroFixture& f) {
+            for (size_t i = 0; i < f.pool.size(); i++) {
+                f.results[f.names[i]] = std::move(f.pool[i]);
+            }
+        }, [](MicroFixture& f) {
+            // Riporta le immagini nel pool e svuota la mappa, come all'inizio di una chiamata _imgvec
+            for (size_t i = 0; i < f.pool.size(); i++) {
+                auto it = f.results.find(f.names[i]);
+                if (it != f.results.end()) f.pool[i] = std::move(it->second);
+            }
+            f.results = std::unordered_map<std::string, STBImage>();
+        }});
+    return cases;
+}
+
+// Funzione per svuotare le cache: ogni thread scrive una parte di un buffer più grande della LLC,
+// così anche le cache private dei core usati dalle versioni parallele vengono sostituite
+void flushCaches(std::vector<uint8_t>& buffer) {
+    uint8_t* data = buffer.data();
+    size_t n = buffer.size();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i += 64) {
+        data[i]++;
+    }
+}
+
+double median(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+// Funzione per misurare una primitiva in una variante (hot o cold)
+MicroResult measureCase(const MicroCase& c, MicroFixture& fixture, const std::string& variant,
+    const MicroOptions& options, std::vector<uint8_t>& flush_buffer) {
+    MicroResult result;
+    result.name = c.name;
+    result.variant = variant;
+    result.width = fixture.width;
+    result.height = fixture.height;
+    result.pixels = c.pixels(fixture);
+
+    bool cold = variant == "cold";
+    // Con setup o svuotamento della cache ogni iterazione è cronometrata da sola
+    bool per_iteration = cold || c.setup;
+    auto timedIteration = [&]() {
+        if (c.setup) c.setup(fixture);
+        if (cold) flushCaches(flush_buffer);
+        double start = omp_get_wtime();
+        c.run(fixture);
+        return omp_get_wtime() - start;
+    };
+
+    double case_start = omp_get_wtime();
+    // Iterazione di warm-up (prima allocazione, page fault), usata anche per calibrare le iterazioni
+    double first = timedIteration();
+    long long k = 1;
+    if (!cold) {
+        k = (long long)std::ceil(options.min_sample_ms * 1e-3 / std::max(first, 1e-9));
+        k = std::min<long long>(std::max<long long>(k, 1), 10000000);
+    }
+
+    std::vector<double> per_iteration_times;
+    for (int s = 0; s < options.samples; s++) {
+        double total = 0.0;
+        if (per_iteration) {
+            for (long long i = 0; i < k; i++) total += timedIteration();
+        } else {
+            double start = omp_get_wtime();
+            for (long long i = 0; i < k; i++) c.run(fixture);
+            total = omp_get_wtime() - start;
+        }
+        per_iteration_times.push_back(total / k);
+        result.iterations += k;
+        if (omp_get_wtime() - case_start > options.max_case_s) break;
+    }
+
+    result.samples = per_iteration_times.size();
+    result.median_ns = median(per_iteration_times) * 1e9;
+    result.min_ns = *std::min_element(per_iteration_times.begin(), per_iteration_times.end()) * 1e9;
+    result.ns_per_pixel = result.pixels > 0 ? result.median_ns / result.pixels : 0.0;
+    return result;
+}
+
+std::string resultKey(const std::string& name, int width, int height, const std::string& variant) {
+    return name + "|" + std::to_string(width) + "x" + std::to_string(height) + "|" + variant;
+}
+
+// Funzione per leggere il file di riferimento: ns/pixel per (primitiva, dimensione, variante)
+bool loadBaseline(const std::string& path, std::map<std::string, double>& baseline, json& baseline_options) {
+    std::ifstream in(path);
+    if (!in) return false;
+    json doc;
+    try {
+        in >> doc;
+        if (doc.value("schema", "") != "morphology-microbench") return false;
+        baseline_options = doc.value("options", json::object());
+        for (const auto& r : doc["results"]) {
+            baseline[resultKey(r["name"], r["width"], r["height"], r["variant"])] = r["ns_per_pixel"];
+        }
+    } catch (const json::exception& e) {
+        std::cerr << "File di riferimento non valido (" << path << "): " << e.what() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+json optionsJson(const MicroOptions& options) {
+    return {
+        {"shape", options.shape}, {"radius", options.radius}, {"tile_size", options.tile_size},
+        {"threads", omp_get_max_threads()}, {"samples", options.samples}, {"min_sample_ms", options.min_sample_ms},
+        {"flush_mb", options.flush_mb}, {"seed", options.seed}
+    };
+}
+
+void writeJson(const std::string& path, const MicroOptions& options, const std::vector<MicroResult>& results) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+
+    auto numberOrNull = [](double value) { return std::isnan(value) ? json(nullptr) : json(value); };
+    json doc;
+    doc["schema"] = "morphology-microbench";
+    doc["schema_version"] = MICROBENCH_SCHEMA_VERSION;
+    doc["timestamp"] = (long long)std::time(nullptr);
+    doc["options"] = optionsJson(options);
+    doc["results"] = json::array();
+    for (const auto& r : results) {
+        doc["results"].push_back({
+            {"name", r.name}, {"variant", r.variant}, {"width", r.width}, {"height", r.height},
+            {"pixels", r.pixels}, {"samples", r.samples}, {"iterations", r.iterations},
+            {"median_ns", r.median_ns}, {"min_ns", r.min_ns}, {"ns_per_pixel", r.ns_per_pixel},
+            {"baseline_ns_per_pixel", numberOrNull(r.baseline_ns_per_pixel)}, {"ratio", numberOrNull(r.ratio)}
+        });
+    }
+    std::ofstream out(path, std::ofstream::trunc);
+    out << doc.dump(2) << std::endl;
+}
+
+bool parseOptions(int argc, char* argv[], MicroOptions& options, bool& list_only) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return false;
+        }
+        if (arg == "--list") {
+            list_only = true;
+            continue;
+        }
+        if (arg == "--save-baseline") {
+            options.save_baseline = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") options.sizes = parseSizeList(value);
+        else if (arg == "--variants") options.variants = splitList(value);
+        else if (arg == "--filter") options.filters = splitList(value);
+        else if (arg == "--shape") options.shape = value;
+        else if (arg == "--radius") options.radius = std::stoi(value);
+        else if (arg == "--tile-size") options.tile_size = std::stoi(value);
+        else if (arg == "--threads") options.threads = std::stoi(value);
+        else if (arg == "--samples") options.samples = std::stoi(value);
+        else if (arg == "--min-sample-ms") options.min_sample_ms = std::stod(value);
+        else if (arg == "--max-case-s") options.max_case_s = std::stod(value);
+        else if (arg == "--flush-mb") options.flush_mb = std::stoi(value);
+        else if (arg == "--map-images") options.map_images = std::stoi(value);
+        else if (arg == "--map-mb") options.map_mb = std::stoi(value);
+        else if (arg == "--seed") options.seed = std::stoul(value);
+        else if (arg == "--threshold") options.threshold = std::stod(value);
+        else if (arg == "--json") options.json_path = value;
+        else if (arg == "--baseline") options.baseline_path = value;
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+    if (options.shape != "disk" && options.shape != "square") {
+        std::cerr << "Forma dell'elemento strutturante non valida: " << options.shape << std::endl;
+        return false;
+    }
+    for (const auto& variant : options.variants) {
+        if (variant != "hot" && variant != "cold") {
+            std::cerr << "Variante non valida: " << variant << std::endl;
+            return false;
+        }
+    }
+    options.samples = std::max(options.samples, 1);
+    options.map_images = std::max(options.map_images, 1);
+    return true;
+}
+
+bool selected(const MicroCase& c, const MicroOptions& options) {
+    if (options.filters.empty()) return true;
+    for (const auto& filter : options.filters) {
+        if (c.name.find(filter) != std::string::npos) return true;
+    }
+    return false;
+}
+
+// Funzione per preparare i dati di una dimensione
+void prepareFixture(MicroFixture& fixture, int width, int height, const MicroOptions& options) {
+    fixture.width = width;
+    fixture.height = height;
+    fixture.tile_size = options.tile_size;
+    fixture.input = generateWorkloadImage(width, height, workloadProfile("default"), options.seed, 0);
+    fixture.gray.resize((size_t)width * height);
+    for (size_t i = 0; i < fixture.gray.size(); i++) fixture.gray[i] = (uint8_t)(i * 37);
+    fixture.scratch.initializeBinary(width, height, 0);
+
+    size_t image_bytes = std::max<size_t>((size_t)width * height, 1);
+    size_t count = std::min<size_t>(options.map_images, std::max<size_t>((size_t)options.map_mb * (1 << 20) / image_bytes, 1));
+    fixture.pool.clear();
+    fixture.names.clear();
+    fixture.results.clear();
+    for (size_t i = 0; i < count; i++) {
+        fixture.pool.push_back(fixture.input);
+        fixture.names.push_back("image_" + std::to_string(i + 1) + ".pgm");
+    }
+}
+
+void printRow(const MicroResult& r, double threshold) {
+    std::string size = std::to_string(r.width) + "x" + std::to_string(r.height);
+    std::string status = "-";
+    if (!std::isnan(r.ratio)) {
+        status = r.ratio > 1.0 + threshold ? "PIÙ LENTO" : (r.ratio < 1.0 - threshold ? "più veloce" : "ok");
+    }
+    std::cout << std::left << std::setw(22) << r.name << std::setw(12) << size << std::setw(6) << r.variant
+              << std::right << std::setw(12) << std::setprecision(4) << r.ns_per_pixel
+              << std::setw(14) << std::setprecision(6) << r.median_ns
+              << std::setw(10) << (std::to_string(r.samples) + "x" + std::to_string(r.iterations / std::max(r.samples, 1)));
+    if (std::isnan(r.ratio)) {
+        std::cout << std::setw(12) << "-" << std::setw(9) << "-";
+    } else {
+        std::cout << std::setw(12) << std::setprecision(4) << r.baseline_ns_per_pixel << std::setw(9) << std::setprecision(3) << r.ratio;
+    }
+    std::cout << "  " << status << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    MicroOptions options;
+    bool list_only = false;
+    if (!parseOptions(argc, argv, options, list_only)) {
+        return 1;
+    }
+
+    std::vector<MicroCase> cases = buildCases();
+    if (list_only) {
+        for (const auto& c : cases) std::cout << c.name << std::endl;
+        return 0;
+    }
+    if (options.threads > 0) {
+        omp_set_num_threads(options.threads);
+    }
+
+    std::map<std::string, double> baseline;
+    json baseline_options;
+    bool has_baseline = !options.save_baseline && loadBaseline(options.baseline_path, baseline, baseline_options);
+    if (has_baseline) {
+        std::cout << "Riferimento: " << options.baseline_path << std::endl;
+        json current = optionsJson(options);
+        for (const char* key : {"shape", "radius", "tile_size", "threads"}) {
+            if (baseline_options.contains(key) && baseline_options[key] != current[key]) {
+                std::cout << "Attenzione: " << key << " diverso dal riferimento (" << baseline_options[key]
+                          << " invece di " << current[key] << ")" << std::endl;
+            }
+        }
+    }
+
+    std::vector<uint8_t> flush_buffer;
+    if (std::find(options.variants.begin(), options.variants.end(), "cold") != options.variants.end()) {
+        flush_buffer.assign((size_t)std::max(options.flush_mb, 1) << 20, 0);
+    }
+
+    std::cout << std::left << std::setw(22) << "primitiva" << std::setw(12) << "dimensione" << std::setw(6) << "cache"
+              << std::right << std::setw(12) << "ns/pixel" << std::setw(14) << "ns/iter" << std::setw(10) << "campioni"
+              << std::setw(12) << "riferimento" << std::setw(9) << "rapporto" << std::endl;
+
+    std::vector<MicroResult> results;
+    auto record = [&](MicroResult r) {
+        auto it = baseline.find(resultKey(r.name, r.width, r.height, r.variant));
+        if (it != baseline.end() && it->second > 0) {
+            r.baseline_ns_per_pixel = it->second;
+            r.ratio = r.ns_per_pixel / it->second;
+        }
+        printRow(r, options.threshold);
+        results.push_back(r);
+    };
+
+    MicroFixture fixture;
+    fixture.se = makeStructuringElement({options.shape, options.radius});
+
+    // Primitive indipendenti dall'immagine: la dimensione riportata è quella dell'elemento strutturante
+    for (const auto& c : cases) {
+        if (!c.once || !selected(c, options)) continue;
+        fixture.width = fixture.se.width;
+        fixture.height = fixture.se.height;
+        for (const auto& variant : options.variants) {
+            record(measureCase(c, fixture, variant, options, flush_buffer));
+        }
+    }
+
+    for (const auto& [width, height] : options.sizes) {
+        bool any = false;
+        for (const auto& c : cases) any = any || (!c.once && selected(c, options));
+        if (!any) break;
+        prepareFixture(fixture, width, height, options);
+        for (const auto& c : cases) {
+            if (c.once || !selected(c, options)) continue;
+            for (const auto& variant : options.variants) {
+                record(measureCase(c, fixture, variant, options, flush_buffer));
+            }
+        }
+    }
+
+    writeJson(options.json_path, options, results);
+    std::cout << "Risultati scritti in " << options.json_path << std::endl;
+    if (options.save_baseline) {
+        writeJson(options.baseline_path, options, results);
+        std::cout << "Riferimento salvato in " << options.baseline_path << std::endl;
+        return 0;
+    }
+
+    int slower = 0, faster = 0;
+    for (const auto& r : results) {
+        if (std::isnan(r.ratio)) continue;
+        slower += r.ratio > 1.0 + options.threshold;
+        faster += r.ratio < 1.0 - options.threshold;
+    }
+    if (has_baseline) {
+        std::cout << "Rispetto al riferimento: " << slower << " più lente, " << faster << " più veloci (soglia "
+                  << options.threshold * 100 << "%)" << std::endl;
+    }
+    // Codice di uscita 2 se qualche primitiva è più lenta del riferimento oltre la soglia
+    return slower > 0 ? 2 : 0;
+}
@@ -0,0 +1,213 @@
+#include "morpho_c.h"
+
+#include "image.hpp"
+#include "morphology.hpp"
+
+#include <omp.h>
+#include <new>
+
+// Handle dell'elemento strutturante: spostamenti dei pixel attivi ed estensione attorno all'ancora
+struct morpho_se {
+    std::vector<std::pair<int, int>> offsets;   // (dy, dx)
+    int left{0}, right{0}, top{0}, bottom{0};   // Pixel di bordo per lato
+};
+
+// Funzione per verificare una singola immagine del chiamante
+static int checkImage(const morpho_image* image) {
+    if (!image || !image->src || !image->dst || image->width <= 0 || image->height <= 0) return MORPHO_ERROR_INVALID_ARGUMENT;
+    if (image->src_stride < image->width || image->dst_stride < image->width) return MORPHO_ERROR_INVALID_ARGUMENT;
+    const uint8_t* src_end = image->src + (image->height - 1) * image->src_stride + image->width;
+    const uint8_t* dst_end = image->dst + (image->height - 1) * image->dst_stride + image->width;
+    if (image->src < dst_end && image->dst < src_end) return MORPHO_ERROR_OVERLAP;
+    return MORPHO_OK;
+}
+
+// Funzione per elaborare la riga y: minimo (erosione) o massimo (dilatazione) sui vicini, poi soglia come
+// nelle versioni C++ (erosione: 0 se un vicino vale 0; dilatazione: 255 se un vicino vale 255)
+static void processRow(const morpho_se& se, bool erode, const uint8_t* src, ptrdiff_t src_stride,
+    uint8_t* out, int width, int height, int y, uint8_t border) {
+    int x0 = se.left, x1 = width - se.right;
+    if (y < se.top || y >= height - se.bottom || x1 <= x0) {
+        for (int x = 0; x < width; x++) out[x] = border;
+        return;
+    }
+    for (int x = 0; x < x0; x++) out[x] = border;
+    for (int x = x1; x < width; x++) out[x] = border;
+
+    if (se.offsets.empty()) {
+        // Nessun vicino: nessun pixel si erode, nessuno si dilata
+        for (int x = x0; x < x1; x++) out[x] = erode ? 255 : 0;
+        return;
+    }
+    const uint8_t* first = src + (y + se.offsets[0].first) * src_stride + se.offsets[0].second;
+    for (int x = x0; x < x1; x++) out[x] = first[x];
+    for (size_t k = 1; k < se.offsets.size(); k++) {
+        const uint8_t* row = src + (y + se.offsets[k].first) * src_stride + se.offsets[k].second;
+        if (erode) {
+            #pragma omp simd
+            for (int x = x0; x < x1; x++) out[x] = std::min(out[x], row[x]);
+        } else {
+            #pragma omp simd
+            for (int x = x0; x < x1; x++) out[x] = std::max(out[x], row[x]);
+        }
+    }
+    if (erode) {
+        #pragma omp simd
+        for (int x = x0; x < x1; x++) out[x] = out[x] == 0 ? 0 : 255;
+    } else {
+        #pragma omp simd
+        for (int x = x0; x < x1; x++) out[x] = out[x] == 255 ? 255 : 0;
+    }
+}
+
+// Funzione per eseguire un passo (erosione o dilatazione) su tutte le righe, in parallelo se threads > 1
+static void processPass(const morpho_se& se, bool erode, const uint8_t* src, ptrdiff_t src_stride,
+    uint8_t* dst, ptrdiff_t dst_stride, int width, int height, uint8_t border, int threads) {
+    #pragma omp parallel for schedule(static) num_threads(threads) if(threads > 1)
+    for (int y = 0; y < height; y++) {
+        processRow(se, erode, src, src_stride, dst + y * dst_stride, width, height, y, border);
+    }
+}
+
+// Funzione per eseguire l'operazione su un'immagine già verificata; apertura e chiusura passano da un buffer intermedio
+static void processImage(const morpho_se& se, morpho_op op, const morpho_image& image, uint8_t border, int threads) {
+    switch (op) {
+        case MORPHO_EROSION:
+        case MORPHO_DILATION:
+            processPass(se, op == MORPHO_EROSION, image.src, image.src_stride, image.dst, image.dst_stride,
+                image.width, image.height, border, threads);
+            break;
+        case MORPHO_OPENING:
+        case MORPHO_CLOSING: {
+            bool erode_first = op == MORPHO_OPENING;
+            std::vector<uint8_t> half_result((size_t)image.width * image.height);
+            processPass(se, erode_first, image.src, image.src_stride, half_result.data(), image.width,
+                image.width, image.height, border, threads);
+            processPass(se, !erode_first, half_result.data(), image.width, image.dst, image.dst_stride,
+                image.width, image.height, border, threads);
+            break;
+        }
+    }
+}
+
+static bool validOperation(morpho_op op) {
+    return op == MORPHO_EROSION || op == MORPHO_DILATION || op == MORPHO_OPENING || op == MORPHO_CLOSING;
+}
+
+static int threadCount(int threads) {
+    return threads > 0 ? threads : omp_get_max_threads();
+}
+
+extern "C" {
+
+int morpho_abi_version(void) {
+    return MORPHO_ABI_VERSION;
+}
+
+const char* morpho_status_string(int status) {
+    switch (status) {
+        case MORPHO_OK: return "ok";
+        case MORPHO_ERROR_INVALID_ARGUMENT: return "invalid argument";
+        case MORPHO_ERROR_UNKNOWN_SHAPE: return "unknown structuring element shape";
+        case MORPHO_ERROR_OVERLAP: return "source and destination buffers overlap";
+        case MORPHO_ERROR_OUT_OF_MEMORY: return "out of memory";
+        default: return "unknown status";
+    }
+}
+
+int morpho_se_create(const uint8_t* mask, int32_t width, int32_t height, ptrdiff_t stride,
+                     int32_t anchor_x, int32_t anchor_y, morpho_se** out) {
+    if (!out) return MORPHO_ERROR_INVALID_ARGUMENT;
+    *out = nullptr;
+    if (!mask || width <= 0 || height <= 0 || stride < width) return MORPHO_ERROR_INVALID_ARGUMENT;
+    if (anchor_x >= width || anchor_y >= height) return MORPHO_ERROR_INVALID_ARGUMENT;
+    try {
+        StructuringElement se(std::vector<std::vector<int>>(height, std::vector<int>(width, 0)));
+        for (int i = 0; i < height; i++) {
+            for (int j = 0; j < width; j++) {
+                se.kernel[i][j] = mask[i * stride + j] != 0 ? 1 : 0;
+            }
+        }
+        if (anchor_x >= 0) se.anchor_x = anchor_x;
+        if (anchor_y >= 0) se.anchor_y = anchor_y;
+
+        morpho_se* handle = new morpho_se;
+        handle->offsets = compileStructuringElement(se);
+        handle->left = se.anchor_x;
+        handle->right = se.width - 1 - se.anchor_x;
+        handle->top = se.anchor_y;
+        handle->bottom = se.height - 1 - se.anchor_y;
+        *out = handle;
+        return MORPHO_OK;
+    } catch (const std::bad_alloc&) {
+        return MORPHO_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+int morpho_se_create_shape(const char* shape, int32_t radius, morpho_se** out) {
+    if (!out) return MORPHO_ERROR_INVALID_ARGUMENT;
+    *out = nullptr;
+    if (!shape || radius < 0) return MORPHO_ERROR_INVALID_ARGUMENT;
+    std::string name(shape);
+    const auto& shapes = availableStructuringElementShapes();
+    if (std::find(shapes.begin(), shapes.end(), name) == shapes.end()) return MORPHO_ERROR_UNKNOWN_SHAPE;
+    try {
+        StructuringElement se = generateStructuringElement({name, radius});
+        std::vector<uint8_t> mask((size_t)se.width * se.height);
+        for (int i = 0; i < se.height; i++) {
+            for (int j = 0; j < se.width; j++) mask[(size_t)i * se.width + j] = (uint8_t)se.kernel[i][j];
+        }
+        return morpho_se_create(mask.data(), se.width, se.height, se.width, se.anchor_x, se.anchor_y, out);
+    } catch (const std::bad_alloc&) {
+        return MORPHO_ERROR_OUT_OF_MEMORY;
+    } catch (const std::invalid_argument&) {
+        // "mask" richiede un file: qui si usa morpho_se_create
+        return MORPHO_ERROR_UNKNOWN_SHAPE;
+    }
+}
+
+void morpho_se_destroy(morpho_se* se) {
+    delete se;
+}
+
+int morpho_apply(const morpho_se* se, morpho_op op, const morpho_image* image, uint8_t border, int threads) {
+    if (!se || !validOperation(op)) return MORPHO_ERROR_INVALID_ARGUMENT;
+    int status = checkImage(image);
+    if (status != MORPHO_OK) return status;
+    try {
+        processImage(*se, op, *image, border, threadCount(threads));
+        return MORPHO_OK;
+    } catch (const std::bad_alloc&) {
+        return MORPHO_ERROR_OUT_OF_MEMORY;
+    }
+}
+
+int morpho_apply_batch(const morpho_se* se, morpho_op op, const morpho_image* images, size_t count,
+                       uint8_t border, int threads, int* statuses) {
+    if (!se || !validOperation(op) || (!images && count > 0)) return MORPHO_ERROR_INVALID_ARGUMENT;
+    int first_error = MORPHO_OK;
+    size_t first_error_index = count;
+    // Un'immagine per thread, ciascuna elaborata in sequenza: nessuna regione annidata
+    #pragma omp parallel for schedule(dynamic, 1) num_threads(threadCount(threads))
+    for (size_t i = 0; i < count; i++) {
+        int status = checkImage(&images[i]);
+        if (status == MORPHO_OK) {
+            try {
+                processImage(*se, op, images[i], border, 1);
+            } catch (const std::bad_alloc&) {
+                status = MORPHO_ERROR_OUT_OF_MEMORY;
+            }
+        }
+        if (statuses) statuses[i] = status;
+        if (status != MORPHO_OK) {
+            #pragma omp critical(morpho_batch_status)
+            if (i < first_error_index) {
+                first_error_index = i;
+                first_error = status;
+            }
+        }
+    }
+    return first_error;
+}
+
+}
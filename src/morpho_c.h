@@ -0,0 +1,98 @@
+#ifndef MORPHOLOGY_MORPHO_C_H
+#define MORPHOLOGY_MORPHO_C_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * LIBRERIA CON INTERFACCIA C
+ *
+ * Le operazioni morfologiche richiamabili dentro un altro processo, senza lanciare l'eseguibile e
+ * senza passare da file JPEG: il chiamante fornisce i buffer di ingresso e di uscita (8 bit, un
+ * canale, con stride in byte fra le righe) e la libreria vi legge e scrive direttamente.
+ * Nessuna configurazione viene letta e nessun file viene aperto: l'elemento strutturante si compila
+ * una volta in un handle riusabile, ogni chiamata fa solo il calcolo.
+ *
+ * I risultati coincidono con quelli delle versioni C++ (V1/V2/V3): un pixel si erode se un vicino
+ * vale 0 e si dilata se un vicino vale 255, quindi le immagini vanno binarizzate a 0/255. I pixel di
+ * bordo, dove l'elemento strutturante esce dall'immagine, ricevono il valore "border".
+ * Le funzioni non lanciano eccezioni e restituiscono un codice morpho_status; tutte sono sicure da
+ * chiamare da più thread, anche con lo stesso handle.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(_WIN32) && defined(MORPHO_C_SHARED)
+    #ifdef MORPHO_C_BUILD
+        #define MORPHO_API __declspec(dllexport)
+    #else
+        #define MORPHO_API __declspec(dllimport)
+    #endif
+#elif defined(__GNUC__)
+    #define MORPHO_API __attribute__((visibility("default")))
+#else
+    #define MORPHO_API
+#endif
+
+/* Versione dell'interfaccia: cambia solo con modifiche incompatibili di strutture o firme */
+#define MORPHO_ABI_VERSION 1
+
+typedef enum morpho_status {
+    MORPHO_OK = 0,
+    MORPHO_ERROR_INVALID_ARGUMENT = 1,  /* Puntatore nullo, dimensioni o stride non validi */
+    MORPHO_ERROR_UNKNOWN_SHAPE = 2,     /* Forma non riconosciuta da morpho_se_create_shape */
+    MORPHO_ERROR_OVERLAP = 3,           /* Ingresso e uscita si sovrappongono: l'elaborazione sul posto non è supportata */
+    MORPHO_ERROR_OUT_OF_MEMORY = 4
+} morpho_status;
+
+typedef enum morpho_op {
+    MORPHO_EROSION = 0,
+    MORPHO_DILATION = 1,
+    MORPHO_OPENING = 2,                 /* Erosione seguita da dilatazione */
+    MORPHO_CLOSING = 3                  /* Dilatazione seguita da erosione */
+} morpho_op;
+
+/* Elemento strutturante compilato (opaco) */
+typedef struct morpho_se morpho_se;
+
+/* Immagine del chiamante: i buffer restano suoi, la libreria non li libera né li copia */
+typedef struct morpho_image {
+    const uint8_t* src;
+    ptrdiff_t src_stride;               /* Byte fra l'inizio di due righe, almeno width */
+    uint8_t* dst;
+    ptrdiff_t dst_stride;
+    int32_t width;
+    int32_t height;
+} morpho_image;
+
+MORPHO_API int morpho_abi_version(void);
+
+/* Descrizione leggibile di un codice di stato */
+MORPHO_API const char* morpho_status_string(int status);
+
+/* Elemento strutturante da una maschera width x height (diverso da 0 = attivo), con stride in byte fra
+   le righe; anchor_x/anchor_y negativi indicano il centro */
+MORPHO_API int morpho_se_create(const uint8_t* mask, int32_t width, int32_t height, ptrdiff_t stride,
+                                int32_t anchor_x, int32_t anchor_y, morpho_se** out);
+
+/* Elemento strutturante predefinito ("disk", "square", "cross", "diamond", "octagon", "ellipse", "rectangle",
+   "line") di raggio radius, come nei file di configurazione */
+MORPHO_API int morpho_se_create_shape(const char* shape, int32_t radius, morpho_se** out);
+
+MORPHO_API void morpho_se_destroy(morpho_se* se);
+
+/* Operazione su un'immagine, parallela sulle righe; threads <= 0 usa il numero di thread predefinito di OpenMP */
+MORPHO_API int morpho_apply(const morpho_se* se, morpho_op op, const morpho_image* image, uint8_t border, int threads);
+
+/* Operazione su count immagini (anche di dimensioni diverse), parallela sulle immagini. Se statuses non è
+   nullo riceve l'esito di ogni immagine; il valore restituito è l'errore dell'immagine di indice più basso, o MORPHO_OK */
+MORPHO_API int morpho_apply_batch(const morpho_se* se, morpho_op op, const morpho_image* images, size_t count,
+                                  uint8_t border, int threads, int* statuses);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MORPHOLOGY_MORPHO_C_H */
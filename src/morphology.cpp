@@ -0,0 +1,2162 @@
+#include "morphology.hpp"
+
+#include "trace.hpp"
+
+#include <omp.h>
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO SEQUENZIALE
+
+// Funzione per eseguire l'erosione
+STBImage erosion_V1(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool erode = false;
+            for (int i = 0; i < se.height && !erode; i++) {
+                for (int j = 0; j < se.width && !erode; j++) {
+                    int nx = x + j - se.anchor_x;
+                    int ny = y + i - se.anchor_y;
+
+                    if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 0) {
+                            erode = true;
+                    }
+                }
+            }
+            result.image_data[y * img.width + x] = erode ? 0 : 255;
+        }
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la dilatazione
+STBImage dilation_V1(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool dilate = false;
+            for (int i = 0; i < se.height && !dilate; i++) {
+                for (int j = 0; j < se.width && !dilate; j++) {
+                    int nx = x + j - se.anchor_x;
+                    int ny = y + i - se.anchor_y;
+
+                    if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 255) {
+                            dilate = true;
+                    }
+                }
+            }
+            result.image_data[y * img.width + x] = dilate ? 255 : 0;
+        }
+    }
+
+    return result;
+}
+
+// Funzione per eseguire l'apertura (Erosione seguita da Dilatazione)
+STBImage opening_V1(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return dilation_V1(erosion_V1(img, se, background), se, background);
+}
+
+// Funzione per eseguire la chiusura (Dilatazione seguita da Erosione)
+STBImage closing_V1(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    return erosion_V1(dilation_V1(img, se, background), se, background);
+}
+
+// Funzione per eseguire l'erosione per un vettore di immagini
+std::unordered_map<std::string, STBImage> erosion_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (auto &img : imgs) { 
+        imgs_results[img.filename] = erosion_V1(img, se, background);
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la dilatazione per un vettore di immagini
+std::unordered_map<std::string, STBImage> dilation_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (auto &img : imgs) {
+        imgs_results[img.filename] = dilation_V1(img, se, background);
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'apertura per un vettore di immagini (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (auto &img : imgs) {
+        imgs_results[img.filename] = dilation_V1(erosion_V1(img, se, background), se, background);
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la chiusura per un vettore di immagini (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    for (auto &img : imgs) {
+        imgs_results[img.filename] = erosion_V1(dilation_V1(img, se, background), se, background);
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'erosione ottimizzata
+STBImage erosion_V2(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool erode = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (erode) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (img.image_data[ny * img.width + nx] == 0) {
+                    erode = true;
+                }
+            }
+            result.image_data[y * img.width + x] = erode ? 0 : 255;
+        }
+    }
+    return result;
+}
+
+// Funzione per eseguire la dilatazione ottimizzata
+STBImage dilation_V2(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool dilate = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (dilate) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (img.image_data[ny * img.width + nx] == 255) {
+                    dilate = true;
+                }
+            }
+            result.image_data[y * img.width + x] = dilate ? 255 : 0;
+        }
+    }
+    return result;
+}
+
+// Funzione per eseguire l'apertura ottimizzata (Erosione seguita da Dilatazione)
+STBImage opening_V2(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool erode = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (erode) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (img.image_data[ny * img.width + nx] == 0) {
+                    erode = true;
+                }
+            }
+            half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+        }
+    }
+
+    for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+            bool dilate = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (dilate) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                    dilate = true;
+                }
+            }
+            result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+        }
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la chiusura ottimizzata (Dilatazione seguita da Erosione)
+STBImage closing_V2(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool dilate = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (dilate) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (img.image_data[ny * img.width + nx] == 255) {
+                        dilate = true;
+                }
+            }
+            half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+        }
+    }
+
+    for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+            bool erode = false;
+            for (const auto& [dy, dx] : active_pixels) {
+                if (erode) continue;
+                int nx = x + dx;
+                int ny = y + dy;
+                if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                        erode = true;
+                }
+            }
+            result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+        }
+    }
+
+    return result;
+}
+
+// Funzione per eseguire l'erosione ottimizzata per un vettore di immagini
+std::unordered_map<std::string, STBImage> erosion_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) { 
+        STBImage result;
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la dilatazione ottimizzata per un vettore di immagini
+std::unordered_map<std::string, STBImage> dilation_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage result;
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'apertura ottimizzata per un vettore di immagini (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage half_result;
+        STBImage result;
+        half_result.initializeBinary(img.width, img.height, background);
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+            }
+        }
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la chiusura ottimizzata per un vettore di immagini (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage half_result;
+        STBImage result;
+        half_result.initializeBinary(img.width, img.height, background);
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+            }
+        }
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+STBImage erosion_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    // Elaborazione per tile
+    for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                    bool erode = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (erode) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (img.image_data[ny * img.width + nx] == 0) {
+                            erode = true;
+                        }
+                    }
+                    result.image_data[y * img.width + x] = erode ? 0 : 255;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+STBImage dilation_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    // Elaborazione per tile
+    for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                    bool dilate = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (dilate) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (img.image_data[ny * img.width + nx] == 255) {
+                            dilate = true;
+                        }
+                    }
+                    result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                }
+            }
+        }
+    }
+    return result;
+}
+
+STBImage opening_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    // Erosione per tile
+    for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                    bool erode = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (erode) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (img.image_data[ny * img.width + nx] == 0) {
+                            erode = true;
+                        }
+                    }
+                    half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                }
+            }
+        }
+    }
+
+    // Dilatazione per tile
+    for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                    bool dilate = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (dilate) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                            dilate = true;
+                        }
+                    }
+                    result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+STBImage closing_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    // Dilatazione per tile
+    for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                    bool dilate = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (dilate) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (img.image_data[ny * img.width + nx] == 255) {
+                            dilate = true;
+                        }
+                    }
+                    half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                }
+            }
+        }
+    }
+
+    // Erosione per tile
+    for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+        for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+            TraceScope tile_trace("tile", "tile", tx, ty);
+            for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                    bool erode = false;
+                    for (const auto& [dy, dx] : active_pixels) {
+                        if (erode) continue;
+                        int nx = x + dx;
+                        int ny = y + dy;
+                        if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                            erode = true;
+                        }
+                    }
+                    result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+std::unordered_map<std::string, STBImage> erosion_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage result;
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> dilation_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage result;
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> opening_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage half_result;
+        STBImage result;
+        half_result.initializeBinary(img.width, img.height, background);
+        result.initializeBinary(img.width, img.height, background);
+
+        // Erosione su tile
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+
+        for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> closing_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    for (auto &img : imgs) {
+        STBImage half_result;
+        STBImage result;
+        half_result.initializeBinary(img.width, img.height, background);
+        result.initializeBinary(img.width, img.height, background);
+
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+
+        // Erosione su tile
+        for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                       bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+
+        imgs_results[img.filename] = result;
+    }
+    return imgs_results;
+}
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO PARALLELO
+
+// Funzione per eseguire l'erosione in parallelo
+STBImage erosion_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    #pragma omp parallel shared(result,img,se,background) default(none)
+    {
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (int i = 0; i < se.height && !erode; i++) {
+                    for (int j = 0; j < se.width && !erode; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+
+                        if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                        }
+                    }
+                }
+                result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la dilatazione in parallelo
+STBImage dilation_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    #pragma omp parallel shared(result,img,se,background) default(none)
+    {
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (int i = 0; i < se.height && !dilate; i++) {
+                    for (int j = 0; j < se.width && !dilate; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+
+                        if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                        }
+                    }
+                }
+                result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+
+    return result;
+}
+
+// Funzione per eseguire l'apertura in parallelo (Erosione seguita da Dilatazione)
+STBImage opening_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    #pragma omp parallel shared(result,half_result,img,se,background) default(none)
+    {
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (int i = 0; i < se.height && !erode; i++) {
+                    for (int j = 0; j < se.width && !erode; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+                        if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 0) {
+                            erode = true; 
+                        }
+                    }
+                }
+                half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (int i = 0; i < se.height && !dilate; i++) {
+                    for (int j = 0; j < se.width && !dilate; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+                        if (se.kernel[i][j] == 1 && half_result.image_data[ny * half_result.width + nx] == 255) {
+                                dilate = true;
+                        }
+                    }
+                }
+                result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la chiusura in parallelo (Dilatazione seguita da Erosione)
+STBImage closing_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    #pragma omp parallel shared(result,half_result,img,se,background) default(none)
+    {
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (int i = 0; i < se.height && !dilate; i++) {
+                    for (int j = 0; j < se.width && !dilate; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+                        if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 255) {
+                            dilate = true;
+                        }
+                    }
+                }
+                half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (int i = 0; i < se.height && !erode; i++) {
+                    for (int j = 0; j < se.width && !erode; j++) {
+                        int nx = x + j - se.anchor_x;
+                        int ny = y + i - se.anchor_y;
+                        if (se.kernel[i][j] == 1 && half_result.image_data[ny * half_result.width + nx] == 0) {
+                                erode = true;
+                        }
+                    }
+                }
+                result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+    }
+
+    return result;
+}
+
+// Funzione per eseguire l'erosione per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> erosion_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    #pragma omp parallel shared(imgs_results,imgs,se,background) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,img,se,background) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (int i = 0; i < se.height && !erode; i++) {
+                            for (int j = 0; j < se.width && !erode; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 0) {
+                                        erode = true;
+                                }
+                            }
+                        }
+                        result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la dilatazione per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> dilation_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    #pragma omp parallel shared(imgs_results,imgs,se,background) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,img,se,background) default(none)
+            {
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (int i = 0; i < se.height && !dilate; i++) {
+                            for (int j = 0; j < se.width && !dilate; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 255) {
+                                        dilate = true;
+                                }
+                            }
+                        }
+                        result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'apertura per un vettore di immagini in parallelo (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    #pragma omp parallel shared(imgs_results,imgs,se,background) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,half_result,img,se,background) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (int i = 0; i < se.height && !erode; i++) {
+                            for (int j = 0; j < se.width && !erode; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 0) {
+                                    erode = true;
+                                }
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (int i = 0; i < se.height && !dilate; i++) {
+                            for (int j = 0; j < se.width && !dilate; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && half_result.image_data[ny * half_result.width + nx] == 255) {
+                                    dilate = true;
+                                }
+                            }
+                        }
+                        result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la chiusura per un vettore di immagini in parallelo (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+    #pragma omp parallel shared(imgs_results,imgs,se,background) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+    
+            #pragma omp parallel shared(result,half_result,img,se,background) default(none)
+            {
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (int i = 0; i < se.height && !dilate; i++) {
+                            for (int j = 0; j < se.width && !dilate; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && img.image_data[ny * img.width + nx] == 255) {
+                                    dilate = true;
+                                }
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+    
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (int i = 0; i < se.height && !erode; i++) {
+                            for (int j = 0; j < se.width && !erode; j++) {
+                                int nx = x + j - se.anchor_x;
+                                int ny = y + i - se.anchor_y;
+                                if (se.kernel[i][j] == 1 && half_result.image_data[ny * half_result.width + nx] == 0) {
+                                    erode = true;
+                                }
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'erosione ottimizzata in parallelo
+STBImage erosion_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+    result.initializeBinary(img.width, img.height, background);
+
+    #pragma omp parallel shared(result,active_pixels,img,se) default(none)
+    {
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la dilatazione ottimizzata in parallelo
+STBImage dilation_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result,active_pixels,img,se) default(none)
+    {
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return result;
+}
+
+// Funzione per eseguire l'apertura ottimizzata in parallelo (Erosione seguita da Dilatazione)
+STBImage opening_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result,half_result,active_pixels,img,se) default(none)
+    {
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+    }
+    return result;
+}
+
+// Funzione per eseguire la chiusura ottimizzata in parallelo (Dilatazione seguita da Erosione)
+STBImage closing_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result,half_result,active_pixels,img,se) default(none)
+    {
+        TraceScope dilation_trace("dilation", "stage");
+        uint64_t dilation_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                dilation_iterations++;
+                bool dilate = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (dilate) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (img.image_data[ny * img.width + nx] == 255) {
+                        dilate = true;
+                    }
+                }
+                half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+            }
+        }
+        balanceAddIterations(dilation_iterations);
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+
+        TraceScope erosion_trace("erosion", "stage");
+        uint64_t erosion_iterations = 0;
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+            for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                erosion_iterations++;
+                bool erode = false;
+                for (const auto& [dy, dx] : active_pixels) {
+                    if (erode) continue;
+                    int nx = x + dx;
+                    int ny = y + dy;
+                    if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                        erode = true;
+                    }
+                }
+                result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+            }
+        }
+        balanceAddIterations(erosion_iterations);
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+    }
+
+    return result;
+}
+
+// Funzione per eseguire l'erosione ottimizzata per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> erosion_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results,imgs,active_pixels,background,se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,active_pixels,img,background,se) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+            imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la dilatazione ottimizzata per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> dilation_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results,imgs,active_pixels,background,se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,active_pixels,img,background,se) default(none)
+            {
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'apertura ottimizzata per un vettore di immagini in parallelo (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results,imgs,active_pixels,background,se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,half_result,active_pixels,img,background,se) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire la chiusura ottimizzata per un vettore di immagini in parallelo (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results,imgs,active_pixels,background,se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result,half_result,active_pixels,img,background,se) default(none)
+            {   
+                TraceScope dilation_trace("dilation", "stage");
+                uint64_t dilation_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+                        dilation_iterations++;
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+                balanceAddIterations(dilation_iterations);
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+
+                TraceScope erosion_trace("erosion", "stage");
+                uint64_t erosion_iterations = 0;
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int y = se.anchor_y; y < half_result.height - se.anchor_y; y++) {
+                    for (int x = se.anchor_x; x < half_result.width - se.anchor_x; x++) {
+                        erosion_iterations++;
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                    }
+                }
+                balanceAddIterations(erosion_iterations);
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+// Funzione per eseguire l'erosione ottimizzata con tiling e OpenMP
+STBImage erosion_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result, active_pixels, img, tile_size, se) default(none)
+    {
+        TraceScope erosion_trace("erosion", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+        erosion_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la dilatazione ottimizzata con tiling e OpenMP
+STBImage dilation_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage result;
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result, active_pixels, img, tile_size, se) default(none)
+    {
+        TraceScope dilation_trace("dilation", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+        dilation_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return result;
+}
+
+// Funzione per eseguire l'apertura ottimizzata con tiling e OpenMP (Erosione seguita da Dilatazione)
+STBImage opening_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result, half_result, active_pixels, img, tile_size, se) default(none)
+    {
+        // Erosione
+        TraceScope erosion_trace("erosion", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+
+        // Dilatazione
+        TraceScope dilation_trace("dilation", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+    }
+
+    return result;
+}
+
+// Funzione per eseguire la chiusura ottimizzata con tiling e OpenMP (Dilatazione seguita da Erosione)
+STBImage closing_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background) {
+    STBImage half_result;
+    STBImage result;
+    half_result.initializeBinary(img.width, img.height, background);
+    result.initializeBinary(img.width, img.height, background);
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(result, half_result, active_pixels, img, tile_size, se) default(none)
+    {
+        // Dilatazione
+        TraceScope dilation_trace("dilation", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                        bool dilate = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (dilate) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (img.image_data[ny * img.width + nx] == 255) {
+                                dilate = true;
+                            }
+                        }
+                        half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                    }
+                }
+            }
+        }
+        dilation_trace.end();
+        TraceScope dilation_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        dilation_barrier_trace.end();
+
+        // Erosione
+        TraceScope erosion_trace("erosion", "stage");
+        #pragma omp for collapse(2) schedule(static) nowait
+        for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+            for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                TraceScope tile_trace("tile", "tile", tx, ty);
+                for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                    for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                        bool erode = false;
+                        for (const auto& [dy, dx] : active_pixels) {
+                            if (erode) continue;
+                            int nx = x + dx;
+                            int ny = y + dy;
+                            if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                                erode = true;
+                            }
+                        }
+                        result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                    }
+                }
+            }
+        }
+        erosion_trace.end();
+        TraceScope erosion_barrier_trace("barrier", "sync");
+        #pragma omp barrier
+        erosion_barrier_trace.end();
+    }
+
+    return result;
+}
+
+std::unordered_map<std::string, STBImage> erosion_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results, imgs, active_pixels, background, tile_size, se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result, active_pixels, img, background, tile_size, se) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                                bool erode = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (erode) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (img.image_data[ny * img.width + nx] == 0) {
+                                        erode = true;
+                                    }
+                                }
+                                result.image_data[y * img.width + x] = erode ? 0 : 255;
+                            }
+                        }
+                    }
+                }
+                erosion_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> dilation_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results, imgs, active_pixels, background, tile_size, se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage result;
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result, active_pixels, img, background, tile_size, se) default(none)
+            {
+                TraceScope dilation_trace("dilation", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                                bool dilate = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (dilate) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (img.image_data[ny * img.width + nx] == 255) {
+                                        dilate = true;
+                                    }
+                                }
+                                result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                            }
+                        }
+                    }
+                }
+                dilation_trace.end();
+                TraceScope barrier_trace("barrier", "sync");
+                #pragma omp barrier
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> opening_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results, imgs, active_pixels, background, tile_size, se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result, half_result, active_pixels, img, background, tile_size, se) default(none)
+            {
+                TraceScope erosion_trace("erosion", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                                bool erode = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (erode) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (img.image_data[ny * img.width + nx] == 0) {
+                                        erode = true;
+                                    }
+                                }
+                                half_result.image_data[y * img.width + x] = erode ? 0 : 255;
+                            }
+                        }
+                    }
+                }
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+
+                TraceScope dilation_trace("dilation", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                                bool dilate = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (dilate) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (half_result.image_data[ny * half_result.width + nx] == 255) {
+                                        dilate = true;
+                                    }
+                                }
+                                result.image_data[y * half_result.width + x] = dilate ? 255 : 0;
+                            }
+                        }
+                    }
+                }
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
+
+std::unordered_map<std::string, STBImage> closing_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background) {
+    std::unordered_map<std::string, STBImage> imgs_results = {};
+
+    std::vector<std::pair<int, int>> active_pixels = compileStructuringElement(se);
+
+    #pragma omp parallel shared(imgs_results, imgs, active_pixels, background, tile_size, se) default(none)
+    {
+        TraceScope images_trace("images", "stage");
+        #pragma omp for schedule(static) nowait
+        for (auto &img : imgs) {
+            TraceScope image_trace("image", "image");
+            STBImage half_result;
+            STBImage result;
+            half_result.initializeBinary(img.width, img.height, background);
+            result.initializeBinary(img.width, img.height, background);
+
+            #pragma omp parallel shared(result, half_result, active_pixels, img, background, tile_size, se) default(none)
+            {
+                TraceScope dilation_trace("dilation", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < img.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < img.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, img.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, img.width - se.anchor_x); x++) {
+                                bool dilate = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (dilate) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (img.image_data[ny * img.width + nx] == 255) {
+                                        dilate = true;
+                                    }
+                                }
+                                half_result.image_data[y * img.width + x] = dilate ? 255 : 0;
+                            }
+                        }
+                    }
+                }
+                dilation_trace.end();
+                TraceScope dilation_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                dilation_barrier_trace.end();
+
+                TraceScope erosion_trace("erosion", "stage");
+                #pragma omp for collapse(2) schedule(static) nowait
+                for (int ty = se.anchor_y; ty < half_result.height - se.anchor_y; ty += tile_size) {
+                    for (int tx = se.anchor_x; tx < half_result.width - se.anchor_x; tx += tile_size) {
+                        TraceScope tile_trace("tile", "tile", tx, ty);
+                        for (int y = ty; y < std::min(ty + tile_size, half_result.height - se.anchor_y); y++) {
+                            for (int x = tx; x < std::min(tx + tile_size, half_result.width - se.anchor_x); x++) {
+                                bool erode = false;
+                                for (const auto& [dy, dx] : active_pixels) {
+                                    if (erode) continue;
+                                    int nx = x + dx;
+                                    int ny = y + dy;
+                                    if (half_result.image_data[ny * half_result.width + nx] == 0) {
+                                        erode = true;
+                                    }
+                                }
+                                result.image_data[y * half_result.width + x] = erode ? 0 : 255;
+                            }
+                        }
+                    }
+                }
+                erosion_trace.end();
+                TraceScope erosion_barrier_trace("barrier", "sync");
+                #pragma omp barrier
+                erosion_barrier_trace.end();
+            }
+
+            TraceScope critical_trace("critical", "lock");
+            #pragma omp critical
+            {
+                imgs_results[img.filename] = result;
+            }
+            critical_trace.end();
+        }
+        images_trace.end();
+        TraceScope barrier_trace("barrier", "sync");
+        #pragma omp barrier
+    }
+    return imgs_results;
+}
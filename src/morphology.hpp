@@ -0,0 +1,282 @@
+#ifndef MORPHOLOGY_MORPHOLOGY_HPP
+#define MORPHOLOGY_MORPHOLOGY_HPP
+
+#include "image.hpp"
+
+#include <unordered_map>
+
+// Funzione per compilare l'elemento strutturante nella lista degli spostamenti (dy, dx) dei pixel attivi,
+// usata dalle versioni V2 e V3 al posto della scansione completa del kernel
+std::vector<std::pair<int, int>> compileStructuringElement(const StructuringElement& se);
+
+// Corda: segmento orizzontale di pixel attivi, spostamento (dy, dx) del primo pixel rispetto all'ancora
+struct StructuringElementChord {
+    int dy, dx, length;
+};
+
+// Piano di calcolo esatto della versione V4 per un elemento strutturante
+struct StructuringElementPlan {
+    SEDecomposition kind{SEDecomposition::Chords};
+    int x0{0}, y0{0}, x1{0}, y1{0};     // Riquadro dei pixel attivi rispetto all'ancora (estremi inclusi)
+    int active{0};                      // Pixel attivi (costo del percorso diretto)
+    int radius{0};                      // Diamond: raggio del rombo; Octagon: raggio del rombo dopo il rettangolo
+    std::vector<StructuringElementChord> chords;   // Chords: corde, ordinate per riga
+    std::vector<int> lengths;           // Chords: lunghezze distinte delle corde
+};
+
+// Funzione per scegliere la scomposizione esatta: quella registrata dalla forma, se la maschera la
+// rispetta, altrimenti la prima applicabile fra rettangolo, croce, rombo, ottagono e corde
+StructuringElementPlan planStructuringElement(const StructuringElement& se);
+
+// Confronti min/max per pixel stimati per un piano, con il percorso più economico fra diretto e
+// scomposto (usati dal modello di costo del registro)
+double structuringElementPlanChecks(const StructuringElementPlan& plan);
+
+// Nome della scomposizione ("separable", "diamond", ...)
+std::string decompositionName(SEDecomposition kind);
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO SEQUENZIALE
+
+// Funzione per eseguire l'erosione
+STBImage erosion_V1(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione
+STBImage dilation_V1(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura (Erosione seguita da Dilatazione)
+STBImage opening_V1(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura (Dilatazione seguita da Erosione)
+STBImage closing_V1(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione per un vettore di immagini
+std::unordered_map<std::string, STBImage> erosion_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione per un vettore di immagini
+std::unordered_map<std::string, STBImage> dilation_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura per un vettore di immagini (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura per un vettore di immagini (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V1_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione ottimizzata
+STBImage erosion_V2(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione ottimizzata
+STBImage dilation_V2(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura ottimizzata (Erosione seguita da Dilatazione)
+STBImage opening_V2(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura ottimizzata (Dilatazione seguita da Erosione)
+STBImage closing_V2(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione ottimizzata per un vettore di immagini
+std::unordered_map<std::string, STBImage> erosion_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione ottimizzata per un vettore di immagini
+std::unordered_map<std::string, STBImage> dilation_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura ottimizzata per un vettore di immagini (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura ottimizzata per un vettore di immagini (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V2_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+STBImage erosion_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+STBImage dilation_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+STBImage opening_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+STBImage closing_V3(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> erosion_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> dilation_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> opening_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> closing_V3_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+// VERSIONE V4: l'elemento strutturante si calcola con la sua scomposizione (planStructuringElement):
+// passate separabili e corde con minimo/massimo su finestre scorrevoli (van Herk / Gil-Werman, tre
+// confronti per pixel qualunque sia la lunghezza), croce 3x3 ripetuta per il rombo; gli elementi piccoli
+// usano il percorso diretto, un minimo/massimo SIMD per pixel attivo. Stesso risultato e stesso bordo di V1.
+
+// Funzione per eseguire l'erosione con la scomposizione dell'elemento strutturante
+STBImage erosion_V4(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione con la scomposizione dell'elemento strutturante
+STBImage dilation_V4(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura con la scomposizione dell'elemento strutturante
+STBImage opening_V4(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura con la scomposizione dell'elemento strutturante
+STBImage closing_V4(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> erosion_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> dilation_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> opening_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> closing_V4_imgvec(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// VERSIONE V4 IN SCALA DI GRIGI: erosione e dilatazione sono minimo e massimo sui vicini attivi di un
+// elemento strutturante piatto, per pixel uint8_t, uint16_t e float (istanziati in decomposition.cpp).
+// Stesso nucleo e stesso bordo della versione binaria; i valori NaN non sono supportati.
+
+// Percorso di calcolo: diretto (un minimo/massimo SIMD per pixel attivo), scomposto (van Herk e passate
+// di planStructuringElement) o scelto dal costo stimato
+enum class MinMaxPath { Auto, Direct, Decomposed };
+
+// Funzione per eseguire l'erosione in scala di grigi
+template <typename T>
+GrayImage<T> erosion_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path = MinMaxPath::Auto, bool parallel = false);
+
+// Funzione per eseguire la dilatazione in scala di grigi
+template <typename T>
+GrayImage<T> dilation_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path = MinMaxPath::Auto, bool parallel = false);
+
+// Funzione per eseguire l'apertura in scala di grigi (Erosione seguita da Dilatazione)
+template <typename T>
+GrayImage<T> opening_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path = MinMaxPath::Auto, bool parallel = false);
+
+// Funzione per eseguire la chiusura in scala di grigi (Dilatazione seguita da Erosione)
+template <typename T>
+GrayImage<T> closing_gray(const GrayImage<T>& img, const StructuringElement& se, T background, MinMaxPath path = MinMaxPath::Auto, bool parallel = false);
+
+// ELEMENTI STRUTTURANTI NON PIATTI (weighted.cpp): dilatazione max_b f(x + b) + s(b) ed erosione
+// min_b f(x + b) - s(b) per pixel uint8_t, uint16_t e float. Tutti i pixel sono calcolati: gli spostamenti
+// che escono dall'immagine si ignorano, senza bordo di sfondo (una sfera grande lascerebbe solo bordo).
+
+// Percorso di calcolo: diretto (somma saturata e massimo SIMD per spostamento del supporto, con altezze
+// arrotondate all'intero per i pixel interi), separabile (paraboloide illimitato esatto con l'inviluppo
+// inferiore di parabole per righe e colonne, tempo lineare nei pixel, in doppia precisione) o scelto
+// dall'elemento: separabile per paraboloid_unbounded, diretto per tutti gli altri
+enum class WeightedPath { Auto, Direct, Separable };
+
+// Funzione per eseguire l'erosione con un elemento strutturante non piatto (std::invalid_argument per
+// Separable con un elemento diverso da paraboloid_unbounded e per Direct con paraboloid_unbounded)
+template <typename T>
+GrayImage<T> erosion_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path = WeightedPath::Auto, bool parallel = false);
+
+// Funzione per eseguire la dilatazione con un elemento strutturante non piatto
+template <typename T>
+GrayImage<T> dilation_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path = WeightedPath::Auto, bool parallel = false);
+
+// Funzione per eseguire l'apertura con un elemento strutturante non piatto (Erosione seguita da Dilatazione)
+template <typename T>
+GrayImage<T> opening_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path = WeightedPath::Auto, bool parallel = false);
+
+// Funzione per eseguire la chiusura con un elemento strutturante non piatto (Dilatazione seguita da Erosione)
+template <typename T>
+GrayImage<T> closing_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path = WeightedPath::Auto, bool parallel = false);
+
+// FUNZIONI OPERAZIONI MORFOLOGICHE IN MODO PARALLELO
+
+// Funzione per eseguire l'erosione in parallelo
+STBImage erosion_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione in parallelo
+STBImage dilation_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura in parallelo (Erosione seguita da Dilatazione)
+STBImage opening_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura in parallelo (Dilatazione seguita da Erosione)
+STBImage closing_V1_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> erosion_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> dilation_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura per un vettore di immagini in parallelo (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura per un vettore di immagini in parallelo (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V1_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione ottimizzata in parallelo
+STBImage erosion_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione ottimizzata in parallelo
+STBImage dilation_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura ottimizzata in parallelo (Erosione seguita da Dilatazione)
+STBImage opening_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura ottimizzata in parallelo (Dilatazione seguita da Erosione)
+STBImage closing_V2_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione ottimizzata per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> erosion_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione ottimizzata per un vettore di immagini in parallelo
+std::unordered_map<std::string, STBImage> dilation_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura ottimizzata per un vettore di immagini in parallelo (Erosione seguita da Dilatazione)
+std::unordered_map<std::string, STBImage> opening_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura ottimizzata per un vettore di immagini in parallelo (Dilatazione seguita da Erosione)
+std::unordered_map<std::string, STBImage> closing_V2_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'erosione ottimizzata con tiling e OpenMP
+STBImage erosion_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+// Funzione per eseguire la dilatazione ottimizzata con tiling e OpenMP
+STBImage dilation_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+// Funzione per eseguire l'apertura ottimizzata con tiling e OpenMP (Erosione seguita da Dilatazione)
+STBImage opening_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+// Funzione per eseguire la chiusura ottimizzata con tiling e OpenMP (Dilatazione seguita da Erosione)
+STBImage closing_V3_parallel(const STBImage& img, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> erosion_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> dilation_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> opening_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+std::unordered_map<std::string, STBImage> closing_V3_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, const int tile_size, uint8_t background);
+
+// Funzione per eseguire l'erosione con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage erosion_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la dilatazione con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage dilation_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire l'apertura con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage opening_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Funzione per eseguire la chiusura con la scomposizione dell'elemento strutturante, in parallelo sulle righe
+STBImage closing_V4_parallel(const STBImage& img, const StructuringElement& se, uint8_t background);
+
+// Vettori di immagini: in parallelo sulle immagini, ognuna con la versione sequenziale
+std::unordered_map<std::string, STBImage> erosion_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> dilation_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> opening_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+std::unordered_map<std::string, STBImage> closing_V4_imgvec_parallel(const std::vector<STBImage>& imgs, const StructuringElement& se, uint8_t background);
+
+// Operazioni e versioni disponibili, nell'ordine del registro (kernel_registry.cpp)
+const std::vector<std::string>& availableOperations();
+const std::vector<std::string>& availableModes();
+
+// Funzione per applicare un'operazione morfologica con la versione indicata a una singola immagine
+// (mode "auto" sceglie la versione con il modello di costo del registro)
+STBImage applyOperation(const STBImage& img, const StructuringElement& se, const std::string& operation, const std::string& mode, int tile_size, uint8_t background);
+
+// Funzione per applicare un'operazione morfologica con la versione indicata a un vettore di immagini
+std::unordered_map<std::string, STBImage> applyOperationImgVec(const std::vector<STBImage>& imgs, const StructuringElement& se, const std::string& operation, const std::string& mode, int tile_size, uint8_t background);
+
+#endif // MORPHOLOGY_MORPHOLOGY_HPP
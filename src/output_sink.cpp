@@ -0,0 +1,10 @@
+#include "output_sink.hpp"
+
+#include <stdexcept>
+
+OutputSinkMode parseOutputSinkMode(const std::string& name) {
+    if (name == "none") return OutputSinkMode::None;
+    if (name == "async") return OutputSinkMode::Async;
+    if (name == "sync") return OutputSinkMode::Sync;
+    throw std::invalid_argument("Invalid output sink mode: " + name);
+}
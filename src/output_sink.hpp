@@ -0,0 +1,117 @@
+#ifndef MORPHOLOGY_OUTPUT_SINK_HPP
+#define MORPHOLOGY_OUTPUT_SINK_HPP
+
+#include "image.hpp"
+
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+// Modalità di gestione delle immagini risultato
+enum class OutputSinkMode {
+    None,   // Scarta i risultati (nessun I/O)
+    Async,  // Codifica e scrive in background con un pool di thread dedicato
+    Sync    // Codifica e scrive subito sul thread chiamante (comportamento originale)
+};
+
+OutputSinkMode parseOutputSinkMode(const std::string& name);
+
+// Destinazione delle immagini risultato. In modalità Async la codifica avviene solo nei thread
+// di scrittura: i thread di calcolo accodano l'immagine e si bloccano solo se la coda è piena.
+// testProcessImages svuota la coda (flush) prima di ogni misura: i tempi sul vettore di immagini non
+// includono mai i thread di scrittura, quelli per immagine includono le scritture delle immagini
+// precedenti della stessa misura che competono per CPU e memoria.
+// Le scritture non riuscite si contano (failedWrites): in modalità Async l'errore arriva dopo submit.
+class OutputSink {
+public:
+    OutputSink(OutputSinkMode mode, int num_writers = 2, size_t max_queue = 64)
+        : mode(mode), max_queue(max_queue > 0 ? max_queue : 1) {
+        if (mode == OutputSinkMode::Async) {
+            for (int i = 0; i < std::max(num_writers, 1); i++) {
+                writers.emplace_back([this] { writerLoop(); });
+            }
+        }
+    }
+
+    ~OutputSink() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        not_empty.notify_all();
+        for (auto& writer : writers) {
+            writer.join();
+        }
+    }
+
+    OutputSink(const OutputSink&) = delete;
+    OutputSink& operator=(const OutputSink&) = delete;
+
+    OutputSinkMode getMode() const { return mode; }
+
+    // Consegna un'immagine da salvare in path
+    void submit(STBImage&& img, const std::string& path) {
+        if (mode == OutputSinkMode::None) {
+            img.freeImage();
+            return;
+        }
+        if (mode == OutputSinkMode::Sync) {
+            if (!img.saveImage(path)) failed++;
+            img.freeImage();
+            return;
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return queue.size() < max_queue; });
+        queue.emplace_back(std::move(img), path);
+        lock.unlock();
+        not_empty.notify_one();
+    }
+
+    // Scritture non riuscite dalla creazione (complete solo dopo flush)
+    size_t failedWrites() const { return failed.load(); }
+
+    // Attende che tutte le immagini accodate siano state scritte
+    void flush() {
+        std::unique_lock<std::mutex> lock(mutex);
+        drained.wait(lock, [this] { return queue.empty() && in_flight == 0; });
+    }
+
+private:
+    void writerLoop() {
+        while (true) {
+            std::unique_lock<std::mutex> lock(mutex);
+            not_empty.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) {
+                return; // stopping e nessun lavoro residuo
+            }
+            auto job = std::move(queue.front());
+            queue.pop_front();
+            in_flight++;
+            lock.unlock();
+            not_full.notify_one();
+
+            if (!job.first.saveImage(job.second)) failed++;
+            job.first.freeImage();
+
+            lock.lock();
+            in_flight--;
+            if (queue.empty() && in_flight == 0) {
+                drained.notify_all();
+            }
+        }
+    }
+
+    OutputSinkMode mode;
+    size_t max_queue;
+    std::deque<std::pair<STBImage, std::string>> queue;
+    std::vector<std::thread> writers;
+    std::mutex mutex;
+    std::condition_variable not_empty, not_full, drained;
+    size_t in_flight{0};
+    bool stopping{false};
+    std::atomic<size_t> failed{0};
+};
+
+#endif // MORPHOLOGY_OUTPUT_SINK_HPP
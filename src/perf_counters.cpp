@@ -0,0 +1,136 @@
+#include "perf_counters.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+static const char* PERF_COUNTER_NAMES[PERF_NUM_COUNTERS] = {
+    "cycles", "instructions", "l1d_misses", "llc_misses", "branch_misses"
+};
+
+static int perf_fds[PERF_NUM_COUNTERS] = {-1, -1, -1, -1, -1};
+static std::string perf_status = "contatori non aperti";
+
+const char* perfCounterName(int id) {
+    return (id >= 0 && id < PERF_NUM_COUNTERS) ? PERF_COUNTER_NAMES[id] : "unknown";
+}
+
+bool PerfSample::any() const {
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        if (has(id)) return true;
+    }
+    return false;
+}
+
+double PerfSample::ipc() const {
+    if (!has(PERF_CYCLES) || !has(PERF_INSTRUCTIONS) || values[PERF_CYCLES] == 0) return NAN;
+    return (double)values[PERF_INSTRUCTIONS] / values[PERF_CYCLES];
+}
+
+double PerfSample::perPixel(int id, double pixels) const {
+    if (!has(id) || pixels <= 0) return NAN;
+    return values[id] / pixels;
+}
+
+PerfSample& PerfSample::operator+=(const PerfSample& other) {
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        values[id] = (has(id) && other.has(id)) ? values[id] + other.values[id] : -1;
+    }
+    return *this;
+}
+
+PerfSample operator-(const PerfSample& end, const PerfSample& start) {
+    PerfSample delta;
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        if (end.has(id) && start.has(id)) delta.values[id] = std::max<int64_t>(0, end.values[id] - start.values[id]);
+    }
+    return delta;
+}
+
+#ifdef __linux__
+
+static int openCounter(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.inherit = 1;           // Conta anche i thread creati dopo l'apertura (pool OpenMP)
+    attr.exclude_kernel = 1;    // Consentito anche con perf_event_paranoid = 2
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+bool openPerfCounters() {
+    closePerfCounters();
+    const struct { uint32_t type; uint64_t config; } events[PERF_NUM_COUNTERS] = {
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+        {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+    };
+
+    std::string opened, missing;
+    int first_errno = 0;
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        perf_fds[id] = openCounter(events[id].type, events[id].config);
+        std::string& list = perf_fds[id] >= 0 ? opened : missing;
+        list += (list.empty() ? "" : ",") + std::string(PERF_COUNTER_NAMES[id]);
+        if (perf_fds[id] < 0 && first_errno == 0) first_errno = errno;
+    }
+
+    perf_status = opened.empty() ? "nessun contatore disponibile" : "contatori attivi: " + opened;
+    if (!missing.empty()) {
+        perf_status += " (non disponibili: " + missing + ", " + std::strerror(first_errno) + ")";
+    }
+    return !opened.empty();
+}
+
+PerfSample readPerfCounters() {
+    PerfSample sample;
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        if (perf_fds[id] < 0) continue;
+        uint64_t data[3]; // valore, tempo abilitato, tempo effettivamente in esecuzione
+        if (read(perf_fds[id], data, sizeof(data)) != (ssize_t)sizeof(data)) continue;
+        // Con più eventi che registri della PMU il kernel alterna i contatori: si riscala il conteggio
+        double scale = (data[2] > 0 && data[2] < data[1]) ? (double)data[1] / data[2] : 1.0;
+        sample.values[id] = (int64_t)(data[0] * scale);
+    }
+    return sample;
+}
+
+void closePerfCounters() {
+    for (int id = 0; id < PERF_NUM_COUNTERS; id++) {
+        if (perf_fds[id] >= 0) close(perf_fds[id]);
+        perf_fds[id] = -1;
+    }
+    perf_status = "contatori non aperti";
+}
+
+#else
+
+bool openPerfCounters() {
+    perf_status = "contatori hardware supportati solo su Linux";
+    return false;
+}
+
+PerfSample readPerfCounters() {
+    return PerfSample();
+}
+
+void closePerfCounters() {}
+
+#endif
+
+std::string perfCountersStatus() {
+    return perf_status;
+}
@@ -0,0 +1,55 @@
+#ifndef MORPHOLOGY_PERF_COUNTERS_HPP
+#define MORPHOLOGY_PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include <string>
+
+// CONTATORI HARDWARE (Linux perf_event_open)
+//
+// I contatori sono aperti una volta sola per l'intero processo con "inherit": il kernel somma i
+// conteggi di tutti i thread creati dopo l'apertura, quindi openPerfCounters() va chiamata prima
+// della prima regione OpenMP. Una misura è la differenza fra due letture. Se perf_event_open non
+// è disponibile (altro sistema operativo, perf_event_paranoid, macchina virtuale senza PMU) i
+// singoli contatori risultano assenti e i campi derivati vengono riportati come NA.
+
+enum PerfCounterId {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,    // Miss in lettura della cache dati L1
+    PERF_LLC_MISSES,    // Miss dell'ultimo livello di cache
+    PERF_BRANCH_MISSES,
+    PERF_NUM_COUNTERS
+};
+
+// Nome del contatore usato nelle intestazioni dei risultati (es. "llc_misses")
+const char* perfCounterName(int id);
+
+// Conteggi di un intervallo; -1 per i contatori non disponibili
+struct PerfSample {
+    int64_t values[PERF_NUM_COUNTERS]{-1, -1, -1, -1, -1};
+
+    bool has(int id) const { return values[id] >= 0; }
+    bool any() const;
+
+    // Istruzioni per ciclo; NaN se uno dei due contatori manca
+    double ipc() const;
+    // Eventi per pixel elaborato; NaN se il contatore manca
+    double perPixel(int id, double pixels) const;
+
+    PerfSample& operator+=(const PerfSample& other);
+};
+
+PerfSample operator-(const PerfSample& end, const PerfSample& start);
+
+// Funzione per aprire i contatori; restituisce true se almeno uno è disponibile
+bool openPerfCounters();
+
+// Funzione per leggere i conteggi cumulativi (scalati in caso di multiplexing) di tutti i thread
+PerfSample readPerfCounters();
+
+void closePerfCounters();
+
+// Descrizione dei contatori aperti o del motivo per cui non lo sono
+std::string perfCountersStatus();
+
+#endif // MORPHOLOGY_PERF_COUNTERS_HPP
@@ -0,0 +1,387 @@
+#include "results_store.hpp"
+
+// Generato da CMake; le build senza CMake (tasks.json) registrano valori sconosciuti
+#if __has_include("build_info.hpp")
+#include "build_info.hpp"
+#else
+#define MORPHO_GIT_HASH "unknown"
+#define MORPHO_GIT_DIRTY 0
+#define MORPHO_COMPILER "unknown"
+#define MORPHO_CXX_FLAGS ""
+#define MORPHO_BUILD_TYPE ""
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
+
+BuildInfo buildInfo() {
+    BuildInfo info;
+    info.git_hash = MORPHO_GIT_HASH;
+    info.git_dirty = MORPHO_GIT_DIRTY != 0;
+    info.compiler = MORPHO_COMPILER;
+    info.flags = MORPHO_CXX_FLAGS;
+    info.build_type = MORPHO_BUILD_TYPE;
+    return info;
+}
+
+std::string cpuModel() {
+    std::ifstream cpuinfo("/proc/cpuinfo");
+    std::string line;
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != std::string::npos) {
+                size_t start = line.find_first_not_of(" \t", colon + 1);
+                return start == std::string::npos ? "unknown" : line.substr(start);
+            }
+        }
+    }
+    return "unknown";
+}
+
+// Hash FNV-1a della configurazione serializzata: esecuzioni confrontabili hanno lo stesso hash
+static std::string configHash(const json& config) {
+    uint64_t hash = 0xcbf29ce484222325ull;
+    for (unsigned char c : config.dump()) {
+        hash = (hash ^ c) * 0x100000001b3ull;
+    }
+    std::ostringstream stream;
+    stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return stream.str();
+}
+
+json makeRunRecord(const std::string& tool, const json& config, const std::vector<StoredResult>& results) {
+    BuildInfo build = buildInfo();
+    char hostname[256] = "unknown";
+    gethostname(hostname, sizeof(hostname) - 1);
+
+    json record;
+    record["schema"] = "morphology-results";
+    record["schema_version"] = RESULTS_STORE_SCHEMA_VERSION;
+    record["timestamp"] = (long long)std::time(nullptr);
+    record["tool"] = tool;
+    record["build"] = {
+        {"git_hash", build.git_hash}, {"git_dirty", build.git_dirty}, {"compiler", build.compiler},
+        {"flags", build.flags}, {"build_type", build.build_type}
+    };
+    record["machine"] = {
+        {"cpu", cpuModel()}, {"logical_cpus", std::thread::hardware_concurrency()}, {"hostname", hostname}
+    };
+    record["config"] = config;
+    record["config_hash"] = configHash(config);
+    record["results"] = json::array();
+    for (const auto& r : results) {
+        record["results"].push_back({
+            {"op", r.op}, {"engine", r.engine}, {"threads", r.threads},
+            {"width", r.width}, {"height", r.height}, {"images", r.images},
+            {"se_shape", r.se_shape}, {"se_radius", r.se_radius}, {"batch", r.batch}, {"times_s", r.times}
+        });
+    }
+    return record;
+}
+
+bool appendRun(const std::string& path, const json& record) {
+    auto parent = std::filesystem::path(path).parent_path();
+    if (!parent.empty()) std::filesystem::create_directories(parent);
+    // Una sola scrittura per riga: esecuzioni concorrenti non mescolano le righe
+    std::string line = record.dump() + "\n";
+    std::ofstream out(path, std::ofstream::app | std::ofstream::binary);
+    if (!out) return false;
+    out.write(line.data(), line.size());
+    return (bool)out;
+}
+
+std::vector<json> loadRuns(const std::string& path) {
+    std::vector<json> runs;
+    std::ifstream in(path);
+    std::string line;
+    int line_number = 0;
+    while (std::getline(in, line)) {
+        line_number++;
+        if (line.empty()) continue;
+        try {
+            json record = json::parse(line);
+            if (record.value("schema", "") == "morphology-results") runs.push_back(std::move(record));
+        } catch (const json::exception&) {
+            // Riga troncata da un'esecuzione interrotta: si ignora e si prosegue
+            std::cerr << "Riga " << line_number << " di " << path << " non valida, ignorata" << std::endl;
+        }
+    }
+    return runs;
+}
+
+// Frazione continua della funzione beta incompleta (metodo di Lentz)
+static double betaContinuedFraction(double a, double b, double x) {
+    const double tiny = 1e-300;
+    double qab = a + b, qap = a + 1.0, qam = a - 1.0;
+    double c = 1.0, d = 1.0 - qab * x / qap;
+    if (std::fabs(d) < tiny) d = tiny;
+    d = 1.0 / d;
+    double h = d;
+    for (int m = 1; m <= 300; m++) {
+        int m2 = 2 * m;
+        double aa = m * (b - m) * x / ((qam + m2) * (a + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        h *= d * c;
+        aa = -(a + m) * (qab + m) * x / ((a + m2) * (qap + m2));
+        d = 1.0 + aa * d;
+        if (std::fabs(d) < tiny) d = tiny;
+        c = 1.0 + aa / c;
+        if (std::fabs(c) < tiny) c = tiny;
+        d = 1.0 / d;
+        double delta = d * c;
+        h *= delta;
+        if (std::fabs(delta - 1.0) < 1e-12) break;
+    }
+    return h;
+}
+
+// Funzione beta incompleta regolarizzata I_x(a, b)
+static double incompleteBeta(double a, double b, double x) {
+    if (x <= 0.0) return 0.0;
+    if (x >= 1.0) return 1.0;
+    double front = std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) + a * std::log(x) + b * std::log1p(-x));
+    if (x < (a + 1.0) / (a + b + 2.0)) {
+        return front * betaContinuedFraction(a, b, x) / a;
+    }
+    return 1.0 - front * betaContinuedFraction(b, a, 1.0 - x) / b;
+}
+
+// Probabilità che una t di Student con df gradi di libertà superi t
+static double studentUpperTail(double t, double df) {
+    if (std::isinf(t)) return t > 0 ? 0.0 : 1.0;
+    double tail = 0.5 * incompleteBeta(0.5 * df, 0.5, df / (df + t * t));
+    return t > 0 ? tail : 1.0 - tail;
+}
+
+WelchTest welchTest(const std::vector<double>& base, const std::vector<double>& candidate) {
+    WelchTest test;
+    auto meanVariance = [](const std::vector<double>& values, double& mean, double& variance) {
+        mean = 0.0;
+        for (double v : values) mean += v;
+        mean /= values.size();
+        variance = 0.0;
+        for (double v : values) variance += (v - mean) * (v - mean);
+        variance /= values.size() - 1;
+    };
+    if (base.size() < 2 || candidate.size() < 2) {
+        if (!base.empty() && !candidate.empty()) {
+            test.mean_base = base[0];
+            test.mean_candidate = candidate[0];
+            test.change = test.mean_base > 0 ? test.mean_candidate / test.mean_base - 1.0 : 0.0;
+        }
+        return test;
+    }
+
+    double var_base, var_candidate;
+    meanVariance(base, test.mean_base, var_base);
+    meanVariance(candidate, test.mean_candidate, var_candidate);
+    test.change = test.mean_base > 0 ? test.mean_candidate / test.mean_base - 1.0 : 0.0;
+
+    double nb = base.size(), nc = candidate.size();
+    double se_base = var_base / nb, se_candidate = var_candidate / nc;
+    double se2 = se_base + se_candidate;
+    double diff = test.mean_candidate - test.mean_base;
+    if (se2 <= 0.0) {
+        // Nessuna varianza: la differenza, se c'è, è certa
+        test.t = diff > 0 ? INFINITY : (diff < 0 ? -INFINITY : 0.0);
+        test.df = nb + nc - 2;
+    } else {
+        test.t = diff / std::sqrt(se2);
+        // Gradi di libertà di Welch–Satterthwaite
+        test.df = se2 * se2 / (se_base * se_base / (nb - 1) + se_candidate * se_candidate / (nc - 1));
+    }
+    test.p_slower = test.t == 0.0 ? 0.5 : studentUpperTail(test.t, test.df);
+    test.p_faster = test.t == 0.0 ? 0.5 : studentUpperTail(-test.t, test.df);
+    test.valid = true;
+    return test;
+}
+
+struct CompareOptions {
+    std::string store_path{"results/store.jsonl"};
+    std::string base{"prev"};       // prev, last, indice (negativo = dalla fine) o prefisso dell'hash git
+    std::string candidate{"last"};
+    double alpha{0.01};             // Livello di significatività del test a una coda
+    double min_change{0.03};        // Variazione relativa minima da segnalare
+    bool list{false};
+};
+
+// Funzione per scegliere un'esecuzione dell'archivio; exclude è l'indice da non restituire (-1 = nessuno)
+static int selectRun(const std::vector<json>& runs, const std::string& selector, int exclude, int reference) {
+    int n = runs.size();
+    if (selector == "last") return n - 1;
+    if (selector == "prev") {
+        // Esecuzione precedente con la stessa configurazione sulla stessa CPU
+        if (reference < 0) return -1;
+        const json& ref = runs[reference];
+        for (int i = reference - 1; i >= 0; i--) {
+            if (runs[i]["config_hash"] == ref["config_hash"] && runs[i]["machine"]["cpu"] == ref["machine"]["cpu"]) return i;
+        }
+        return -1;
+    }
+    bool numeric = !selector.empty() && selector.find_first_not_of("-0123456789") == std::string::npos;
+    if (numeric) {
+        int index = std::stoi(selector);
+        if (index < 0) index += n;
+        return index >= 0 && index < n ? index : -1;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        if (i == exclude) continue;
+        std::string hash = runs[i]["build"].value("git_hash", "");
+        if (hash.rfind(selector, 0) == 0) return i;
+    }
+    return -1;
+}
+
+static std::string describeRun(const json& run) {
+    std::ostringstream stream;
+    std::time_t timestamp = run.value("timestamp", 0LL);
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", std::localtime(&timestamp));
+    stream << date << "  " << run.value("tool", "?") << "  " << run["build"].value("git_hash", "?")
+           << (run["build"].value("git_dirty", false) ? "+" : "") << "  " << run["build"].value("compiler", "?")
+           << "  [" << run["build"].value("flags", "") << "]  " << run["machine"].value("cpu", "?")
+           << "  config " << run.value("config_hash", "?") << "  " << run["results"].size() << " misure";
+    return stream.str();
+}
+
+static std::string resultKey(const json& r) {
+    std::ostringstream stream;
+    stream << r.value("op", "") << "|" << r.value("engine", "") << "|" << r.value("threads", 0) << "|"
+           << r.value("width", 0) << "x" << r.value("height", 0) << "|" << r.value("images", 0) << "|"
+           << r.value("se_shape", "") << r.value("se_radius", 0) << "|" << (r.value("batch", false) ? "batch" : "single");
+    return stream.str();
+}
+
+static double median(std::vector<double> values) {
+    if (values.empty()) return NAN;
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : 0.5 * (values[n / 2 - 1] + values[n / 2]);
+}
+
+int runCompareCommand(int argc, char* argv[]) {
+    CompareOptions options;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--list") {
+            options.list = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--store") options.store_path = value;
+        else if (arg == "--base") options.base = value;
+        else if (arg == "--candidate") options.candidate = value;
+        else if (arg == "--alpha") options.alpha = std::stod(value);
+        else if (arg == "--min-change") options.min_change = std::stod(value);
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            std::cerr << "Uso: compare [--store PERCORSO] [--base SEL] [--candidate SEL] [--alpha P] [--min-change F] [--list]\n"
+                      << "  SEL: last, prev (precedente con stessa configurazione e CPU), indice o prefisso dell'hash git" << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<json> runs = loadRuns(options.store_path);
+    if (runs.empty()) {
+        std::cerr << "Nessuna esecuzione in " << options.store_path << std::endl;
+        return 2;
+    }
+    if (options.list) {
+        for (size_t i = 0; i < runs.size(); i++) {
+            std::cout << std::setw(4) << i << "  " << describeRun(runs[i]) << std::endl;
+        }
+        return 0;
+    }
+
+    int candidate = selectRun(runs, options.candidate, -1, -1);
+    int base = candidate < 0 ? -1 : selectRun(runs, options.base, candidate, candidate);
+    if (candidate < 0 || base < 0 || base == candidate) {
+        std::cerr << "Esecuzioni da confrontare non trovate (base " << options.base << ", candidato " << options.candidate << ")" << std::endl;
+        return 2;
+    }
+    const json& base_run = runs[base];
+    const json& candidate_run = runs[candidate];
+    std::cout << "Base      #" << base << "  " << describeRun(base_run) << std::endl;
+    std::cout << "Candidato #" << candidate << "  " << describeRun(candidate_run) << std::endl;
+    if (base_run["config_hash"] != candidate_run["config_hash"]) {
+        std::cout << "Attenzione: configurazioni diverse, si confrontano solo le misure con la stessa chiave" << std::endl;
+    }
+    if (base_run["machine"]["cpu"] != candidate_run["machine"]["cpu"]) {
+        std::cout << "Attenzione: CPU diverse" << std::endl;
+    }
+
+    std::map<std::string, const json*> base_results;
+    for (const auto& r : base_run["results"]) base_results[resultKey(r)] = &r;
+
+    std::cout << std::left << std::setw(10) << "op" << std::setw(13) << "versione" << std::setw(4) << "thr"
+              << std::setw(11) << "dimensione" << std::setw(9) << "se" << std::setw(7) << "modo"
+              << std::right << std::setw(7) << "n" << std::setw(13) << "base (s)" << std::setw(13) << "cand. (s)"
+              << std::setw(9) << "var." << std::setw(11) << "p" << "  esito" << std::endl;
+
+    int slower = 0, faster = 0, compared = 0, untested = 0;
+    for (const auto& r : candidate_run["results"]) {
+        auto it = base_results.find(resultKey(r));
+        if (it == base_results.end()) continue;
+        const json& b = *it->second;
+        std::vector<double> base_times = b["times_s"].get<std::vector<double>>();
+        std::vector<double> candidate_times = r["times_s"].get<std::vector<double>>();
+        WelchTest test = welchTest(base_times, candidate_times);
+        compared++;
+
+        std::string verdict = "=";
+        double p = NAN;
+        if (!test.valid) {
+            verdict = "non testabile (1 ripetizione)";
+            untested++;
+        } else if (test.change > options.min_change && test.p_slower < options.alpha) {
+            verdict = "RALLENTAMENTO";
+            p = test.p_slower;
+            slower++;
+        } else if (test.change < -options.min_change && test.p_faster < options.alpha) {
+            verdict = "miglioramento";
+            p = test.p_faster;
+            faster++;
+        } else {
+            p = test.change > 0 ? test.p_slower : test.p_faster;
+        }
+
+        std::ostringstream size, se;
+        size << r.value("width", 0) << "x" << r.value("height", 0);
+        se << r.value("se_shape", "") << r.value("se_radius", 0);
+        std::cout << std::left << std::setw(10) << r.value("op", "") << std::setw(13) << r.value("engine", "")
+                  << std::setw(4) << r.value("threads", 0) << std::setw(11) << size.str() << std::setw(9) << se.str()
+                  << std::setw(7) << (r.value("batch", false) ? "batch" : "single") << std::right
+                  << std::setw(7) << (std::to_string(base_times.size()) + "/" + std::to_string(candidate_times.size()))
+                  << std::setw(13) << std::setprecision(5) << median(base_times)
+                  << std::setw(13) << median(candidate_times)
+                  << std::setw(8) << std::fixed << std::setprecision(1) << test.change * 100 << "%"
+                  << std::setw(11) << std::scientific << std::setprecision(2) << p << std::defaultfloat
+                  << "  " << verdict << std::endl;
+    }
+
+    std::cout << compared << " misure confrontate: " << slower << " rallentamenti e " << faster
+              << " miglioramenti significativi (alpha " << options.alpha << ", variazione minima "
+              << options.min_change * 100 << "%)";
+    if (untested > 0) std::cout << ", " << untested << " senza ripetizioni sufficienti";
+    std::cout << std::endl;
+    // Codice di uscita 1 se c'è almeno un rallentamento significativo
+    return slower > 0 ? 1 : 0;
+}
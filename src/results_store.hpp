@@ -0,0 +1,64 @@
+#ifndef MORPHOLOGY_RESULTS_STORE_HPP
+#define MORPHOLOGY_RESULTS_STORE_HPP
+
+#include "image.hpp"
+
+// ARCHIVIO DEI RISULTATI
+//
+// I CSV in results/<dimensione>_<forma><raggio>/ vengono sovrascritti a ogni esecuzione. L'archivio è
+// invece un file JSON-lines in sola aggiunta: ogni riga è un'esecuzione completa con hash git,
+// compilatore, flag, CPU e configurazione, e per ogni misura i tempi di tutte le ripetizioni.
+// Il comando "compare" confronta due esecuzioni misura per misura (versione, operazione, thread, ...)
+// con un test t di Welch sui tempi delle ripetizioni: un rallentamento viene segnalato solo se è
+// statisticamente significativo e supera una variazione minima, per non scambiare il rumore per
+// una regressione.
+
+const int RESULTS_STORE_SCHEMA_VERSION = 1;
+
+// Build che ha prodotto i risultati (generata da cmake/BuildInfo.cmake)
+struct BuildInfo {
+    std::string git_hash;
+    bool git_dirty{false};
+    std::string compiler, flags, build_type;
+};
+
+BuildInfo buildInfo();
+
+// Funzione per leggere il modello della CPU da /proc/cpuinfo ("unknown" se non disponibile)
+std::string cpuModel();
+
+// Misura da archiviare: identificata da (operazione, versione, thread, dimensione, elemento strutturante, batch)
+struct StoredResult {
+    std::string op, engine;
+    int threads{1}, width{0}, height{0}, images{0};
+    std::string se_shape;
+    int se_radius{0};
+    bool batch{false};          // Funzione _imgvec sull'intero vettore invece del ciclo immagine per immagine
+    std::vector<double> times;  // Secondi per ripetizione
+};
+
+// Funzione per costruire la riga di un'esecuzione
+json makeRunRecord(const std::string& tool, const json& config, const std::vector<StoredResult>& results);
+
+// Funzione per aggiungere un'esecuzione in fondo all'archivio (crea il file e le cartelle se mancano)
+bool appendRun(const std::string& path, const json& record);
+
+// Funzione per leggere tutte le esecuzioni dell'archivio, ignorando le righe non valide
+std::vector<json> loadRuns(const std::string& path);
+
+// Test t di Welch a una coda: il candidato è più lento del riferimento?
+struct WelchTest {
+    double mean_base{0}, mean_candidate{0};
+    double change{0};           // mean_candidate / mean_base - 1
+    double t{0}, df{0};
+    double p_slower{1};         // p-value di "candidato più lento"
+    double p_faster{1};         // p-value di "candidato più veloce"
+    bool valid{false};          // Servono almeno due ripetizioni per parte
+};
+
+WelchTest welchTest(const std::vector<double>& base, const std::vector<double>& candidate);
+
+// Funzione per leggere le opzioni di "compare" da riga di comando ed eseguire il confronto
+int runCompareCommand(int argc, char* argv[]);
+
+#endif // MORPHOLOGY_RESULTS_STORE_HPP
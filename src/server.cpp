@@ -0,0 +1,1094 @@
+#include "server.hpp"
+
+#include "morphology.hpp"
+#include "kernel_registry.hpp"
+#include "generator.hpp"
+#include "shm_transport.hpp"
+#include "morpho_c.h"
+
+#include <omp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <poll.h>
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iomanip>
+#include <map>
+#include <thread>
+
+using ServerClock = std::chrono::steady_clock;
+
+static double elapsedUs(ServerClock::time_point from, ServerClock::time_point to) {
+    return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+// ISTOGRAMMA DELLE LATENZE
+
+LatencyHistogram::LatencyHistogram() {
+    for (auto& bucket : buckets) bucket.store(0, std::memory_order_relaxed);
+}
+
+// Bucket i: latenze in [2^((i-1)/4), 2^(i/4)) microsecondi, il bucket 0 raccoglie quelle sotto 1 us
+static int bucketIndex(double us) {
+    if (us < 1.0) return 0;
+    return std::min((int)(4.0 * std::log2(us)) + 1, LatencyHistogram::BUCKETS - 1);
+}
+
+static double bucketUpper(int index) {
+    return std::exp2(index / 4.0);
+}
+
+void LatencyHistogram::record(double us) {
+    buckets[bucketIndex(us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    uint64_t ns = (uint64_t)std::max(us * 1000.0, 0.0);
+    sum_ns.fetch_add(ns, std::memory_order_relaxed);
+    uint64_t current = max_ns.load(std::memory_order_relaxed);
+    while (ns > current && !max_ns.compare_exchange_weak(current, ns, std::memory_order_relaxed)) {}
+}
+
+double LatencyHistogram::percentile(double p) const {
+    uint64_t n = count();
+    if (n == 0) return 0.0;
+    uint64_t target = std::max<uint64_t>(1, (uint64_t)std::ceil(p / 100.0 * n)), seen = 0;
+    double max_us = max_ns.load(std::memory_order_relaxed) / 1000.0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += buckets[i].load(std::memory_order_relaxed);
+        if (seen >= target) return std::min(bucketUpper(i), max_us);
+    }
+    return max_us;
+}
+
+json LatencyHistogram::toJson() const {
+    uint64_t n = count();
+    json histogram = json::array();
+    for (int i = 0; i < BUCKETS; i++) {
+        uint64_t c = buckets[i].load(std::memory_order_relaxed);
+        if (c > 0) histogram.push_back({bucketUpper(i), c});
+    }
+    return {
+        {"count", n}, {"mean_us", n ? sum_ns.load(std::memory_order_relaxed) / 1000.0 / n : 0.0},
+        {"max_us", max_ns.load(std::memory_order_relaxed) / 1000.0},
+        {"p50_us", percentile(50)}, {"p90_us", percentile(90)}, {"p99_us", percentile(99)}, {"p999_us", percentile(99.9)},
+        {"buckets", histogram}    // [limite superiore in us, conteggio]
+    };
+}
+
+// TRASPORTO DEI MESSAGGI
+// Le lunghezze sono nell'ordine dei byte della macchina: client e server sono sullo stesso host
+
+static bool writeAll(int fd, const void* data, size_t size) {
+    const char* p = (const char*)data;
+    while (size > 0) {
+        ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool readExact(int fd, void* dst, size_t size) {
+    char* p = (char*)dst;
+    while (size > 0) {
+        ssize_t n = recv(fd, p, size, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        size -= n;
+    }
+    return true;
+}
+
+bool writeMessage(int fd, const json& header, const uint8_t* data, size_t size) {
+    std::string text = header.dump();
+    uint32_t header_size = text.size();
+    uint64_t data_size = size;
+    std::string message(sizeof(header_size) + sizeof(data_size), '\0');
+    std::memcpy(&message[0], &header_size, sizeof(header_size));
+    std::memcpy(&message[sizeof(header_size)], &data_size, sizeof(data_size));
+    message += text;
+    return writeAll(fd, message.data(), message.size()) && (size == 0 || writeAll(fd, data, size));
+}
+
+bool readMessageHeader(int fd, json& header, uint64_t& data_size) {
+    uint32_t header_size = 0;
+    if (!readExact(fd, &header_size, sizeof(header_size)) || !readExact(fd, &data_size, sizeof(data_size))) return false;
+    if (header_size > (16u << 20)) return false;
+    std::string text(header_size, '\0');
+    if (!readExact(fd, &text[0], header_size)) return false;
+    header = json::parse(text, nullptr, false);
+    return !header.is_discarded();
+}
+
+int connectToServer(const std::string& socket_path) {
+    sockaddr_un address{};
+    if (socket_path.size() >= sizeof(address.sun_path)) return -1;
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, socket_path.c_str());
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// POOL DI BUFFER
+// I buffer sono allocati con trackedMalloc come quelli di STBImage: un'immagine può prenderne uno come
+// image_data e restituirlo al pool invece di liberarlo
+
+class BufferPool {
+public:
+    explicit BufferPool(size_t max_bytes) : max_bytes(max_bytes) {}
+
+    ~BufferPool() {
+        for (auto& [size, list] : free_buffers) {
+            for (uint8_t* buffer : list) trackedFree(buffer);
+        }
+    }
+
+    uint8_t* acquire(size_t size) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = free_buffers.find(size);
+            if (it != free_buffers.end() && !it->second.empty()) {
+                uint8_t* buffer = it->second.back();
+                it->second.pop_back();
+                held -= size;
+                hits++;
+                return buffer;
+            }
+            misses++;
+        }
+        return (uint8_t*)trackedMalloc(size);
+    }
+
+    void release(uint8_t* buffer, size_t size) {
+        if (!buffer) return;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (held + size <= max_bytes) {
+                free_buffers[size].push_back(buffer);
+                held += size;
+                return;
+            }
+        }
+        trackedFree(buffer);
+    }
+
+    // Restituisce al pool i pixel di un'immagine allocati con trackedMalloc
+    void recycle(STBImage& img) {
+        if (img.image_data && !img.mapping && !img.allocated_with_stb) {
+            release(img.image_data, (size_t)img.width * img.height * std::max(img.channels, 1));
+            img.image_data = nullptr;
+        }
+        img.freeImage();
+    }
+
+    json stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return {{"held_bytes", held}, {"max_bytes", max_bytes}, {"hits", hits}, {"misses", misses}};
+    }
+
+private:
+    std::mutex mutex;
+    std::map<size_t, std::vector<uint8_t*>> free_buffers;
+    size_t max_bytes, held{0};
+    uint64_t hits{0}, misses{0};
+};
+
+// SERVER
+
+struct Connection {
+    int fd;
+    std::mutex write_mutex;     // Risposte dal thread di smistamento e dal thread della connessione
+    std::atomic<bool> closed{false};
+};
+
+struct Job {
+    std::shared_ptr<Connection> connection;
+    json id;
+    std::vector<std::string> ops;
+    std::string mode, shape;
+    int radius{0};
+    const StructuringElement* se{nullptr};  // Dalla cache del server, valido fino allo spegnimento
+    std::string output_path;
+    STBImage image;
+    ServerClock::time_point arrival;
+};
+
+// Thread di una connessione o di un segmento: finished si imposta all'uscita, così il thread di
+// accettazione può raccogliere i thread terminati senza attendere lo spegnimento
+struct ServerThread {
+    std::thread thread;
+    std::shared_ptr<std::atomic<bool>> finished;
+};
+
+// Funzione per avviare un thread che segnala la propria uscita
+template <typename F>
+static ServerThread startServerThread(F body) {
+    ServerThread entry;
+    entry.finished = std::make_shared<std::atomic<bool>>(false);
+    entry.thread = std::thread([body = std::move(body), finished = entry.finished]() mutable {
+        body();
+        finished->store(true, std::memory_order_release);
+    });
+    return entry;
+}
+
+// Funzione per attendere e rimuovere i thread già terminati
+static void reapServerThreads(std::vector<ServerThread>& threads) {
+    auto done = std::partition(threads.begin(), threads.end(),
+        [](const ServerThread& entry) { return !entry.finished->load(std::memory_order_acquire); });
+    for (auto it = done; it != threads.end(); ++it) it->thread.join();
+    threads.erase(done, threads.end());
+}
+
+// Risposta con "output" in attesa del salvataggio su file
+struct PendingSave {
+    std::shared_ptr<Connection> connection;
+    json header;
+    std::string output_path;
+    STBImage result;
+    ServerClock::time_point arrival;
+    double queue_us{0};
+};
+
+static std::atomic<bool> signal_stop{false};
+
+static void handleStopSignal(int) {
+    signal_stop = true;
+}
+
+class MorphologyServer {
+public:
+    explicit MorphologyServer(const ServerOptions& options)
+        : options(options), pool(options.pool_bytes), start(ServerClock::now()) {}
+
+    int run();
+
+private:
+    void connectionLoop(std::shared_ptr<Connection> connection);
+    std::string parseJob(const json& header, uint8_t* data, uint64_t size, Job& job);
+    void dispatcherLoop();
+    void processBatch(std::vector<Job>& batch);
+    const StructuringElement& structuringElement(const std::string& shape, int radius);
+    void respond(Job& job, STBImage& result, size_t batch_size, double queue_us, double compute_us);
+    void respondError(const std::shared_ptr<Connection>& connection, const json& id, const std::string& error);
+    void saveLoop();
+    void recordResponse(ServerClock::time_point arrival, double queue_us);
+    void recordRequest(const Job& job, const json& header);
+    void shmWorkerLoop(std::shared_ptr<ShmSegment> segment, std::shared_ptr<Connection> connection);
+    int processShmRequest(const ShmSegment& segment, const ShmRequest& request,
+        std::map<std::pair<int, int>, morpho_se*>& se_cache, std::vector<uint8_t>& scratch);
+    json stats();
+
+    ServerOptions options;
+    BufferPool pool;
+    ServerClock::time_point start;
+    std::atomic<bool> stopping{false};
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::deque<Job> queue;
+    bool dispatcher_ready{false};
+    int dispatcher_threads{1};
+
+    // Riempita dai thread delle connessioni durante la convalida: gli elementi non si rimuovono, quindi i
+    // riferimenti restituiti restano validi senza tenere il mutex
+    std::mutex se_mutex;
+    std::map<std::string, StructuringElement> se_cache;
+    std::atomic<uint64_t> se_hits{0}, se_misses{0};
+
+    std::mutex stats_mutex;
+    uint64_t requests{0}, errors{0}, batches{0};
+    std::vector<uint64_t> batch_sizes;
+    LatencyHistogram queue_latency, compute_latency, total_latency;
+
+    std::mutex record_mutex;
+    std::ofstream record;
+
+    // Segmenti condivisi: un thread per segmento, che calcola direttamente nell'area dati
+    std::mutex shm_mutex;
+    std::vector<ServerThread> shm_workers;
+    uint64_t shm_segments{0}, shm_requests{0}, shm_errors{0};     // Protetti da stats_mutex
+    LatencyHistogram shm_compute_latency;
+
+    // Salvataggi delle risposte con "output" in un thread dedicato: il thread di smistamento non attende
+    // il disco e la risposta parte a file scritto, senza tenere write_mutex durante la scrittura
+    std::mutex save_mutex;
+    std::condition_variable save_cv;
+    std::deque<PendingSave> saves;
+    bool saves_closed{false};
+};
+
+int MorphologyServer::run() {
+    sockaddr_un address{};
+    if (options.socket_path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Percorso del socket troppo lungo: " << options.socket_path << std::endl;
+        return 1;
+    }
+    address.sun_family = AF_UNIX;
+    std::strcpy(address.sun_path, options.socket_path.c_str());
+    int listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(options.socket_path.c_str());
+    if (listen_fd < 0 || bind(listen_fd, (sockaddr*)&address, sizeof(address)) != 0 || listen(listen_fd, 64) != 0) {
+        std::cerr << "Impossibile aprire il socket " << options.socket_path << ": " << std::strerror(errno) << std::endl;
+        if (listen_fd >= 0) close(listen_fd);
+        return 1;
+    }
+    if (!options.record_path.empty()) {
+        record.open(options.record_path, std::ofstream::app);
+        if (!record) std::cerr << "Impossibile scrivere la traccia " << options.record_path << std::endl;
+    }
+    batch_sizes.assign(options.max_batch + 1, 0);
+
+    // Il thread di smistamento avvia il runtime OpenMP e calibra il modello di costo prima di accettare richieste
+    std::thread dispatcher([this] { dispatcherLoop(); });
+    std::thread saver([this] { saveLoop(); });
+    {
+        std::unique_lock<std::mutex> lock(queue_mutex);
+        queue_cv.wait(lock, [this] { return dispatcher_ready; });
+    }
+    std::cout << "Server in ascolto su " << options.socket_path << " (" << dispatcher_threads << " thread, batch fino a "
+              << options.max_batch << " richieste in " << options.batch_us << " us)" << std::endl;
+
+    signal_stop = false;
+    std::signal(SIGINT, handleStopSignal);
+    std::signal(SIGTERM, handleStopSignal);
+
+    std::vector<ServerThread> connection_threads;
+    std::vector<std::weak_ptr<Connection>> connections;
+    while (!stopping && !signal_stop) {
+        // Ad ogni risveglio (al più ogni 200 ms) si raccolgono i thread delle connessioni chiuse
+        reapServerThreads(connection_threads);
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+            [](const std::weak_ptr<Connection>& weak) { return weak.expired(); }), connections.end());
+        {
+            std::lock_guard<std::mutex> shm_lock(shm_mutex);
+            reapServerThreads(shm_workers);
+        }
+
+        pollfd listen_poll{listen_fd, POLLIN, 0};
+        if (poll(&listen_poll, 1, 200) <= 0) continue;
+        int fd = accept(listen_fd, nullptr, nullptr);
+        if (fd < 0) continue;
+        auto connection = std::make_shared<Connection>();
+        connection->fd = fd;
+        connections.push_back(connection);
+        connection_threads.push_back(startServerThread([this, connection] { connectionLoop(connection); }));
+    }
+
+    // Arresto: le letture bloccate delle connessioni terminano con shutdown, il thread di smistamento svuota la coda
+    stopping = true;
+    close(listen_fd);
+    unlink(options.socket_path.c_str());
+    for (auto& weak : connections) {
+        if (auto connection = weak.lock()) {
+            std::lock_guard<std::mutex> lock(connection->write_mutex);
+            if (connection->fd >= 0) shutdown(connection->fd, SHUT_RD);
+        }
+    }
+    for (auto& entry : connection_threads) entry.thread.join();
+    for (auto& entry : shm_workers) entry.thread.join();
+    queue_cv.notify_all();
+    dispatcher.join();
+    {
+        std::lock_guard<std::mutex> lock(save_mutex);
+        saves_closed = true;
+    }
+    save_cv.notify_all();
+    saver.join();
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+
+    json summary = stats();
+    std::cout << "Server arrestato: " << summary["requests"] << " richieste, " << summary["errors"] << " errori, "
+              << summary["batches"] << " batch" << std::endl;
+    std::cout << "Latenza totale p50 " << summary["total"]["p50_us"] << " us, p99 " << summary["total"]["p99_us"]
+              << " us, max " << summary["total"]["max_us"] << " us" << std::endl;
+    return 0;
+}
+
+void MorphologyServer::connectionLoop(std::shared_ptr<Connection> connection) {
+    json header;
+    uint64_t size = 0;
+    while (readMessageHeader(connection->fd, header, size)) {
+        uint8_t* data = size > 0 ? pool.acquire(size) : nullptr;
+        if (size > 0 && (!data || !readExact(connection->fd, data, size))) {
+            pool.release(data, size);
+            break;
+        }
+        json id = header.contains("id") ? header["id"] : json(nullptr);
+
+        std::string cmd = header.contains("cmd") && header["cmd"].is_string() ? header["cmd"].get<std::string>() : "";
+        if (!cmd.empty()) {
+            pool.release(data, size);
+            std::lock_guard<std::mutex> lock(connection->write_mutex);
+            if (cmd == "stats") writeMessage(connection->fd, {{"id", id}, {"status", "ok"}, {"stats", stats()}});
+            else if (cmd == "ping") writeMessage(connection->fd, {{"id", id}, {"status", "ok"}});
+            else if (cmd == "attach_shm") {
+                // Il descrittore del segmento segue il messaggio come un byte con SCM_RIGHTS
+                std::string error;
+                auto segment = std::make_shared<ShmSegment>();
+                int fd = receiveFd(connection->fd);
+                if (fd < 0) error = "descrittore del segmento non ricevuto";
+                else segment->attach(fd, error);
+                if (error.empty()) {
+                    std::lock_guard<std::mutex> shm_lock(shm_mutex);
+                    shm_workers.push_back(startServerThread([this, segment, connection] { shmWorkerLoop(segment, connection); }));
+                    writeMessage(connection->fd, {{"id", id}, {"status", "ok"}});
+                } else {
+                    writeMessage(connection->fd, {{"id", id}, {"status", "error"}, {"error", error}});
+                }
+            }
+            else if (cmd == "shutdown") {
+                stopping = true;
+                writeMessage(connection->fd, {{"id", id}, {"status", "ok"}});
+            } else {
+                writeMessage(connection->fd, {{"id", id}, {"status", "error"}, {"error", "comando sconosciuto: " + cmd}});
+            }
+            continue;
+        }
+
+        Job job;
+        job.arrival = ServerClock::now();
+        job.connection = connection;
+        job.id = id;
+        std::string error = parseJob(header, data, size, job);
+        if (job.image.image_data != data) pool.release(data, size);
+        if (!error.empty()) {
+            respondError(connection, id, error);
+            continue;
+        }
+        recordRequest(job, header);
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            queue.push_back(std::move(job));
+        }
+        queue_cv.notify_one();
+    }
+    connection->closed = true;
+    std::lock_guard<std::mutex> lock(connection->write_mutex);
+    close(connection->fd);
+    connection->fd = -1;
+}
+
+void MorphologyServer::shmWorkerLoop(std::shared_ptr<ShmSegment> segment, std::shared_ptr<Connection> connection) {
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        shm_segments++;
+    }
+    ShmHeader* header = segment->header();
+    std::map<std::pair<int, int>, morpho_se*> se_cache;
+    std::vector<uint8_t> scratch;
+    // Il segmento resta valido finché il client non lo chiude o la sua connessione non cade
+    while (!stopping && !connection->closed && !header->closing.load(std::memory_order_acquire)) {
+        ShmRequest request;
+        if (!header->requests.pop(request)) {
+            header->requests.wait(options.shm_spin >= 0 ? options.shm_spin : defaultShmSpin(), 100);
+            continue;
+        }
+        auto start = ServerClock::now();
+        int status = processShmRequest(*segment, request, se_cache, scratch);
+        uint64_t compute_ns = (uint64_t)(elapsedUs(start, ServerClock::now()) * 1000.0);
+        ShmCompletion completion{request.id, status, 0, compute_ns};
+        while (!header->completions.push(completion)) {
+            if (stopping || connection->closed || header->closing.load()) break;
+            std::this_thread::yield();
+        }
+        shm_compute_latency.record(compute_ns / 1000.0);
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        shm_requests++;
+        if (status != MORPHO_OK) shm_errors++;
+    }
+    for (auto& [key, se] : se_cache) morpho_se_destroy(se);
+}
+
+// Funzione per elaborare una richiesta del segmento: le operazioni scrivono nei buffer del segmento, una
+// catena alterna uscita e buffer di appoggio in modo che l'ultima operazione scriva nell'uscita
+int MorphologyServer::processShmRequest(const ShmSegment& segment, const ShmRequest& request,
+    std::map<std::pair<int, int>, morpho_se*>& se_cache, std::vector<uint8_t>& scratch) {
+    const auto& shapes = availableStructuringElementShapes();
+    if (request.op_count == 0 || request.op_count > SHM_MAX_OPS || request.shape >= shapes.size() ||
+        request.radius < 0 || request.radius > 1024 ||
+        !segment.contains(request.input_offset, request.width, request.height, request.stride) ||
+        !segment.contains(request.output_offset, request.width, request.height, request.stride)) {
+        return MORPHO_ERROR_INVALID_ARGUMENT;
+    }
+    for (int i = 0; i < request.op_count; i++) {
+        if (request.ops[i] > MORPHO_CLOSING) return MORPHO_ERROR_INVALID_ARGUMENT;
+    }
+
+    morpho_se*& se = se_cache[{request.shape, request.radius}];
+    if (!se) {
+        int status = morpho_se_create_shape(shapes[request.shape].c_str(), request.radius, &se);
+        if (status != MORPHO_OK) return status;
+    }
+
+    const uint8_t* src = segment.base + request.input_offset;
+    ptrdiff_t src_stride = request.stride;
+    if (request.op_count > 1) scratch.resize((size_t)request.width * request.height);
+    for (int i = 0; i < request.op_count; i++) {
+        bool to_output = (request.op_count - 1 - i) % 2 == 0;
+        uint8_t* dst = to_output ? segment.base + request.output_offset : scratch.data();
+        ptrdiff_t dst_stride = to_output ? request.stride : request.width;
+        morpho_image image{src, src_stride, dst, dst_stride, request.width, request.height};
+        int status = morpho_apply(se, (morpho_op)request.ops[i], &image, request.border, options.threads);
+        if (status != MORPHO_OK) return status;
+        src = dst;
+        src_stride = dst_stride;
+    }
+    return MORPHO_OK;
+}
+
+// Funzione per convalidare una richiesta; restituisce il motivo dell'errore o una stringa vuota
+std::string MorphologyServer::parseJob(const json& header, uint8_t* data, uint64_t size, Job& job) {
+    try {
+        if (header.contains("ops")) job.ops = header["ops"].get<std::vector<std::string>>();
+        else if (header.contains("op")) job.ops = {header["op"].get<std::string>()};
+        if (job.ops.empty()) return "nessuna operazione richiesta";
+        for (const auto& op : job.ops) {
+            if (operationIndex(op) < 0) return "operazione non valida: " + op;
+        }
+        job.mode = header.value("mode", options.default_mode);
+        if (job.mode != "auto" && !findKernel(job.mode)) return "versione non valida: " + job.mode;
+
+        job.shape = options.default_shape;
+        job.radius = options.default_radius;
+        if (header.contains("se")) {
+            job.shape = header["se"].value("shape", job.shape);
+            job.radius = header["se"].value("radius", job.radius);
+        }
+        const auto& shapes = availableStructuringElementShapes();
+        if (std::find(shapes.begin(), shapes.end(), job.shape) == shapes.end()) return "forma non valida: " + job.shape;
+        if (job.shape == "mask") return "forma non valida: mask richiede un file, qui le forme dipendono solo dal raggio";
+        if (job.radius < 0 || job.radius > 1024) return "raggio non valido: " + std::to_string(job.radius);
+
+        const json& image = header.contains("image") ? header["image"] : json::object();
+        if (image.contains("path")) {
+            std::string path = image["path"].get<std::string>();
+            if (!job.image.loadImage(path)) return "impossibile leggere " + path;
+            binarizePixels(job.image.image_data, (size_t)job.image.width * job.image.height);
+        } else {
+            int width = image.value("width", 0), height = image.value("height", 0);
+            if (width <= 0 || height <= 0 || (uint64_t)width * height != size) {
+                return "dimensioni dell'immagine non coerenti con i dati (" + std::to_string(width) + "x" +
+                    std::to_string(height) + ", " + std::to_string(size) + " byte)";
+            }
+            // I pixel ricevuti diventano l'immagine senza copie
+            job.image.width = width;
+            job.image.height = height;
+            job.image.channels = 1;
+            job.image.image_data = data;
+            binarizePixels(data, size);
+        }
+        job.se = &structuringElement(job.shape, job.radius);
+        if (job.se->width > job.image.width || job.se->height > job.image.height) {
+            return "elemento strutturante più grande dell'immagine";
+        }
+        if (header.contains("output")) job.output_path = header["output"].value("path", "");
+    } catch (const json::exception& e) {
+        return std::string("richiesta non valida: ") + e.what();
+    }
+    return "";
+}
+
+void MorphologyServer::recordRequest(const Job& job, const json& header) {
+    if (!record.is_open()) return;
+    json line = {
+        {"t_us", (long long)elapsedUs(start, job.arrival)}, {"ops", job.ops}, {"mode", job.mode},
+        {"se", {{"shape", job.shape}, {"radius", job.radius}}},
+        {"width", job.image.width}, {"height", job.image.height}
+    };
+    if (header.contains("image") && header["image"].contains("path")) line["path"] = header["image"]["path"];
+    std::lock_guard<std::mutex> lock(record_mutex);
+    record << line.dump() << "\n";
+    record.flush();
+}
+
+const StructuringElement& MorphologyServer::structuringElement(const std::string& shape, int radius) {
+    std::string key = shape + ":" + std::to_string(radius);
+    std::lock_guard<std::mutex> lock(se_mutex);
+    auto it = se_cache.find(key);
+    if (it != se_cache.end()) {
+        se_hits++;
+        return it->second;
+    }
+    se_misses++;
+    return se_cache.emplace(key, makeStructuringElement({shape, radius})).first->second;
+}
+
+void MorphologyServer::dispatcherLoop() {
+    if (options.threads > 0) omp_set_num_threads(options.threads);
+    // La squadra OpenMP appartiene a questo thread: la prima regione parallela la crea e resta attiva
+    #pragma omp parallel
+    {
+        TraceScope warmup_trace("warmup", "stage");
+    }
+    calibrateKernels();
+    structuringElement(options.default_shape, options.default_radius);
+    {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        dispatcher_threads = omp_get_max_threads();
+        dispatcher_ready = true;
+    }
+    queue_cv.notify_all();
+
+    while (true) {
+        std::vector<Job> batch;
+        {
+            std::unique_lock<std::mutex> lock(queue_mutex);
+            queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;
+            // Finestra di raccolta dalla prima richiesta in coda: altre richieste, anche di altri client
+            auto deadline = queue.front().arrival + std::chrono::microseconds(options.batch_us);
+            queue_cv.wait_until(lock, deadline, [this] { return stopping || (int)queue.size() >= options.max_batch; });
+            while (!queue.empty() && (int)batch.size() < options.max_batch) {
+                batch.push_back(std::move(queue.front()));
+                queue.pop_front();
+            }
+        }
+        processBatch(batch);
+    }
+}
+
+void MorphologyServer::processBatch(std::vector<Job>& batch) {
+    TraceScope batch_trace("batch", "stage");
+    auto batch_start = ServerClock::now();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        batches++;
+        batch_sizes[batch.size()]++;
+    }
+
+    // Gruppi con le stesse operazioni, versione ed elemento strutturante
+    std::map<std::string, std::vector<size_t>> groups;
+    for (size_t i = 0; i < batch.size(); i++) {
+        std::string key = batch[i].mode + "|" + batch[i].shape + ":" + std::to_string(batch[i].radius);
+        for (const auto& op : batch[i].ops) key += "|" + op;
+        groups[key].push_back(i);
+    }
+
+    for (const auto& [key, members] : groups) {
+        const Job& first = batch[members.front()];
+        const StructuringElement& se = *first.se;
+        std::vector<STBImage> images;
+        for (size_t k = 0; k < members.size(); k++) {
+            images.push_back(std::move(batch[members[k]].image));
+            images.back().filename = "job_" + std::to_string(k);
+        }
+
+        auto compute_start = ServerClock::now();
+        std::string error;
+        try {
+            for (const auto& op : first.ops) {
+                if (images.size() == 1) {
+                    // Una sola immagine: la versione parallela divide le righe invece delle immagini
+                    STBImage next = applyOperation(images[0], se, op, first.mode, options.tile_size, options.background);
+                    pool.recycle(images[0]);
+                    images[0] = std::move(next);
+                    continue;
+                }
+                auto results = applyOperationImgVec(images, se, op, first.mode, options.tile_size, options.background);
+                for (auto& img : images) {
+                    STBImage next = std::move(results[img.filename]);
+                    next.filename = img.filename;
+                    pool.recycle(img);
+                    img = std::move(next);
+                }
+            }
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        double compute_us = elapsedUs(compute_start, ServerClock::now());
+        compute_latency.record(compute_us);
+
+        for (size_t k = 0; k < members.size(); k++) {
+            Job& job = batch[members[k]];
+            if (!error.empty()) respondError(job.connection, job.id, error);
+            else respond(job, images[k], members.size(), elapsedUs(job.arrival, batch_start), compute_us);
+            pool.recycle(images[k]);
+        }
+    }
+}
+
+void MorphologyServer::respond(Job& job, STBImage& result, size_t batch_size, double queue_us, double compute_us) {
+    json header = {
+        {"id", job.id}, {"status", "ok"}, {"width", result.width}, {"height", result.height},
+        {"batch_size", batch_size}, {"queue_us", queue_us}, {"compute_us", compute_us},
+        {"server_us", elapsedUs(job.arrival, ServerClock::now())}
+    };
+    if (!job.output_path.empty()) {
+        // Il risultato passa al thread di salvataggio, che lo restituisce al pool
+        {
+            std::lock_guard<std::mutex> lock(save_mutex);
+            saves.push_back({job.connection, std::move(header), job.output_path, std::move(result), job.arrival, queue_us});
+        }
+        save_cv.notify_one();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(job.connection->write_mutex);
+        if (job.connection->fd >= 0) {
+            writeMessage(job.connection->fd, header, result.image_data, (size_t)result.width * result.height);
+        }
+    }
+    recordResponse(job.arrival, queue_us);
+}
+
+void MorphologyServer::saveLoop() {
+    while (true) {
+        PendingSave save;
+        {
+            std::unique_lock<std::mutex> lock(save_mutex);
+            save_cv.wait(lock, [this] { return saves_closed || !saves.empty(); });
+            if (saves.empty()) return;
+            save = std::move(saves.front());
+            saves.pop_front();
+        }
+        bool saved = save.result.saveImage(save.output_path);
+        pool.recycle(save.result);
+        if (!saved) {
+            respondError(save.connection, save.header["id"], "impossibile scrivere " + save.output_path);
+            continue;
+        }
+        save.header["output"] = save.output_path;
+        {
+            std::lock_guard<std::mutex> lock(save.connection->write_mutex);
+            if (save.connection->fd >= 0) writeMessage(save.connection->fd, save.header);
+        }
+        recordResponse(save.arrival, save.queue_us);
+    }
+}
+
+void MorphologyServer::recordResponse(ServerClock::time_point arrival, double queue_us) {
+    queue_latency.record(queue_us);
+    total_latency.record(elapsedUs(arrival, ServerClock::now()));
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    requests++;
+}
+
+void MorphologyServer::respondError(const std::shared_ptr<Connection>& connection, const json& id, const std::string& error) {
+    {
+        std::lock_guard<std::mutex> lock(connection->write_mutex);
+        if (connection->fd >= 0) writeMessage(connection->fd, {{"id", id}, {"status", "error"}, {"error", error}});
+    }
+    std::lock_guard<std::mutex> lock(stats_mutex);
+    errors++;
+}
+
+json MorphologyServer::stats() {
+    json doc;
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        doc = {{"requests", requests}, {"errors", errors}, {"batches", batches}, {"batch_sizes", batch_sizes}};
+    }
+    doc["uptime_s"] = elapsedUs(start, ServerClock::now()) * 1e-6;
+    doc["threads"] = dispatcher_threads;
+    doc["queue"] = queue_latency.toJson();
+    doc["compute"] = compute_latency.toJson();
+    doc["total"] = total_latency.toJson();
+    doc["buffer_pool"] = pool.stats();
+    doc["se_cache"] = {{"hits", se_hits.load()}, {"misses", se_misses.load()}};
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex);
+        doc["shm"] = {{"segments", shm_segments}, {"requests", shm_requests}, {"errors", shm_errors}};
+    }
+    doc["shm"]["compute"] = shm_compute_latency.toJson();
+    // Scelte della versione "auto" ed errore del modello di costo
+    KernelDecisionStats decisions = kernelDecisionStats();
+    doc["auto"] = {
+        {"decisions", decisions.count}, {"retained", decisions.retained}, {"chosen", decisions.chosen},
+        {"mean_error_percent", decisions.mean_error_percent},
+        {"mean_abs_error_percent", decisions.mean_abs_error_percent},
+        {"max_abs_error_percent", decisions.max_abs_error_percent}
+    };
+    return doc;
+}
+
+int runServer(const ServerOptions& options) {
+    MorphologyServer server(options);
+    return server.run();
+}
+
+int runServeCommand(int argc, char* argv[], ServerOptions options) {
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") options.socket_path = value;
+        else if (arg == "--max-batch") options.max_batch = std::max(std::stoi(value), 1);
+        else if (arg == "--batch-us") options.batch_us = std::max(std::stoi(value), 0);
+        else if (arg == "--threads") options.threads = std::stoi(value);
+        else if (arg == "--pool-mb") options.pool_bytes = (size_t)std::stoul(value) << 20;
+        else if (arg == "--record") options.record_path = value;
+        else if (arg == "--mode") options.default_mode = value;
+        else if (arg == "--shm-spin") options.shm_spin = std::stoi(value);
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+    }
+    return runServer(options);
+}
+
+// CLIENT DI CARICO
+
+// Immagine di una richiesta della traccia nell'anello condiviso
+static bool shmRequestFor(const json& entry, uint64_t id, uint64_t input_offset, uint64_t output_offset, ShmRequest& request) {
+    request = ShmRequest{};
+    request.id = id;
+    request.input_offset = input_offset;
+    request.output_offset = output_offset;
+    request.width = entry.value("width", 256);
+    request.height = entry.value("height", 256);
+    request.stride = request.width;
+    std::vector<std::string> ops = entry.contains("ops") ? entry["ops"].get<std::vector<std::string>>()
+                                                         : std::vector<std::string>{entry.value("op", std::string("erosion"))};
+    if (ops.empty() || ops.size() > SHM_MAX_OPS) return false;
+    for (const auto& op : ops) {
+        int index = operationIndex(op);
+        if (index < 0) return false;
+        request.ops[request.op_count++] = (uint8_t)index;
+    }
+    json se = entry.contains("se") ? entry["se"] : json::object();
+    const auto& shapes = availableStructuringElementShapes();
+    auto shape = std::find(shapes.begin(), shapes.end(), se.value("shape", std::string("disk")));
+    if (shape == shapes.end()) return false;
+    request.shape = (uint8_t)(shape - shapes.begin());
+    request.radius = se.value("radius", 5);
+    return true;
+}
+
+int runClientCommand(int argc, char* argv[]) {
+    if (argc < 1) {
+        std::cerr << "Uso: client <traccia.jsonl> [--socket PERCORSO] [--connections N] [--speed X] [--repeat N] [--csv PERCORSO] [--shm] [--stats]" << std::endl;
+        return 1;
+    }
+    std::string trace_path = argv[0], socket_path = DEFAULT_SOCKET_PATH, csv_path;
+    int connections = 4, repeat = 1;
+    double speed = 1.0;     // 2 = due volte più veloce della registrazione, 0 = senza pause
+    bool print_stats = false, use_shm = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--stats") {
+            print_stats = true;
+            continue;
+        }
+        if (arg == "--shm") {
+            use_shm = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+        std::string value = argv[++i];
+        if (arg == "--socket") socket_path = value;
+        else if (arg == "--connections") connections = std::max(std::stoi(value), 1);
+        else if (arg == "--speed") speed = std::stod(value);
+        else if (arg == "--repeat") repeat = std::max(std::stoi(value), 1);
+        else if (arg == "--csv") csv_path = value;
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    // Traccia e immagini generate prima di iniziare, fuori dalle misure
+    std::ifstream trace_file(trace_path);
+    if (!trace_file) {
+        std::cerr << "Traccia non trovata: " << trace_path << std::endl;
+        return 1;
+    }
+    std::vector<json> trace;
+    std::vector<std::vector<uint8_t>> payloads;
+    size_t max_payload = 0;
+    std::string line;
+    while (std::getline(trace_file, line)) {
+        if (line.empty()) continue;
+        json entry = json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.is_object()) {
+            std::cerr << "Riga della traccia non valida: " << line << std::endl;
+            return 1;
+        }
+        std::vector<uint8_t> payload;
+        if (!entry.contains("path")) {
+            STBImage img = generateWorkloadImage(entry.value("width", 256), entry.value("height", 256),
+                workloadProfile(entry.value("profile", "default")), entry.value("seed", 42ull), (int)trace.size());
+            payload.assign(img.image_data, img.image_data + (size_t)img.width * img.height);
+        } else if (use_shm) {
+            // In memoria condivisa il server non legge file: l'immagine la scrive il client
+            STBImage img;
+            if (!img.loadImage(entry["path"].get<std::string>())) {
+                std::cerr << "Impossibile leggere " << entry["path"] << std::endl;
+                return 1;
+            }
+            binarizePixels(img.image_data, (size_t)img.width * img.height);
+            entry["width"] = img.width;
+            entry["height"] = img.height;
+            payload.assign(img.image_data, img.image_data + (size_t)img.width * img.height);
+        }
+        max_payload = std::max(max_payload, payload.size());
+        trace.push_back(std::move(entry));
+        payloads.push_back(std::move(payload));
+    }
+    if (trace.empty()) {
+        std::cerr << "Traccia vuota: " << trace_path << std::endl;
+        return 1;
+    }
+    // Gli istanti sono relativi alla prima richiesta (una traccia registrata parte dall'avvio del server)
+    double first_us = trace.front().value("t_us", 0.0);
+    double duration_us = trace.back().value("t_us", 0.0) - first_us + 1.0;
+    size_t total_requests = trace.size() * repeat;
+
+    LatencyHistogram latency, overhead;
+    std::vector<double> latencies(total_requests, 0.0), compute_us(total_requests, 0.0);
+    std::vector<int> batch_size(total_requests, 0);
+    std::atomic<uint64_t> errors{0};
+    std::atomic<bool> connect_failed{false};
+    auto start = ServerClock::now();
+
+    // Ogni connessione invia in ordine le richieste j con j % connections uguale al suo indice
+    std::vector<std::thread> clients;
+    for (int c = 0; c < connections; c++) {
+        clients.emplace_back([&, c] {
+            int fd = connectToServer(socket_path);
+            if (fd < 0) {
+                connect_failed = true;
+                return;
+            }
+            // Segmento con l'area di ingresso e quella di uscita della richiesta più grande
+            size_t output_area = (max_payload + SHM_DATA_ALIGNMENT - 1) / SHM_DATA_ALIGNMENT * SHM_DATA_ALIGNMENT;
+            ShmChannel channel;
+            if (use_shm) {
+                std::string error;
+                json reply;
+                uint64_t size = 0;
+                if (!writeMessage(fd, {{"cmd", "attach_shm"}}) || !channel.open(fd, 2 * output_area, error) ||
+                    !readMessageHeader(fd, reply, size) || reply.value("status", "") != "ok") {
+                    std::cerr << "Segmento condiviso rifiutato: " << (error.empty() ? reply.value("error", std::string("connessione chiusa")) : error) << std::endl;
+                    connect_failed = true;
+                    close(fd);
+                    return;
+                }
+            }
+            std::vector<uint8_t> response;
+            for (size_t j = c; j < total_requests; j += connections) {
+                const json& entry = trace[j % trace.size()];
+                const std::vector<uint8_t>& payload = payloads[j % trace.size()];
+                if (speed > 0) {
+                    double t_us = (entry.value("t_us", 0.0) - first_us + (j / trace.size()) * duration_us) / speed;
+                    std::this_thread::sleep_until(start + std::chrono::microseconds((long long)t_us));
+                }
+
+                if (use_shm) {
+                    ShmRequest request;
+                    if (!shmRequestFor(entry, j, channel.dataOffset(), channel.dataOffset() + output_area, request)) {
+                        errors++;
+                        std::cerr << "Richiesta " << j << " non rappresentabile nel segmento" << std::endl;
+                        continue;
+                    }
+                    // Il client scrive l'immagine nel segmento come farebbe producendola; la misura parte dall'invio
+                    std::memcpy(channel.data(), payload.data(), payload.size());
+                    auto sent = ServerClock::now();
+                    ShmCompletion completion;
+                    if (!channel.submit(request) || !channel.waitCompletion(completion, 10000)) {
+                        errors++;
+                        break;
+                    }
+                    latencies[j] = elapsedUs(sent, ServerClock::now());
+                    compute_us[j] = completion.compute_ns / 1000.0;
+                    latency.record(latencies[j]);
+                    overhead.record(latencies[j] - compute_us[j]);
+                    if (completion.status != MORPHO_OK) {
+                        errors++;
+                        std::cerr << "Richiesta " << j << ": " << morpho_status_string(completion.status) << std::endl;
+                    }
+                    continue;
+                }
+
+                json header = {{"id", j}};
+                for (const char* key : {"ops", "op", "mode", "se", "output"}) {
+                    if (entry.contains(key)) header[key] = entry[key];
+                }
+                if (entry.contains("path")) header["image"] = {{"path", entry["path"]}};
+                else header["image"] = {{"width", entry.value("width", 256)}, {"height", entry.value("height", 256)}};
+
+                auto sent = ServerClock::now();
+                json reply;
+                uint64_t size = 0;
+                if (!writeMessage(fd, header, payload.data(), payload.size()) || !readMessageHeader(fd, reply, size)) {
+                    errors++;
+                    break;
+                }
+                response.resize(size);
+                if (size > 0 && !readExact(fd, response.data(), size)) {
+                    errors++;
+                    break;
+                }
+                latencies[j] = elapsedUs(sent, ServerClock::now());
+                latency.record(latencies[j]);
+                if (reply.value("status", "") != "ok") {
+                    errors++;
+                    std::cerr << "Richiesta " << j << ": " << reply.value("error", std::string("errore")) << std::endl;
+                    continue;
+                }
+                compute_us[j] = reply.value("compute_us", 0.0);
+                batch_size[j] = reply.value("batch_size", 0);
+                overhead.record(latencies[j] - compute_us[j]);
+            }
+            close(fd);
+        });
+    }
+    for (auto& client : clients) client.join();
+    double elapsed_s = elapsedUs(start, ServerClock::now()) * 1e-6;
+    if (connect_failed) {
+        std::cerr << "Impossibile connettersi a " << socket_path << std::endl;
+        return 1;
+    }
+
+    std::cout << "Richieste: " << latency.count() << " (" << errors << " errori) in " << elapsed_s << " s, "
+              << latency.count() / elapsed_s << " richieste/s" << (use_shm ? ", memoria condivisa" : ", socket") << std::endl;
+    std::cout << "Latenza client p50 " << latency.percentile(50) << " us, p90 " << latency.percentile(90)
+              << " us, p99 " << latency.percentile(99) << " us, max " << latency.toJson()["max_us"] << " us" << std::endl;
+    // Trasporto, attesa in coda e notifiche: latenza meno il calcolo riportato dal server
+    std::cout << "Overhead (latenza - calcolo) p50 " << overhead.percentile(50) << " us, p99 " << overhead.percentile(99)
+              << " us, media " << overhead.toJson()["mean_us"] << " us" << std::endl;
+
+    if (!csv_path.empty()) {
+        std::ofstream csv(csv_path, std::ofstream::trunc);
+        csv << "Request,Ops,Width,Height,Latency_us,Compute_us,Batch_Size\n";
+        for (size_t j = 0; j < total_requests; j++) {
+            const json& entry = trace[j % trace.size()];
+            std::string ops = entry.value("op", std::string(""));
+            if (entry.contains("ops")) {
+                for (const auto& op : entry["ops"]) ops += (ops.empty() ? "" : "+") + op.get<std::string>();
+            }
+            csv << j << "," << ops << "," << entry.value("width", 0) << "," << entry.value("height", 0) << ","
+                << latencies[j] << "," << compute_us[j] << "," << batch_size[j] << "\n";
+        }
+        std::cout << "Latenze scritte in " << csv_path << std::endl;
+    }
+    if (print_stats) {
+        int fd = connectToServer(socket_path);
+        json reply;
+        uint64_t size = 0;
+        if (fd >= 0 && writeMessage(fd, {{"cmd", "stats"}}) && readMessageHeader(fd, reply, size)) {
+            std::cout << reply["stats"].dump(2) << std::endl;
+        }
+        if (fd >= 0) close(fd);
+    }
+    return errors > 0 ? 1 : 0;
+}
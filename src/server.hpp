@@ -0,0 +1,84 @@
+#ifndef MORPHOLOGY_SERVER_HPP
+#define MORPHOLOGY_SERVER_HPP
+
+#include "image.hpp"
+
+#include <atomic>
+#include <mutex>
+
+// SERVER SU SOCKET UNIX
+//
+// Per l'uso interattivo ogni richiesta pagava avvio del processo, lettura della configurazione, avvio
+// del runtime OpenMP e generazione dell'elemento strutturante. Il server resta in ascolto su un socket
+// Unix e mantiene caldi il pool di thread OpenMP (tutto il calcolo avviene in un solo thread di
+// smistamento, quindi la squadra di thread si crea una volta), una cache degli elementi strutturanti e
+// un pool di buffer in cui si ricevono le immagini e si riciclano i risultati.
+//
+// Protocollo: ogni messaggio è [uint32 lunghezza intestazione][uint64 lunghezza dati][intestazione JSON][dati].
+// Richiesta: {"id", "ops": ["opening", ...] (o "op"), "mode", "se": {"shape", "radius"},
+//             "image": {"path"} oppure {"width", "height"} con i pixel nei dati, "output": {"path"} facoltativo}
+//             oppure {"cmd": "stats" | "ping" | "shutdown"}.
+// Risposta:  {"id", "status": "ok" | "error", "error", "width", "height", "batch_size",
+//             "queue_us", "compute_us", "server_us"} con i pixel del risultato nei dati se non c'è "output".
+//
+// Le richieste di client diversi che arrivano entro una finestra (batch_us) e hanno le stesse operazioni,
+// versione ed elemento strutturante sono elaborate insieme con applyOperationImgVec.
+// Istogrammi di latenza (attesa in coda, calcolo, totale) e dimensioni dei batch si leggono con "stats".
+//
+// {"cmd": "attach_shm"} seguito dal descrittore di un segmento (shm_transport.hpp) apre il trasporto in
+// memoria condivisa: le richieste del segmento non passano dal socket né dal batch, e un thread dedicato
+// le calcola con i kernel della libreria C (morpho_c.h), che leggono e scrivono buffer del chiamante.
+
+const char* const DEFAULT_SOCKET_PATH = "/tmp/morphology.sock";
+
+// Istogramma di latenze in microsecondi con 4 bucket per potenza di due (errore relativo < 19%)
+class LatencyHistogram {
+public:
+    static const int BUCKETS = 4 * 36;
+
+    LatencyHistogram();
+
+    void record(double us);
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    // Limite superiore del bucket che contiene il percentile p (0-100)
+    double percentile(double p) const;
+    json toJson() const;
+
+private:
+    std::atomic<uint64_t> buckets[BUCKETS];
+    std::atomic<uint64_t> total{0}, sum_ns{0}, max_ns{0};
+};
+
+// Funzioni di trasporto dei messaggi (false se la connessione è chiusa o c'è un errore)
+bool writeMessage(int fd, const json& header, const uint8_t* data = nullptr, size_t size = 0);
+bool readMessageHeader(int fd, json& header, uint64_t& data_size);
+bool readExact(int fd, void* dst, size_t size);
+
+// Funzione per connettersi al server (-1 se non raggiungibile)
+int connectToServer(const std::string& socket_path);
+
+struct ServerOptions {
+    std::string socket_path{DEFAULT_SOCKET_PATH};
+    int max_batch{16};              // Richieste massime per batch
+    int batch_us{200};              // Attesa massima per riempire un batch dopo la prima richiesta
+    int threads{0};                 // Thread OpenMP (0 = predefinito)
+    size_t pool_bytes{256u << 20};  // Byte massimi trattenuti nel pool di buffer
+    std::string record_path;        // Traccia delle richieste per il client di carico (vuoto = nessuna)
+    std::string default_mode{"auto"};
+    int shm_spin{-1};               // Controlli dell'anello condiviso prima di dormire sul futex (-1 = defaultShmSpin())
+    std::string default_shape{"disk"};
+    int default_radius{5};
+    int tile_size{64};
+    uint8_t background{DEFAULT_BACKGROUND_COLOR};
+};
+
+// Funzione per eseguire il server fino a "shutdown", SIGINT o SIGTERM
+int runServer(const ServerOptions& options);
+
+// Comando "serve": legge le opzioni da riga di comando sopra i valori della configurazione
+int runServeCommand(int argc, char* argv[], ServerOptions options);
+
+// Comando "client": riproduce una traccia registrata (JSON-lines) con più connessioni e riporta le latenze
+int runClientCommand(int argc, char* argv[]);
+
+#endif // MORPHOLOGY_SERVER_HPP
@@ -0,0 +1,165 @@
+#include "shm_transport.hpp"
+
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <thread>
+
+int defaultShmSpin() {
+    static const int spin = std::thread::hardware_concurrency() > 1 ? 20000 : 0;
+    return spin;
+}
+
+// Futex non privati: la parola è in un segmento mappato da due processi
+void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms) {
+    timespec timeout{timeout_ms / 1000, (timeout_ms % 1000) * 1000000L};
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAIT, expected, timeout_ms >= 0 ? &timeout : nullptr, nullptr, 0);
+}
+
+void futexWake(std::atomic<uint32_t>* word) {
+    syscall(SYS_futex, (uint32_t*)word, FUTEX_WAKE, 1, nullptr, nullptr, 0);
+}
+
+bool sendFd(int socket_fd, int fd) {
+    char byte = 0;
+    iovec io{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    cmsg->cmsg_level = SOL_SOCKET;
+    cmsg->cmsg_type = SCM_RIGHTS;
+    cmsg->cmsg_len = CMSG_LEN(sizeof(int));
+    std::memcpy(CMSG_DATA(cmsg), &fd, sizeof(int));
+    ssize_t n;
+    do {
+        n = sendmsg(socket_fd, &message, MSG_NOSIGNAL);
+    } while (n < 0 && errno == EINTR);
+    return n == 1;
+}
+
+int receiveFd(int socket_fd) {
+    char byte = 0;
+    iovec io{&byte, 1};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(int))] = {};
+    msghdr message{};
+    message.msg_iov = &io;
+    message.msg_iovlen = 1;
+    message.msg_control = control;
+    message.msg_controllen = sizeof(control);
+    ssize_t n;
+    do {
+        n = recvmsg(socket_fd, &message, MSG_CMSG_CLOEXEC);
+    } while (n < 0 && errno == EINTR);
+    if (n != 1) return -1;
+    cmsghdr* cmsg = CMSG_FIRSTHDR(&message);
+    if (!cmsg || cmsg->cmsg_level != SOL_SOCKET || cmsg->cmsg_type != SCM_RIGHTS) return -1;
+    int fd;
+    std::memcpy(&fd, CMSG_DATA(cmsg), sizeof(int));
+    return fd;
+}
+
+ShmSegment::~ShmSegment() {
+    if (base) munmap(base, size);
+}
+
+bool ShmSegment::attach(int fd, std::string& error) {
+    // Un segmento che il client può ridurre dopo la mappatura farebbe cadere il server con SIGBUS
+    int seals = fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+        close(fd);
+        error = "segmento senza sigillo F_SEAL_SHRINK";
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || (size_t)info.st_size < sizeof(ShmHeader)) {
+        close(fd);
+        error = "segmento troppo piccolo";
+        return false;
+    }
+    size = info.st_size;
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        error = std::string("mmap non riuscita: ") + std::strerror(errno);
+        return false;
+    }
+    base = (uint8_t*)mapped;
+    const ShmHeader* h = header();
+    if (h->magic != SHM_MAGIC || h->version != SHM_VERSION) error = "intestazione del segmento non valida";
+    else if (h->segment_size != size || h->data_offset < sizeof(ShmHeader) || h->data_offset > size) error = "dimensioni del segmento non coerenti";
+    return error.empty();
+}
+
+bool ShmSegment::contains(uint64_t offset, int32_t width, int32_t height, int32_t stride) const {
+    if (width <= 0 || height <= 0 || stride < width) return false;
+    uint64_t extent = (uint64_t)stride * (height - 1) + width;
+    return offset >= header()->data_offset && offset <= size && extent <= size - offset;
+}
+
+ShmChannel::~ShmChannel() {
+    if (!base) return;
+    // Il server esce dall'attesa e smette di usare il segmento
+    header()->closing.store(1, std::memory_order_seq_cst);
+    header()->requests.notify();
+    munmap(base, size);
+}
+
+bool ShmChannel::open(int socket_fd, size_t data_bytes, std::string& error) {
+    size_t data_offset = (sizeof(ShmHeader) + SHM_DATA_ALIGNMENT - 1) / SHM_DATA_ALIGNMENT * SHM_DATA_ALIGNMENT;
+    size = data_offset + (data_bytes + SHM_DATA_ALIGNMENT - 1) / SHM_DATA_ALIGNMENT * SHM_DATA_ALIGNMENT;
+    int fd = memfd_create("morphology", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0 || ftruncate(fd, size) != 0) {
+        error = std::string("memfd_create non riuscita: ") + std::strerror(errno);
+        if (fd >= 0) close(fd);
+        return false;
+    }
+    // Dimensione fissata prima dell'invio: il server rifiuta i segmenti che si possono ridurre
+    if (fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW) != 0) {
+        error = std::string("sigillo del segmento non riuscito: ") + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapped == MAP_FAILED) {
+        error = std::string("mmap non riuscita: ") + std::strerror(errno);
+        close(fd);
+        return false;
+    }
+    base = (uint8_t*)mapped;
+    ShmHeader* h = new (base) ShmHeader;
+    h->magic = SHM_MAGIC;
+    h->version = SHM_VERSION;
+    h->segment_size = size;
+    h->data_offset = data_offset;
+    h->closing.store(0, std::memory_order_relaxed);
+    h->requests.init();
+    h->completions.init();
+    bool sent = sendFd(socket_fd, fd);
+    close(fd);
+    if (!sent) error = "invio del segmento non riuscito";
+    return sent;
+}
+
+bool ShmChannel::waitCompletion(ShmCompletion& completion, int timeout_ms, int spin) {
+    ShmRing<ShmCompletion>& ring = header()->completions;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout_ms);
+    while (!ring.pop(completion)) {
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return false;
+        ring.wait(spin, (int)left);
+    }
+    return true;
+}
@@ -0,0 +1,183 @@
+#ifndef MORPHOLOGY_SHM_TRANSPORT_HPP
+#define MORPHOLOGY_SHM_TRANSPORT_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// TRASPORTO IN MEMORIA CONDIVISA
+//
+// Con il socket i pixel di una richiesta si copiano due volte (client -> kernel -> server) e altrettante
+// quelli del risultato. Qui il client crea un segmento (memfd) e lo passa al server sul socket
+// (SCM_RIGHTS) con il comando "attach_shm"; da lì scrive l'immagine nell'area dati del segmento e il
+// server la elabora sul posto, scrivendo il risultato in un'altra regione dello stesso segmento.
+// Il segmento è sigillato (F_SEAL_SHRINK | F_SEAL_GROW) prima dell'invio e il server rifiuta quelli
+// senza F_SEAL_SHRINK: un client non può ridurlo sotto le mappature del server.
+//
+// Richieste e completamenti passano per due anelli SPSC senza lock all'inizio del segmento
+// (un produttore e un consumatore per anello). Il consumatore controlla l'anello per un breve tratto
+// e poi dorme su un futex condiviso; il produttore lo sveglia solo se sta dormendo, quindi a regime
+// nessuna chiamata di sistema accompagna una richiesta.
+
+const uint32_t SHM_MAGIC = 0x4d505348;     // "HSPM"
+const uint32_t SHM_VERSION = 1;
+const uint32_t SHM_RING_SLOTS = 64;
+const size_t SHM_DATA_ALIGNMENT = 4096;
+const uint8_t SHM_MAX_OPS = 4;
+
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "Gli anelli condivisi richiedono atomici senza lock");
+
+// Richiesta: offset dall'inizio del segmento, operazioni nell'ordine di availableOperations()
+struct ShmRequest {
+    uint64_t id;
+    uint64_t input_offset, output_offset;
+    int32_t width, height;
+    int32_t stride;             // Byte fra due righe, per ingresso e uscita (almeno width)
+    int32_t radius;
+    uint8_t ops[SHM_MAX_OPS];
+    uint8_t op_count;
+    uint8_t shape;              // Indice in availableStructuringElementShapes()
+    uint8_t border;             // Valore dei pixel di bordo
+    uint8_t reserved[5];
+};
+
+struct ShmCompletion {
+    uint64_t id;
+    int32_t status;             // Codice morpho_status (0 = riuscita)
+    uint32_t reserved;
+    uint64_t compute_ns;        // Tempo di calcolo nel server
+};
+
+// Controlli attivi dell'anello prima di dormire sul futex: con un solo processore l'attesa attiva
+// toglierebbe la CPU proprio al processo che deve rispondere, quindi si dorme subito
+int defaultShmSpin();
+
+// Attesa e risveglio su una parola condivisa fra processi
+void futexWait(std::atomic<uint32_t>* word, uint32_t expected, int timeout_ms);
+void futexWake(std::atomic<uint32_t>* word);
+
+static inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+
+// Anello con un solo produttore e un solo consumatore; indici e parola del futex su linee di cache separate
+template <typename T>
+struct ShmRing {
+    alignas(64) std::atomic<uint32_t> head;         // Scritto solo dal produttore
+    alignas(64) std::atomic<uint32_t> tail;         // Scritto solo dal consumatore
+    alignas(64) std::atomic<uint32_t> sequence;     // Parola del futex: cambia a ogni inserimento
+    std::atomic<uint32_t> sleeping;                 // Il consumatore dorme (o sta per dormire) sul futex
+    alignas(64) T slots[SHM_RING_SLOTS];
+
+    void init() {
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        sequence.store(0, std::memory_order_relaxed);
+        sleeping.store(0, std::memory_order_relaxed);
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_relaxed);
+    }
+
+    // Produttore: false se l'anello è pieno
+    bool push(const T& value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= SHM_RING_SLOTS) return false;
+        slots[h % SHM_RING_SLOTS] = value;
+        head.store(h + 1, std::memory_order_release);
+        notify();
+        return true;
+    }
+
+    // Cambia la sequenza e sveglia il consumatore solo se dorme
+    void notify() {
+        sequence.fetch_add(1, std::memory_order_seq_cst);
+        if (sleeping.load(std::memory_order_seq_cst)) futexWake(&sequence);
+    }
+
+    // Consumatore: false se l'anello è vuoto
+    bool pop(T& value) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (head.load(std::memory_order_acquire) == t) return false;
+        value = slots[t % SHM_RING_SLOTS];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumatore: attende un elemento controllando l'anello spin volte, poi sul futex fino a timeout_ms;
+    // restituisce false se l'anello è ancora vuoto (timeout o notify senza inserimenti)
+    bool wait(int spin, int timeout_ms) {
+        for (int i = 0; i < spin; i++) {
+            if (!empty()) return true;
+            cpuRelax();
+        }
+        sleeping.store(1, std::memory_order_seq_cst);
+        uint32_t seq = sequence.load(std::memory_order_seq_cst);
+        if (empty()) futexWait(&sequence, seq, timeout_ms);
+        sleeping.store(0, std::memory_order_relaxed);
+        return !empty();
+    }
+};
+
+struct ShmHeader {
+    uint32_t magic, version;
+    uint64_t segment_size;
+    uint64_t data_offset;                           // Inizio dell'area dati, allineato a SHM_DATA_ALIGNMENT
+    alignas(64) std::atomic<uint32_t> closing;      // Il client chiude il segmento
+    alignas(64) ShmRing<ShmRequest> requests;       // Client -> server
+    alignas(64) ShmRing<ShmCompletion> completions; // Server -> client
+};
+
+// Passaggio di un descrittore di file su un socket Unix (un byte di dati con SCM_RIGHTS)
+bool sendFd(int socket_fd, int fd);
+int receiveFd(int socket_fd);
+
+// Segmento mappato (lato server): verifica intestazione e dimensioni, si smappa alla distruzione
+struct ShmSegment {
+    uint8_t* base{nullptr};
+    size_t size{0};
+
+    ShmSegment() {}
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+    ~ShmSegment();
+
+    ShmHeader* header() const { return (ShmHeader*)base; }
+    // Funzione per mappare il segmento ricevuto (chiude fd); error riceve il motivo del rifiuto
+    bool attach(int fd, std::string& error);
+    // Verifica che una regione width x height con stride stia nell'area dati
+    bool contains(uint64_t offset, int32_t width, int32_t height, int32_t stride) const;
+};
+
+// Canale del client: crea il segmento e lo registra sul server già connesso
+class ShmChannel {
+public:
+    ShmChannel() {}
+    ShmChannel(const ShmChannel&) = delete;
+    ShmChannel& operator=(const ShmChannel&) = delete;
+    ~ShmChannel();
+
+    // Funzione per creare un segmento con data_bytes di area dati e inviarlo al server
+    bool open(int socket_fd, size_t data_bytes, std::string& error);
+
+    uint8_t* data() const { return base + header()->data_offset; }
+    size_t dataSize() const { return size - header()->data_offset; }
+    uint64_t dataOffset() const { return header()->data_offset; }
+
+    // false se l'anello delle richieste è pieno
+    bool submit(const ShmRequest& request) { return header()->requests.push(request); }
+    // Attende un completamento (false dopo timeout_ms senza risposta)
+    bool waitCompletion(ShmCompletion& completion, int timeout_ms, int spin = defaultShmSpin());
+
+private:
+    ShmHeader* header() const { return (ShmHeader*)base; }
+
+    uint8_t* base{nullptr};
+    size_t size{0};
+};
+
+#endif // MORPHOLOGY_SHM_TRANSPORT_HPP
@@ -0,0 +1,243 @@
+#include "streaming.hpp"
+#include "container.hpp"
+#include "morphology.hpp"
+
+// Righe da un file PGM (P5) o PBM (P4)
+class PNMRowSource : public RowSource {
+public:
+    bool open(const std::string& name) {
+        in.open(name, std::ios::binary);
+        if (!in) return false;
+        uint8_t head[4096];
+        in.read((char*)head, sizeof(head));
+        size_t got = in.gcount();
+        if (!parsePNMHeader(head, got, header)) return false;
+        in.clear();
+        in.seekg(header.data_offset);
+        width = header.width;
+        height = header.height;
+        row_bytes = header.format == '4' ? (width + 7) / 8 : width;
+        row.resize(row_bytes);
+        return (bool)in;
+    }
+
+    bool readRows(int n, uint8_t* dst) override {
+        for (int r = 0; r < n; r++) {
+            uint8_t* out = dst + (size_t)r * width;
+            if (header.format == '5' && header.maxval == 255) {
+                if (!in.read((char*)out, width)) return false;
+                continue;
+            }
+            if (!in.read((char*)row.data(), row_bytes)) return false;
+            if (header.format == '5') {
+                for (int x = 0; x < width; x++)
+                    out[x] = (uint8_t)((row[x] * 255 + header.maxval / 2) / header.maxval);
+            } else {
+                for (int x = 0; x < width; x++)
+                    out[x] = (row[x >> 3] >> (7 - (x & 7))) & 1 ? 0 : 255;
+            }
+        }
+        return true;
+    }
+
+private:
+    std::ifstream in;
+    PNMHeader header;
+    size_t row_bytes{0};
+    std::vector<uint8_t> row;
+};
+
+// Righe da una voce di un contenitore .mpk (raw, bit-packed o RLE, letta in sequenza senza mappare il file)
+class PackRowSource : public RowSource {
+public:
+    bool open(const std::string& path, const std::string& name) {
+        in.open(path, std::ios::binary);
+        PackHeader header;
+        if (!in || !in.read((char*)&header, sizeof(header))) return false;
+        if (std::memcmp(header.magic, PACK_MAGIC, sizeof(PACK_MAGIC)) != 0 || header.version != PACK_VERSION) return false;
+        for (uint64_t i = 0; i < header.num_entries; i++) {
+            in.seekg(header.index_offset + i * sizeof(PackEntry));
+            if (!in.read((char*)&entry, sizeof(entry))) return false;
+            std::string entry_name(entry.name_length, '\0');
+            in.seekg(header.names_offset + entry.name_offset);
+            if (!in.read(&entry_name[0], entry.name_length)) return false;
+            if (entry_name == name) {
+                width = entry.width;
+                height = entry.height;
+                body_left = entry.body_size;
+                in.seekg(entry.body_offset);
+                row.resize((width + 7) / 8);
+                return (bool)in;
+            }
+        }
+        return false;
+    }
+
+    bool readRows(int n, uint8_t* dst) override {
+        if (entry.encoding == (uint32_t)PackEncoding::Raw) {
+            return readBody(dst, (size_t)n * width);
+        }
+        if (entry.encoding == (uint32_t)PackEncoding::BitPacked) {
+            for (int r = 0; r < n; r++) {
+                if (!readBody(row.data(), row.size())) return false;
+                uint8_t* out = dst + (size_t)r * width;
+                for (int x = 0; x < width; x++)
+                    out[x] = (row[x >> 3] >> (7 - (x & 7))) & 1 ? 255 : 0;
+            }
+            return true;
+        }
+        if (entry.encoding == (uint32_t)PackEncoding::RLE) {
+            size_t need = (size_t)n * width;
+            while (need > 0) {
+                if (run_left == 0) {
+                    if (started) foreground = !foreground;
+                    started = true;
+                    if (!readVarint(run_left)) return false;
+                    continue;
+                }
+                size_t k = std::min(need, run_left);
+                std::memset(dst, foreground ? 255 : 0, k);
+                dst += k;
+                need -= k;
+                run_left -= k;
+            }
+            return true;
+        }
+        return false;
+    }
+
+private:
+    bool readBody(uint8_t* dst, size_t n) {
+        if (n > body_left || !in.read((char*)dst, n)) return false;
+        body_left -= n;
+        return true;
+    }
+
+    bool readVarint(size_t& value) {
+        value = 0;
+        uint8_t byte;
+        int shift = 0;
+        do {
+            if (shift > 56 || !readBody(&byte, 1)) return false;
+            value |= (size_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return true;
+    }
+
+    std::ifstream in;
+    PackEntry entry{};
+    uint64_t body_left{0};
+    std::vector<uint8_t> row;
+    size_t run_left{0};
+    bool foreground{false}, started{false};
+};
+
+// Apre la sorgente di righe: file .pgm/.pbm oppure "contenitore.mpk:nome_immagine"
+std::unique_ptr<RowSource> openRowSource(const std::string& input) {
+    size_t sep = input.rfind(':');
+    if (sep != std::string::npos && fileExtension(input.substr(0, sep)) == "mpk") {
+        auto source = std::make_unique<PackRowSource>();
+        if (source->open(input.substr(0, sep), input.substr(sep + 1))) return source;
+        return nullptr;
+    }
+    auto source = std::make_unique<PNMRowSource>();
+    if (source->open(input)) return source;
+    return nullptr;
+}
+
+// Scrittura a righe di un file PGM (P5) o, con estensione .pbm, PBM (P4)
+class PNMRowWriter {
+public:
+    bool open(const std::string& name, int w, int h) {
+        width = w;
+        packed = fileExtension(name) == "pbm";
+        out.open(name, std::ios::binary | std::ios::trunc);
+        out << (packed ? "P4\n" : "P5\n") << w << " " << h << "\n" << (packed ? "" : "255\n");
+        row.resize((width + 7) / 8);
+        return (bool)out;
+    }
+
+    bool writeRows(int n, const uint8_t* src) {
+        if (!packed) {
+            out.write((const char*)src, (size_t)n * width);
+            return (bool)out;
+        }
+        for (int r = 0; r < n; r++) {
+            const uint8_t* in = src + (size_t)r * width;
+            std::fill(row.begin(), row.end(), 0);
+            for (int x = 0; x < width; x++)
+                if (in[x] < 128) row[x >> 3] |= 0x80 >> (x & 7);
+            out.write((const char*)row.data(), row.size());
+        }
+        return (bool)out;
+    }
+
+    bool close() {
+        out.close();
+        return !out.fail();
+    }
+
+private:
+    std::ofstream out;
+    int width{0};
+    bool packed{false};
+    std::vector<uint8_t> row;
+};
+
+// Funzione per elaborare un'immagine a strisce di stripe_rows righe con una qualsiasi versione (mode)
+bool processStriped(const std::string& input, const std::string& output,
+    const std::string& operation, const std::string& mode,
+    const StructuringElement& se, int stripe_rows, int tile_size, uint8_t background) {
+    auto source = openRowSource(input);
+    if (!source) {
+        std::cerr << "Input non leggibile: " << input << std::endl;
+        return false;
+    }
+    PNMRowWriter writer;
+    if (!writer.open(output, source->width, source->height)) {
+        std::cerr << "Output non scrivibile: " << output << std::endl;
+        return false;
+    }
+
+    const int width = source->width, height = source->height;
+    int halo = std::max(se.anchor_y, se.height - 1 - se.anchor_y);
+    if (operation == "opening" || operation == "closing") halo *= 2;
+    stripe_rows = std::max(stripe_rows, 1);
+
+    // Finestra di righe di input [win_start, win_end), riutilizzata fra le strisce
+    STBImage window;
+    window.initializeBinary(width, stripe_rows + 2 * halo, background);
+    int win_start = 0, win_end = 0;
+
+    for (int y0 = 0; y0 < height; y0 += stripe_rows) {
+        int y1 = std::min(y0 + stripe_rows, height);
+        int need_start = std::max(0, y0 - halo);
+        int need_end = std::min(height, y1 + halo);
+
+        // Le righe già lette che servono ancora vengono spostate in cima alla finestra
+        TraceScope read_trace("read_stripe", "io", 0, y0);
+        int keep = std::max(0, win_end - need_start);
+        if (keep > 0 && need_start > win_start) {
+            std::memmove(window.image_data, window.image_data + (size_t)(need_start - win_start) * width, (size_t)keep * width);
+        }
+        if (!source->readRows(need_end - need_start - keep, window.image_data + (size_t)keep * width)) {
+            std::cerr << "Errore di lettura da " << input << std::endl;
+            return false;
+        }
+        win_start = need_start;
+        win_end = need_end;
+        read_trace.end();
+
+        window.height = win_end - win_start;
+        TraceScope stripe_trace("stripe", "band", 0, y0);
+        STBImage result = applyOperation(window, se, operation, mode, tile_size, background);
+        stripe_trace.end();
+        TraceScope write_trace("write_stripe", "io", 0, y0);
+        if (!writer.writeRows(y1 - y0, result.image_data + (size_t)(y0 - win_start) * width)) {
+            std::cerr << "Errore di scrittura su " << output << std::endl;
+            return false;
+        }
+    }
+    return writer.close();
+}
@@ -0,0 +1,30 @@
+#ifndef MORPHOLOGY_STREAMING_HPP
+#define MORPHOLOGY_STREAMING_HPP
+
+#include "image.hpp"
+
+// ELABORAZIONE A STRISCE (OUT-OF-CORE)
+//
+// Per immagini che non entrano in memoria: l'input viene letto a strisce orizzontali, ogni striscia
+// viene elaborata con un alone (halo) di righe sopra e sotto pari all'ingombro verticale dell'elemento
+// strutturante (doppio per apertura e chiusura) e le righe valide vengono scritte appena pronte.
+// La memoria usata dipende dall'altezza della striscia e dalla larghezza, non dall'altezza dell'immagine.
+
+// Sorgente sequenziale di righe (1 byte per pixel)
+class RowSource {
+public:
+    int width{0}, height{0};
+    virtual ~RowSource() {}
+    // Legge le prossime n righe in dst (n * width byte)
+    virtual bool readRows(int n, uint8_t* dst) = 0;
+};
+
+// Apre la sorgente di righe: file .pgm/.pbm oppure "contenitore.mpk:nome_immagine"
+std::unique_ptr<RowSource> openRowSource(const std::string& input);
+
+// Funzione per elaborare un'immagine a strisce di stripe_rows righe con una qualsiasi versione (mode)
+bool processStriped(const std::string& input, const std::string& output,
+    const std::string& operation, const std::string& mode,
+    const StructuringElement& se, int stripe_rows, int tile_size, uint8_t background);
+
+#endif // MORPHOLOGY_STREAMING_HPP
@@ -0,0 +1,169 @@
+#include "image.hpp"
+#include "morphology.hpp"
+
+#include <cmath>
+#include <stdexcept>
+
+// Elementi strutturanti: generazione e compilazione, senza dipendenze dalla configurazione né I/O,
+// condivise fra le versioni C++ e la libreria con interfaccia C. Lettura dei parametri, maschere e
+// altezze da file sono in structuring_element_spec.cpp, compilato solo nella libreria morphology
+
+std::vector<std::vector<int>> centreStructuringElement(std::vector<std::vector<int>> kernel, int anchor_x, int anchor_y) {
+    int height = kernel.size(), width = kernel.empty() ? 0 : kernel[0].size();
+    if (anchor_x < 0 || anchor_y < 0 || anchor_x >= width || anchor_y >= height) {
+        throw std::invalid_argument("Ancora fuori dall'elemento strutturante");
+    }
+    int half_x = std::max(anchor_x, width - 1 - anchor_x), half_y = std::max(anchor_y, height - 1 - anchor_y);
+    if (half_x == anchor_x && half_y == anchor_y && width == 2 * half_x + 1 && height == 2 * half_y + 1) return kernel;
+
+    std::vector<std::vector<int>> centred(2 * half_y + 1, std::vector<int>(2 * half_x + 1, 0));
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) centred[i + half_y - anchor_y][j + half_x - anchor_x] = kernel[i][j];
+    }
+    return centred;
+}
+
+// Kernel vuoto di semiassi hx, hy con ancora al centro
+static std::vector<std::vector<int>> emptyKernel(int hx, int hy) {
+    return std::vector<std::vector<int>>(2 * hy + 1, std::vector<int>(2 * hx + 1, 0));
+}
+
+static std::vector<std::vector<int>> diskKernel(int radius) {
+    auto kernel = emptyKernel(radius, radius);
+    for (int i = -radius; i <= radius; ++i)
+        for (int j = -radius; j <= radius; ++j)
+            if (i * i + j * j <= radius * radius) kernel[i + radius][j + radius] = 1;
+    return kernel;
+}
+
+static std::vector<std::vector<int>> crossKernel(int radius) {
+    auto kernel = emptyKernel(radius, radius);
+    for (int k = 0; k <= 2 * radius; k++) kernel[radius][k] = kernel[k][radius] = 1;
+    return kernel;
+}
+
+static std::vector<std::vector<int>> diamondKernel(int radius) {
+    auto kernel = emptyKernel(radius, radius);
+    for (int i = -radius; i <= radius; ++i)
+        for (int j = -radius; j <= radius; ++j)
+            if (std::abs(i) + std::abs(j) <= radius) kernel[i + radius][j + radius] = 1;
+    return kernel;
+}
+
+// Rombo di raggio b per l'ottagono di raggio r: lati obliqui lunghi circa come quelli dritti
+static int octagonDiamondRadius(int radius) {
+    return (int)std::lround(radius * (2.0 - std::sqrt(2.0)));
+}
+
+// Ottagono = quadrato di semilato a = r - b dilatato dal rombo di raggio b: i pixel a distanza L1 al
+// più b dal quadrato
+static std::vector<std::vector<int>> octagonKernel(int radius) {
+    int b = octagonDiamondRadius(radius), a = radius - b;
+    auto kernel = emptyKernel(radius, radius);
+    for (int i = -radius; i <= radius; ++i)
+        for (int j = -radius; j <= radius; ++j)
+            if (std::max(std::abs(i) - a, 0) + std::max(std::abs(j) - a, 0) <= b) kernel[i + radius][j + radius] = 1;
+    return kernel;
+}
+
+// Ellisse di semiassi hx, hy (interi, così il kernel ha lati dispari e centro su un pixel);
+// con hx = hy coincide con il disco
+static std::vector<std::vector<int>> ellipseKernel(int hx, int hy) {
+    auto kernel = emptyKernel(hx, hy);
+    long long a2 = (long long)hx * hx, b2 = (long long)hy * hy;
+    for (int i = -hy; i <= hy; ++i)
+        for (int j = -hx; j <= hx; ++j)
+            if (j * j * b2 + i * i * a2 <= a2 * b2) kernel[i + hy][j + hx] = 1;
+    return kernel;
+}
+
+// Segmento digitale simmetrico rispetto all'ancora, con estremi a distanza (length-1)/2 dal centro
+static std::vector<std::vector<int>> lineKernel(int length, double angle_degrees) {
+    double theta = angle_degrees * std::acos(-1.0) / 180.0, half = (length - 1) / 2.0;
+    int ex = (int)std::lround(half * std::cos(theta)), ey = (int)std::lround(-half * std::sin(theta));
+    int hx = std::abs(ex), hy = std::abs(ey);
+    auto kernel = emptyKernel(hx, hy);
+    // Bresenham da (-ex, -ey) a (ex, ey)
+    int x = -ex, y = -ey, dx = std::abs(2 * ex), dy = -std::abs(2 * ey);
+    int sx = ex >= 0 ? 1 : -1, sy = ey >= 0 ? 1 : -1, err = dx + dy;
+    while (true) {
+        kernel[y + hy][x + hx] = 1;
+        if (x == ex && y == ey) break;
+        int e2 = 2 * err;
+        if (e2 >= dy) { err += dy; x += sx; }
+        if (e2 <= dx) { err += dx; y += sy; }
+    }
+    return kernel;
+}
+
+// Forme disponibili con la scomposizione che ognuna registra per la versione V4
+struct StructuringElementShape {
+    std::string name;
+    SEDecomposition decomposition;
+};
+
+static const std::vector<StructuringElementShape>& structuringElementShapes() {
+    static const std::vector<StructuringElementShape> shapes = {
+        {"disk", SEDecomposition::Chords},
+        {"square", SEDecomposition::Separable},
+        {"cross", SEDecomposition::Cross},
+        {"diamond", SEDecomposition::Diamond},
+        {"octagon", SEDecomposition::Octagon},
+        {"ellipse", SEDecomposition::Chords},
+        {"rectangle", SEDecomposition::Separable},
+        {"line", SEDecomposition::Chords},
+        {"mask", SEDecomposition::None},    // Scomposizione ricavata dalla maschera
+    };
+    return shapes;
+}
+
+const std::vector<std::string>& availableStructuringElementShapes() {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> list;
+        for (const auto& shape : structuringElementShapes()) list.push_back(shape.name);
+        return list;
+    }();
+    return names;
+}
+
+StructuringElement generateStructuringElement(const StructuringElementSpec& spec) {
+    const auto& shapes = structuringElementShapes();
+    auto shape = std::find_if(shapes.begin(), shapes.end(), [&](const StructuringElementShape& s) { return s.name == spec.shape; });
+    if (shape == shapes.end()) throw std::invalid_argument("Forma dell'elemento strutturante non valida: " + spec.shape);
+    if (spec.shape == "mask") throw std::invalid_argument("L'elemento strutturante \"mask\" si legge da file con makeStructuringElement");
+    if (spec.radius < 0 || spec.width < 0 || spec.height < 0 || spec.length < 0) {
+        throw std::invalid_argument("Dimensioni negative per l'elemento strutturante " + spec.shape);
+    }
+
+    int r = spec.radius;
+    int width = spec.width > 0 ? spec.width : 2 * r + 1;
+    int height = spec.height > 0 ? spec.height : r + 1;
+    StructuringElement se;
+    if (spec.shape == "disk") se.setKernel(diskKernel(r));
+    else if (spec.shape == "square") se.setKernel(std::vector<std::vector<int>>(2 * r + 1, std::vector<int>(2 * r + 1, 1)));
+    else if (spec.shape == "cross") se.setKernel(crossKernel(r));
+    else if (spec.shape == "diamond") se.setKernel(diamondKernel(r));
+    else if (spec.shape == "octagon") se.setKernel(octagonKernel(r));
+    else if (spec.shape == "ellipse") se.setKernel(ellipseKernel(width / 2, height / 2));
+    else if (spec.shape == "line") se.setKernel(lineKernel(spec.length > 0 ? spec.length : 2 * r + 1, spec.angle));
+    else {
+        // Lati pari: l'ancora è a sinistra/in alto del centro, come per i kernel pari del costruttore
+        se = StructuringElement(std::vector<std::vector<int>>(height, std::vector<int>(width, 1)), width / 2, height / 2);
+    }
+    se.decomposition = shape->decomposition;
+    se.decomposition_radius = spec.shape == "octagon" ? octagonDiamondRadius(r) : 0;
+    return se;
+}
+
+// Funzione per compilare l'elemento strutturante nella lista degli spostamenti (dy, dx) dei pixel attivi
+std::vector<std::pair<int, int>> compileStructuringElement(const StructuringElement& se) {
+    std::vector<std::pair<int, int>> active_pixels;
+    for (int i = 0; i < se.height; i++) {
+        for (int j = 0; j < se.width; j++) {
+            if (se.kernel[i][j] == 1) {
+                active_pixels.emplace_back(i - se.anchor_y, j - se.anchor_x);
+            }
+        }
+    }
+    return active_pixels;
+}
@@ -0,0 +1,156 @@
+#include "image.hpp"
+
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+// Elementi strutturanti descritti da parametri: lettura dalla configurazione, maschere e altezze da file.
+// Le forme generate dal solo raggio e dagli assi sono in structuring_element.cpp
+
+// Maschera da JSON ({"kernel": [[...]], "anchor": [x, y]}) o da immagine (pixel >= 128 attivi)
+static std::vector<std::vector<int>> loadMaskKernel(const std::string& path, int& anchor_x, int& anchor_y) {
+    std::vector<std::vector<int>> kernel;
+    if (fileExtension(path) == "json") {
+        std::ifstream file(path);
+        if (!file) throw std::runtime_error("Maschera non trovata: " + path);
+        json doc = json::parse(file, nullptr, false);
+        if (doc.is_discarded() || !doc.is_object() || !doc.contains("kernel")) throw std::runtime_error("Maschera JSON non valida: " + path);
+        try {
+            for (const auto& row : doc["kernel"]) {
+                kernel.emplace_back();
+                for (const auto& value : row) kernel.back().push_back(value.get<int>() != 0 ? 1 : 0);
+            }
+            if (doc.contains("anchor") && anchor_x < 0 && anchor_y < 0) {
+                anchor_x = doc["anchor"].at(0).get<int>();
+                anchor_y = doc["anchor"].at(1).get<int>();
+            }
+        } catch (const json::exception& e) {
+            throw std::runtime_error("Maschera JSON non valida: " + path + " (" + e.what() + ")");
+        }
+    } else {
+        STBImage mask;
+        if (!mask.loadImage(path)) throw std::runtime_error("Maschera non leggibile: " + path);
+        kernel.assign(mask.height, std::vector<int>(mask.width, 0));
+        for (int i = 0; i < mask.height; i++)
+            for (int j = 0; j < mask.width; j++) kernel[i][j] = mask.image_data[(size_t)i * mask.width + j] >= 128;
+    }
+    if (kernel.empty() || kernel[0].empty()) throw std::invalid_argument("Maschera vuota: " + path);
+    for (const auto& row : kernel) {
+        if (row.size() != kernel[0].size()) throw std::invalid_argument("Righe di lunghezza diversa nella maschera: " + path);
+    }
+    return kernel;
+}
+
+StructuringElementSpec parseStructuringElementSpec(const json& object, StructuringElementSpec spec) {
+    auto read = [&object](const char* key, auto& value) {
+        auto it = object.find(key);
+        if (it == object.end() || it->is_null()) return;
+        try {
+            value = it->get<std::remove_reference_t<decltype(value)>>();
+        } catch (const json::exception&) {
+            throw std::invalid_argument(std::string("Elemento strutturante: tipo non valido per ") + key + " (" + it->dump() + ")");
+        }
+    };
+    read("shape", spec.shape);
+    read("radius", spec.radius);
+    read("width", spec.width);
+    read("height", spec.height);
+    read("length", spec.length);
+    read("angle", spec.angle);
+    read("path", spec.path);
+    read("scale", spec.scale);
+    read("anchor_x", spec.anchor_x);
+    read("anchor_y", spec.anchor_y);
+    std::vector<int> anchor;
+    read("anchor", anchor);
+    if (anchor.size() == 2) {
+        spec.anchor_x = anchor[0];
+        spec.anchor_y = anchor[1];
+    } else if (!anchor.empty()) {
+        throw std::invalid_argument("Elemento strutturante: anchor deve essere [x, y]");
+    }
+    return spec;
+}
+
+StructuringElement makeStructuringElement(const StructuringElementSpec& spec) {
+    if (spec.shape != "mask") return generateStructuringElement(spec);
+    if (spec.path.empty()) throw std::invalid_argument("L'elemento strutturante \"mask\" richiede path");
+    int anchor_x = spec.anchor_x, anchor_y = spec.anchor_y;
+    std::vector<std::vector<int>> kernel = loadMaskKernel(spec.path, anchor_x, anchor_y);
+    int mask_height = kernel.size(), mask_width = kernel[0].size();
+    // Scomposizione ricavata dalla maschera (SEDecomposition::None)
+    return StructuringElement(std::move(kernel), anchor_x >= 0 ? anchor_x : mask_width / 2, anchor_y >= 0 ? anchor_y : mask_height / 2);
+}
+
+// Altezze da JSON ({"weights": [[...]], "anchor": [x, y]}): null = spostamento fuori dal supporto
+static void loadWeights(const std::string& path, WeightedStructuringElement& se, int& anchor_x, int& anchor_y) {
+    std::ifstream file(path);
+    if (!file) throw std::runtime_error("Altezze non trovate: " + path);
+    json doc = json::parse(file, nullptr, false);
+    if (doc.is_discarded() || !doc.is_object() || !doc.contains("weights")) throw std::runtime_error("Altezze JSON non valide: " + path);
+    try {
+        for (const auto& row : doc["weights"]) {
+            se.weights.emplace_back();
+            se.support.emplace_back();
+            for (const auto& value : row) {
+                se.weights.back().push_back(value.is_null() ? 0.0 : value.get<double>());
+                se.support.back().push_back(value.is_null() ? 0 : 1);
+            }
+        }
+        if (doc.contains("anchor") && anchor_x < 0 && anchor_y < 0) {
+            anchor_x = doc["anchor"].at(0).get<int>();
+            anchor_y = doc["anchor"].at(1).get<int>();
+        }
+    } catch (const json::exception& e) {
+        throw std::runtime_error("Altezze JSON non valide: " + path + " (" + e.what() + ")");
+    }
+    if (se.weights.empty() || se.weights[0].empty()) throw std::invalid_argument("Altezze vuote: " + path);
+    for (const auto& row : se.weights) {
+        if (row.size() != se.weights[0].size()) throw std::invalid_argument("Righe di lunghezza diversa nelle altezze: " + path);
+    }
+}
+
+const std::vector<std::string>& availableWeightedShapes() {
+    static const std::vector<std::string> names = {"ball", "paraboloid", "paraboloid_unbounded", "weights"};
+    return names;
+}
+
+WeightedStructuringElement makeWeightedStructuringElement(const StructuringElementSpec& spec) {
+    WeightedStructuringElement se;
+    int r = spec.radius;
+    if (spec.shape == "ball" || spec.shape == "paraboloid" || spec.shape == "paraboloid_unbounded") {
+        if (r < 1) throw std::invalid_argument("L'elemento strutturante \"" + spec.shape + "\" richiede un raggio positivo");
+        if (!(spec.scale > 0)) throw std::invalid_argument("L'elemento strutturante \"" + spec.shape + "\" richiede scale positivo");
+        bool ball = spec.shape == "ball";
+        double k = spec.scale / (2.0 * r);
+        if (spec.shape == "paraboloid_unbounded") se.paraboloid_k = k;
+        se.support = generateStructuringElement({"disk", r}).kernel;
+        se.weights.assign(2 * r + 1, std::vector<double>(2 * r + 1, 0.0));
+        for (int i = -r; i <= r; ++i) {
+            for (int j = -r; j <= r; ++j) {
+                double d2 = i * i + j * j;
+                if (d2 <= (double)r * r)
+                    se.weights[i + r][j + r] = ball ? spec.scale * (std::sqrt((double)r * r - d2) - r) : -k * d2;
+            }
+        }
+        se.anchor_x = se.anchor_y = r;
+    } else if (spec.shape == "weights") {
+        if (spec.path.empty()) throw std::invalid_argument("L'elemento strutturante \"weights\" richiede path");
+        int anchor_x = spec.anchor_x, anchor_y = spec.anchor_y;
+        loadWeights(spec.path, se, anchor_x, anchor_y);
+        int rows = se.weights.size(), cols = se.weights[0].size();
+        se.anchor_x = anchor_x >= 0 ? anchor_x : cols / 2;
+        se.anchor_y = anchor_y >= 0 ? anchor_y : rows / 2;
+        if (se.anchor_x >= cols || se.anchor_y >= rows) throw std::invalid_argument("Ancora fuori dall'elemento strutturante");
+    } else {
+        // Forma piatta: altezze nulle sul supporto
+        StructuringElement flat = makeStructuringElement(spec);
+        se.support = flat.kernel;
+        se.weights.assign(flat.height, std::vector<double>(flat.width, 0.0));
+        se.anchor_x = flat.anchor_x;
+        se.anchor_y = flat.anchor_y;
+    }
+    se.height = se.weights.size();
+    se.width = se.weights[0].size();
+    return se;
+}
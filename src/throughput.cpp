@@ -0,0 +1,84 @@
+#include "throughput.hpp"
+
+#include <cmath>
+#include <omp.h>
+
+int activePixels(const StructuringElement& se) {
+    int count = 0;
+    for (const auto& row : se.kernel) {
+        for (int value : row) {
+            count += value == 1;
+        }
+    }
+    return count;
+}
+
+TrafficModel estimateTraffic(const std::string& operation, const StructuringElement& se, double pixels) {
+    int passes = (operation == "opening" || operation == "closing") ? 2 : 1;
+    TrafficModel model;
+    model.pixels = pixels;
+    model.bytes_read = passes * pixels;
+    model.bytes_written = passes * pixels;
+    model.ops_per_pixel = (double)passes * activePixels(se);
+    return model;
+}
+
+ThroughputMetrics computeThroughput(const TrafficModel& model, double seconds, double machine_gb_per_s) {
+    ThroughputMetrics metrics;
+    if (seconds <= 0) return metrics;
+    metrics.mpix_per_s = model.pixels / seconds / 1e6;
+    metrics.read_gb_per_s = model.bytes_read / seconds / 1e9;
+    metrics.write_gb_per_s = model.bytes_written / seconds / 1e9;
+    metrics.gops_per_s = model.ops_per_pixel * model.pixels / seconds / 1e9;
+    double bytes = model.bytes_read + model.bytes_written;
+    metrics.ops_per_byte = bytes > 0 ? model.ops_per_pixel * model.pixels / bytes : 0.0;
+    if (machine_gb_per_s > 0) {
+        metrics.bandwidth_fraction = (metrics.read_gb_per_s + metrics.write_gb_per_s) / machine_gb_per_s;
+    }
+    return metrics;
+}
+
+BandwidthProbe measureMemoryBandwidth(size_t array_mb, int reps) {
+    BandwidthProbe probe;
+    size_t n = std::max<size_t>(array_mb, 1) * (1 << 20) / sizeof(double);
+    probe.array_bytes = n * sizeof(double);
+    probe.threads = omp_get_max_threads();
+
+    // Nessuna inizializzazione nel costruttore: il first touch avviene nel ciclo parallelo,
+    // così le pagine sono distribuite fra i nodi NUMA come nei cicli misurati
+    std::unique_ptr<double[]> a(new double[n]), b(new double[n]), c(new double[n]);
+    double* pa = a.get();
+    double* pb = b.get();
+    double* pc = c.get();
+    #pragma omp parallel for schedule(static)
+    for (size_t i = 0; i < n; i++) {
+        pa[i] = 0.0;
+        pb[i] = 1.0;
+        pc[i] = 2.0;
+    }
+
+    const double scalar = 3.0;
+    double best_copy = 0.0, best_triad = 0.0;
+    for (int r = 0; r < std::max(reps, 1); r++) {
+        double start = omp_get_wtime();
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) {
+            pa[i] = pb[i];
+        }
+        double copy_time = omp_get_wtime() - start;
+
+        start = omp_get_wtime();
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < n; i++) {
+            pa[i] = pb[i] + scalar * pc[i];
+        }
+        double triad_time = omp_get_wtime() - start;
+
+        // Conteggio dei byte come in STREAM (senza il traffico di write-allocate)
+        best_copy = std::max(best_copy, 2.0 * probe.array_bytes / copy_time / 1e9);
+        best_triad = std::max(best_triad, 3.0 * probe.array_bytes / triad_time / 1e9);
+    }
+    probe.copy_gb_per_s = best_copy;
+    probe.triad_gb_per_s = best_triad;
+    return probe;
+}
@@ -0,0 +1,52 @@
+#ifndef MORPHOLOGY_THROUGHPUT_HPP
+#define MORPHOLOGY_THROUGHPUT_HPP
+
+#include "image.hpp"
+
+#include <cmath>
+
+// THROUGHPUT E BANDA
+//
+// Lo speedup rispetto alla stessa versione con un thread non dice quanto una versione sia lenta in
+// assoluto. Per ogni misura si calcolano quindi Mpix/s, GB/s letti e scritti e operazioni per pixel
+// secondo un modello del traffico minimo, e la banda raggiunta si confronta con quella della
+// macchina misurata da una sonda in stile STREAM.
+
+// Traffico e lavoro nominali di un'operazione su un insieme di immagini
+struct TrafficModel {
+    double pixels{0};           // Pixel di output
+    double bytes_read{0};       // Ogni passata legge una volta l'immagine di ingresso (1 byte/pixel)
+    double bytes_written{0};    // e scrive una volta quella di uscita
+    double ops_per_pixel{0};    // Confronti per pixel: pixel attivi dell'elemento strutturante per passata
+};
+
+// Funzione per contare i pixel attivi dell'elemento strutturante
+int activePixels(const StructuringElement& se);
+
+// Funzione per stimare il traffico di un'operazione (apertura e chiusura fanno due passate)
+TrafficModel estimateTraffic(const std::string& operation, const StructuringElement& se, double pixels);
+
+// Metriche assolute di una misura
+struct ThroughputMetrics {
+    double mpix_per_s{0};
+    double read_gb_per_s{0};
+    double write_gb_per_s{0};
+    double gops_per_s{0};       // Miliardi di confronti al secondo
+    double ops_per_byte{0};     // Intensità aritmetica (posizione sull'asse del roofline)
+    double bandwidth_fraction{NAN}; // GB/s totali rispetto alla banda della macchina (NaN se non misurata)
+};
+
+ThroughputMetrics computeThroughput(const TrafficModel& model, double seconds, double machine_gb_per_s);
+
+// Risultato della sonda di banda: migliore di più ripetizioni, in GB/s (1e9 byte/s)
+struct BandwidthProbe {
+    double copy_gb_per_s{0};    // a[i] = b[i]
+    double triad_gb_per_s{0};   // a[i] = b[i] + s * c[i]
+    size_t array_bytes{0};
+    int threads{0};
+};
+
+// Funzione per misurare la banda di memoria con array molto più grandi della cache
+BandwidthProbe measureMemoryBandwidth(size_t array_mb = 64, int reps = 5);
+
+#endif // MORPHOLOGY_THROUGHPUT_HPP
@@ -0,0 +1,212 @@
+#include "trace.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <unordered_set>
+#include <algorithm>
+#include <vector>
+
+#include "json.hpp"
+
+std::atomic<unsigned> trace_flags{0};
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t begin, end;
+    int32_t x, y;
+};
+
+// Buffer di un thread: blocchi di dimensione fissa scritti solo dal thread proprietario
+struct ThreadTraceBuffer {
+    static const size_t CHUNK_EVENTS = 4096;
+    static const size_t MAX_EVENTS = 1 << 20;
+
+    int tid;
+    std::vector<std::unique_ptr<TraceEvent[]>> chunks;
+    size_t count{0};
+    size_t dropped{0};
+
+    void push(const TraceEvent& event) {
+        if (count >= MAX_EVENTS) {
+            dropped++;
+            return;
+        }
+        if (count % CHUNK_EVENTS == 0) {
+            chunks.emplace_back(new TraceEvent[CHUNK_EVENTS]);
+        }
+        chunks[count / CHUNK_EVENTS][count % CHUNK_EVENTS] = event;
+        count++;
+    }
+};
+
+// I buffer appartengono al registro e restano validi anche dopo la fine del thread
+static std::mutex trace_registry_mutex;
+static std::vector<std::unique_ptr<ThreadTraceBuffer>> trace_buffers;
+static std::unordered_set<std::string> trace_names;
+static std::string trace_path;
+static const auto trace_origin = std::chrono::steady_clock::now();
+
+static ThreadTraceBuffer& threadBuffer() {
+    thread_local ThreadTraceBuffer* buffer = nullptr;
+    if (!buffer) {
+        std::lock_guard<std::mutex> lock(trace_registry_mutex);
+        trace_buffers.emplace_back(new ThreadTraceBuffer());
+        buffer = trace_buffers.back().get();
+        buffer->tid = trace_buffers.size();
+    }
+    return *buffer;
+}
+
+uint64_t traceNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - trace_origin).count();
+}
+
+void traceRecord(const char* name, const char* category, uint64_t begin, uint64_t end, int32_t x, int32_t y) {
+    threadBuffer().push({name, category, begin, end, x, y});
+}
+
+const char* traceIntern(const std::string& name) {
+    std::lock_guard<std::mutex> lock(trace_registry_mutex);
+    return trace_names.insert(name).first->c_str();
+}
+
+static void writeTraceAtExit() {
+    trace_flags &= ~TRACE_TIMELINE;
+    if (writeTrace(trace_path)) {
+        std::cout << "Traccia scritta in " << trace_path << std::endl;
+    }
+}
+
+void startTracing(const std::string& path) {
+    static bool registered = false;
+    trace_path = path;
+    if (!registered) {
+        std::atexit(writeTraceAtExit);
+        registered = true;
+    }
+    trace_flags |= TRACE_TIMELINE;
+}
+
+void startTracingFromEnv() {
+    const char* path = std::getenv("MORPHO_TRACE");
+    if (path && *path) startTracing(path);
+}
+
+bool writeTrace(const std::string& path) {
+    std::ofstream out(path, std::ofstream::trunc);
+    if (!out) {
+        std::cerr << "Impossibile scrivere la traccia in " << path << std::endl;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(trace_registry_mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"morphology\"}}";
+    char line[128];
+    for (const auto& buffer : trace_buffers) {
+        out << ",\n{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << buffer->tid
+            << ",\"args\":{\"name\":\"thread " << buffer->tid << "\",\"dropped_events\":" << buffer->dropped << "}}";
+        for (size_t i = 0; i < buffer->count; i++) {
+            const TraceEvent& e = buffer->chunks[i / ThreadTraceBuffer::CHUNK_EVENTS][i % ThreadTraceBuffer::CHUNK_EVENTS];
+            // Tempi in microsecondi come richiesto dal formato
+            std::snprintf(line, sizeof(line), "\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                buffer->tid, e.begin / 1000.0, (e.end - e.begin) / 1000.0);
+            out << ",\n{\"name\":" << nlohmann::json(e.name).dump() << ",\"cat\":\"" << e.category << "\"," << line;
+            if (e.x >= 0 || e.y >= 0) {
+                out << ",\"args\":{\"x\":" << e.x << ",\"y\":" << e.y << "}";
+            }
+            out << "}";
+        }
+    }
+    out << "\n]}\n";
+    return (bool)out;
+}
+
+// BILANCIAMENTO DEL CARICO
+
+// Contatori di un thread su una propria linea di cache, scritti solo dal thread proprietario
+struct alignas(64) BalanceSlot {
+    ThreadBalance counters;
+};
+
+static std::mutex balance_registry_mutex;
+static std::vector<std::unique_ptr<BalanceSlot>> balance_slots;
+
+static ThreadBalance& threadBalance() {
+    thread_local BalanceSlot* slot = nullptr;
+    if (!slot) {
+        std::lock_guard<std::mutex> lock(balance_registry_mutex);
+        balance_slots.emplace_back(new BalanceSlot());
+        slot = balance_slots.back().get();
+    }
+    return slot->counters;
+}
+
+void balanceBegin(const char* category) {
+    if (std::strcmp(category, "stage") == 0) threadBalance().depth++;
+}
+
+void balanceRecord(const char* category, uint64_t duration) {
+    ThreadBalance& balance = threadBalance();
+    if (std::strcmp(category, "stage") == 0) {
+        if (--balance.depth == 0) {
+            balance.compute_ns += duration;
+            balance.regions++;
+        }
+    } else if (std::strcmp(category, "sync") == 0) {
+        // Le barriere delle regioni annidate (squadre di un thread) fanno parte del calcolo esterno
+        if (balance.depth == 0) balance.barrier_ns += duration;
+    } else if (std::strcmp(category, "lock") == 0) {
+        balance.lock_ns += duration;
+    } else if (std::strcmp(category, "tile") == 0 || std::strcmp(category, "image") == 0) {
+        if (balance.depth == 1) balance.iterations++;
+    }
+}
+
+void balanceCountIterations(uint64_t iterations) {
+    ThreadBalance& balance = threadBalance();
+    if (balance.depth == 1) balance.iterations += iterations;
+}
+
+void startBalance() {
+    {
+        std::lock_guard<std::mutex> lock(balance_registry_mutex);
+        for (auto& slot : balance_slots) slot->counters = ThreadBalance();
+    }
+    trace_flags |= TRACE_BALANCE;
+}
+
+BalanceReport stopBalance() {
+    trace_flags &= ~TRACE_BALANCE;
+    BalanceReport report;
+    std::lock_guard<std::mutex> lock(balance_registry_mutex);
+    for (const auto& slot : balance_slots) {
+        if (slot->counters.regions > 0) report.threads.push_back(slot->counters);
+    }
+    if (report.threads.empty()) return report;
+
+    double n = report.threads.size();
+    double compute = 0, max_compute = 0, iterations = 0, max_iterations = 0, barrier = 0, lock_time = 0;
+    for (const auto& t : report.threads) {
+        compute += t.compute_ns;
+        max_compute = std::max(max_compute, (double)t.compute_ns);
+        iterations += t.iterations;
+        max_iterations = std::max(max_iterations, (double)t.iterations);
+        barrier += t.barrier_ns;
+        lock_time += t.lock_ns;
+    }
+    if (compute > 0) report.imbalance = max_compute / (compute / n);
+    if (iterations > 0) report.iteration_imbalance = max_iterations / (iterations / n);
+    if (compute + barrier > 0) {
+        report.barrier_wait_fraction = barrier / (compute + barrier);
+        report.lock_fraction = lock_time / (compute + barrier);
+    }
+    return report;
+}
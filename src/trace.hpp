@@ -0,0 +1,120 @@
+#ifndef MORPHOLOGY_TRACE_HPP
+#define MORPHOLOGY_TRACE_HPP
+
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// TIMELINE DI ESECUZIONE (Chrome trace / Perfetto)
+//
+// I punti di traccia sono intervalli con nome e categoria ("kernel", "stage", "tile", "sync", "io", ...)
+// registrati da TraceScope con l'ora di inizio e di fine. Ogni thread scrive in un proprio buffer
+// senza lock; i buffer vengono letti solo a fine esecuzione e scritti come JSON apribile con
+// chrome://tracing o ui.perfetto.dev. Con la traccia disattivata un punto costa una lettura atomica.
+//
+// Gli stessi punti alimentano il bilanciamento del carico delle regioni parallele: per ogni thread
+// il tempo di calcolo delle fasi ("stage"), l'attesa alle barriere ("sync"), il tempo nelle sezioni
+// critiche ("lock") e le iterazioni eseguite (tile, immagini o pixel dei cicli condivisi).
+// Nelle regioni annidate conta solo la fase più esterna, che contiene le altre.
+
+// Strumenti attivi: una sola lettura atomica decide se un punto di traccia registra qualcosa
+enum TraceFlags : unsigned { TRACE_TIMELINE = 1, TRACE_BALANCE = 2 };
+
+extern std::atomic<unsigned> trace_flags;
+
+inline bool traceEnabled() {
+    return trace_flags.load(std::memory_order_relaxed) & TRACE_TIMELINE;
+}
+
+inline bool balanceEnabled() {
+    return trace_flags.load(std::memory_order_relaxed) & TRACE_BALANCE;
+}
+
+// Funzione per attivare la traccia; il file viene scritto all'uscita del processo
+void startTracing(const std::string& path);
+
+// Funzione per attivare la traccia se la variabile d'ambiente MORPHO_TRACE contiene un percorso
+void startTracingFromEnv();
+
+// Funzione per scrivere subito gli eventi registrati finora
+bool writeTrace(const std::string& path);
+
+// Funzione per ottenere un nome stabile da usare negli eventi (i nomi devono sopravvivere al punto di traccia)
+const char* traceIntern(const std::string& name);
+
+uint64_t traceNow();
+void traceRecord(const char* name, const char* category, uint64_t begin, uint64_t end, int32_t x, int32_t y);
+void balanceBegin(const char* category);
+void balanceRecord(const char* category, uint64_t duration);
+
+// Funzione per aggiungere le iterazioni contate da un thread in un ciclo condiviso della fase corrente
+void balanceCountIterations(uint64_t iterations);
+
+inline void balanceAddIterations(uint64_t iterations) {
+    if (balanceEnabled()) balanceCountIterations(iterations);
+}
+
+// Contatori di un thread, azzerati da startBalance()
+struct ThreadBalance {
+    uint64_t compute_ns{0};     // Fasi più esterne (lavoro fino alla barriera, senza l'attesa)
+    uint64_t barrier_ns{0};     // Attesa alle barriere dopo le fasi più esterne
+    uint64_t lock_ns{0};        // Attesa ed esecuzione delle sezioni critiche (incluso in compute_ns)
+    uint64_t iterations{0};     // Iterazioni dei cicli condivisi della fase più esterna
+    uint64_t regions{0};        // Fasi più esterne eseguite
+    int depth{0};               // Fasi annidate aperte
+};
+
+// Bilanciamento di un insieme di esecuzioni, sui thread che hanno eseguito almeno una fase
+struct BalanceReport {
+    std::vector<ThreadBalance> threads;
+    double imbalance{NAN};              // Calcolo massimo / medio
+    double iteration_imbalance{NAN};    // Iterazioni massime / medie
+    double barrier_wait_fraction{NAN};  // Attesa alle barriere / (calcolo + attesa), sommati sui thread
+    double lock_fraction{NAN};          // Sezioni critiche / (calcolo + attesa)
+};
+
+// Funzione per azzerare e attivare la raccolta (da chiamare fuori dalle regioni parallele)
+void startBalance();
+
+// Funzione per disattivare la raccolta e riassumere i contatori
+BalanceReport stopBalance();
+
+// Intervallo di traccia: inizia alla costruzione e termina con end() o alla distruzione.
+// x e y (opzionali) indicano la posizione del lavoro, ad esempio l'angolo di un tile.
+class TraceScope {
+public:
+    TraceScope(const char* name, const char* category, int32_t x = -1, int32_t y = -1)
+        : name(name), category(category), x(x), y(y) {
+        unsigned flags = trace_flags.load(std::memory_order_relaxed);
+        if (flags) {
+            active = flags;
+            if (flags & TRACE_BALANCE) balanceBegin(category);
+            begin = traceNow();
+        }
+    }
+
+    ~TraceScope() { end(); }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+    void end() {
+        if (active) {
+            uint64_t now = traceNow();
+            if (active & TRACE_TIMELINE) traceRecord(name, category, begin, now, x, y);
+            if (active & TRACE_BALANCE) balanceRecord(category, now - begin);
+            active = 0;
+        }
+    }
+
+private:
+    const char* name;
+    const char* category;
+    int32_t x, y;
+    uint64_t begin{0};
+    unsigned active{0};         // Strumenti attivi all'inizio dell'intervallo
+};
+
+#endif // MORPHOLOGY_TRACE_HPP
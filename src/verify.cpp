@@ -0,0 +1,503 @@
+#include "verify.hpp"
+#include "morphology.hpp"
+#include "cli.hpp"
+
+#include <random>
+#include <limits>
+#include <cmath>
+#include <omp.h>
+
+uint64_t hashImage(const STBImage& img) {
+    const uint64_t P1 = 0x9E3779B185EBCA87ull, P2 = 0xC2B2AE3D27D4EB4Full;
+    auto rotl = [](uint64_t v, int r) { return (v << r) | (v >> (64 - r)); };
+    size_t n = (size_t)img.width * img.height * std::max(img.channels, 1);
+    const uint8_t* data = img.image_data;
+
+    // Quattro accumulatori indipendenti per sfruttare il parallelismo a livello di istruzione
+    uint64_t lanes[4] = {P1 + P2, P2, 0, (uint64_t)0 - P1};
+    size_t i = 0;
+    if (data) {
+        for (; i + 32 <= n; i += 32) {
+            for (int l = 0; l < 4; l++) {
+                uint64_t w;
+                std::memcpy(&w, data + i + 8 * l, 8);
+                lanes[l] = rotl(lanes[l] + w * P2, 31) * P1;
+            }
+        }
+    }
+    uint64_t h = rotl(lanes[0], 1) + rotl(lanes[1], 7) + rotl(lanes[2], 12) + rotl(lanes[3], 18);
+    h ^= ((uint64_t)img.width << 32) | (uint32_t)img.height;
+    for (; data && i < n; i++) {
+        h = rotl(h ^ (data[i] * P1), 11) * P2;
+    }
+    h ^= n;
+    h ^= h >> 33;
+    h *= P2;
+    h ^= h >> 29;
+    h *= P1;
+    h ^= h >> 32;
+    return h;
+}
+
+bool findFirstDifference(const STBImage& a, const STBImage& b, int& x, int& y) {
+    if (a.width != b.width || a.height != b.height) {
+        x = y = -1;
+        return true;
+    }
+    size_t n = (size_t)a.width * a.height;
+    for (size_t i = 0; i < n; i++) {
+        if (a.image_data[i] != b.image_data[i]) {
+            x = i % a.width;
+            y = i / a.width;
+            return true;
+        }
+    }
+    return false;
+}
+
+STBImage cropImage(const STBImage& img, int x0, int y0, int w, int h) {
+    STBImage crop;
+    crop.initializeBinary(w, h, 0);
+    crop.filename = img.filename;
+    for (int y = 0; y < h; y++) {
+        std::memcpy(crop.image_data + (size_t)y * w, img.image_data + (size_t)(y0 + y) * img.width + x0, w);
+    }
+    return crop;
+}
+
+// Maschera a rumore uniforme con la densità di primo piano indicata
+static STBImage generateNoiseImage(int width, int height, double density, std::mt19937& rng) {
+    STBImage img;
+    img.initializeBinary(width, height, 0);
+    std::bernoulli_distribution foreground(density);
+    for (size_t i = 0; i < (size_t)width * height; i++) {
+        img.image_data[i] = foreground(rng) ? 255 : 0;
+    }
+    return img;
+}
+
+// Caso di verifica: immagine, elemento strutturante e combinazione da confrontare con V1
+struct VerifyCase {
+    const StructuringElement* se;
+    std::string op, engine;
+    int threads, tile_size;
+};
+
+static STBImage runCase(const STBImage& input, const VerifyCase& c, const std::string& engine) {
+    omp_set_num_threads(c.threads);
+    return applyOperation(input, *c.se, c.op, engine, c.tile_size, DEFAULT_BACKGROUND_COLOR);
+}
+
+static bool reproduces(const STBImage& input, const VerifyCase& c) {
+    if (input.width < c.se->width || input.height < c.se->height) return false;
+    STBImage expected = runCase(input, c, "V1");
+    STBImage actual = runCase(input, c, c.engine);
+    int x, y;
+    return findFirstDifference(expected, actual, x, y);
+}
+
+// Funzione per ridurre l'input al più piccolo ritaglio che riproduce ancora la differenza,
+// poi azzerare i blocchi di pixel non necessari
+static STBImage minimizeReproducer(const STBImage& input, int fx, int fy, const VerifyCase& c) {
+    int reach = std::max(c.se->anchor_x, c.se->anchor_y) * ((c.op == "opening" || c.op == "closing") ? 2 : 1);
+    STBImage best = input;
+    for (int margin = reach + std::max(c.se->anchor_x, c.se->anchor_y) + 1; ; margin *= 2) {
+        int x0 = std::max(0, fx - margin), y0 = std::max(0, fy - margin);
+        int x1 = std::min(input.width, fx + margin + 1), y1 = std::min(input.height, fy + margin + 1);
+        if (x0 == 0 && y0 == 0 && x1 == input.width && y1 == input.height) break;
+        STBImage crop = cropImage(input, x0, y0, x1 - x0, y1 - y0);
+        if (reproduces(crop, c)) {
+            best = std::move(crop);
+            break;
+        }
+    }
+
+    int min_block = std::max(1, std::max(best.width, best.height) / 16);
+    for (int block = std::max(best.width, best.height) / 2; block >= min_block; block /= 2) {
+        for (int by = 0; by < best.height; by += block) {
+            for (int bx = 0; bx < best.width; bx += block) {
+                STBImage trial = best;
+                bool changed = false;
+                for (int y = by; y < std::min(by + block, best.height); y++) {
+                    for (int x = bx; x < std::min(bx + block, best.width); x++) {
+                        uint8_t& p = trial.image_data[(size_t)y * best.width + x];
+                        changed |= p != 0;
+                        p = 0;
+                    }
+                }
+                if (changed && reproduces(trial, c)) best = std::move(trial);
+            }
+        }
+    }
+    return best;
+}
+
+static void writeReproducer(const std::string& dir, const STBImage& input, const VerifyCase& c,
+    const std::string& se_shape, int se_radius, int fx, int fy) {
+    createPath(dir);
+    STBImage expected = runCase(input, c, "V1");
+    STBImage actual = runCase(input, c, c.engine);
+    int x = -1, y = -1;
+    findFirstDifference(expected, actual, x, y);
+    if (!input.saveImage(dir + "/input.pgm") || !expected.saveImage(dir + "/expected.pgm")
+        || !actual.saveImage(dir + "/actual.pgm")) {
+        std::cerr << "Scrittura del riproduttore non riuscita in " << dir << std::endl;
+    }
+    json info = {
+        {"operation", c.op}, {"engine", c.engine}, {"threads", c.threads}, {"tile_size", c.tile_size},
+        {"se_shape", se_shape}, {"se_radius", se_radius},
+        {"original_first_difference", {fx, fy}},
+        {"reproducer_size", {input.width, input.height}},
+        {"reproducer_first_difference", {x, y}}
+    };
+    std::ofstream(dir + "/info.json") << info.dump(2) << std::endl;
+}
+
+// Riferimento in scala di grigi: minimo/massimo sui pixel attivi scandendo tutto il kernel, con il bordo di V1
+template <typename T>
+static GrayImage<T> referenceGray(const GrayImage<T>& img, const StructuringElement& se, bool erode, T background) {
+    GrayImage<T> result;
+    result.initialize(img.width, img.height, background);
+    for (int y = se.anchor_y; y < img.height - se.anchor_y; y++) {
+        for (int x = se.anchor_x; x < img.width - se.anchor_x; x++) {
+            bool any = false;
+            T value{};
+            for (int i = 0; i < se.height; i++) {
+                for (int j = 0; j < se.width; j++) {
+                    if (se.kernel[i][j] != 1) continue;
+                    T p = img.data[(size_t)(y + i - se.anchor_y) * img.width + x + j - se.anchor_x];
+                    value = !any ? p : erode ? std::min(value, p) : std::max(value, p);
+                    any = true;
+                }
+            }
+            if (!any) value = erode ? (std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max())
+                                    : (std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest());
+            result.data[(size_t)y * img.width + x] = value;
+        }
+    }
+    return result;
+}
+
+template <typename T>
+static GrayImage<T> referenceGrayOperation(const GrayImage<T>& img, const StructuringElement& se, const std::string& op, T background) {
+    if (op == "erosion") return referenceGray(img, se, true, background);
+    if (op == "dilation") return referenceGray(img, se, false, background);
+    if (op == "opening") return referenceGray(referenceGray(img, se, true, background), se, false, background);
+    return referenceGray(referenceGray(img, se, false, background), se, true, background);
+}
+
+// Immagine in scala di grigi: rumore uniforme sull'intervallo del tipo, oppure gradini (molti valori
+// uguali, per verificare i pareggi) con poco rumore
+template <typename T>
+static GrayImage<T> generateGrayImage(int width, int height, bool steps, std::mt19937& rng) {
+    GrayImage<T> img;
+    img.initialize(width, height, T{});
+    double top = std::is_floating_point_v<T> ? 1.0 : (double)std::numeric_limits<T>::max();
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            double u = steps ? std::floor(8.0 * (x + 2 * y) / (width + 2 * height)) / 8.0 + (uniform(rng) < 0.02 ? 0.1 : 0.0) : uniform(rng);
+            double value = std::is_floating_point_v<T> ? u * 2.0 - 0.5 : std::min(u, 1.0) * top;
+            img.data[(size_t)y * width + x] = (T)value;
+        }
+    }
+    return img;
+}
+
+// Funzione per verificare le operazioni *_gray di un tipo di pixel; aggiorna confronti e differenze
+template <typename T>
+static void verifyGrayscale(const VerifyOptions& options, const std::string& type, const std::vector<std::string>& ops,
+                            const std::vector<int>& threads, std::mt19937& rng, int& checks, int& mismatches) {
+    const std::pair<MinMaxPath, const char*> paths[] = {{MinMaxPath::Direct, "direct"}, {MinMaxPath::Decomposed, "decomposed"}};
+    for (const auto& [width, height] : options.sizes) {
+        std::vector<GrayImage<T>> inputs;
+        for (int i = 0; i < options.images; i++) inputs.push_back(generateGrayImage<T>(width, height, i % 2 == 1, rng));
+        for (const auto& shape : options.shapes) {
+            for (int radius : options.radii) {
+                StructuringElement se(makeStructuringElement({shape, radius}));
+                if (se.width > width || se.height > height) continue;
+                for (const auto& op : ops) {
+                    for (size_t i = 0; i < inputs.size(); i++) {
+                        GrayImage<T> reference = referenceGrayOperation(inputs[i], se, op, T{});
+                        for (const auto& [path, path_name] : paths) {
+                            // Sequenziale, poi in parallelo con ogni numero di thread
+                            for (int t = 0; t <= (int)threads.size(); t++) {
+                                bool parallel = t > 0;
+                                omp_set_num_threads(parallel ? threads[t - 1] : 1);
+                                GrayImage<T> actual =
+                                    op == "erosion" ? erosion_gray(inputs[i], se, T{}, path, parallel) :
+                                    op == "dilation" ? dilation_gray(inputs[i], se, T{}, path, parallel) :
+                                    op == "opening" ? opening_gray(inputs[i], se, T{}, path, parallel) :
+                                    closing_gray(inputs[i], se, T{}, path, parallel);
+                                checks++;
+                                auto diff = std::mismatch(reference.data.begin(), reference.data.end(), actual.data.begin());
+                                if (diff.first == reference.data.end()) continue;
+                                mismatches++;
+                                size_t index = diff.first - reference.data.begin();
+                                std::cout << "MISMATCH " << op << "_gray " << type << " " << path_name
+                                          << " threads=" << (parallel ? threads[t - 1] : 1) << " " << shape << radius
+                                          << " " << width << "x" << height << " immagine " << i << ": primo pixel diverso ("
+                                          << index % width << "," << index / width << ") atteso " << +*diff.first
+                                          << " ottenuto " << +*diff.second << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Riferimento non piatto: somma saturata e minimo/massimo su tutti gli spostamenti del supporto nell'immagine
+template <typename T>
+static GrayImage<T> referenceWeighted(const GrayImage<T>& img, const WeightedStructuringElement& se, bool erode) {
+    GrayImage<T> result;
+    result.initialize(img.width, img.height, T{});
+    for (int y = 0; y < img.height; y++) {
+        for (int x = 0; x < img.width; x++) {
+            bool any = false;
+            T value{};
+            for (int i = 0; i < se.height; i++) {
+                for (int j = 0; j < se.width; j++) {
+                    int ny = y + i - se.anchor_y, nx = x + j - se.anchor_x;
+                    if (se.support[i][j] != 1 || ny < 0 || ny >= img.height || nx < 0 || nx >= img.width) continue;
+                    T p = img.data[(size_t)ny * img.width + nx], v;
+                    if constexpr (std::is_floating_point_v<T>) v = p + (T)(erode ? -se.weights[i][j] : se.weights[i][j]);
+                    else v = (T)std::clamp<long>(p + std::lround(erode ? -se.weights[i][j] : se.weights[i][j]), 0, std::numeric_limits<T>::max());
+                    value = !any ? v : erode ? std::min(value, v) : std::max(value, v);
+                    any = true;
+                }
+            }
+            if (!any) value = erode ? (std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max())
+                                    : (std::numeric_limits<T>::has_infinity ? -std::numeric_limits<T>::infinity() : std::numeric_limits<T>::lowest());
+            result.data[(size_t)y * img.width + x] = value;
+        }
+    }
+    return result;
+}
+
+// Riferimento del paraboloide a supporto illimitato: minimo su tutti i pixel dell'immagine, in doppia
+// precisione e con le somme nello stesso ordine del percorso separabile (prima x, poi y)
+template <typename T>
+static GrayImage<T> referenceParaboloid(const GrayImage<T>& img, double k, bool erode) {
+    GrayImage<T> result;
+    result.initialize(img.width, img.height, T{});
+    double sign = erode ? 1.0 : -1.0;
+    for (int y = 0; y < img.height; y++) {
+        for (int x = 0; x < img.width; x++) {
+            double best = std::numeric_limits<double>::infinity();
+            for (int ny = 0; ny < img.height; ny++) {
+                for (int nx = 0; nx < img.width; nx++) {
+                    int dx = x - nx, dy = y - ny;
+                    best = std::min(best, (sign * img.data[(size_t)ny * img.width + nx] + k * (double)(dx * dx)) + k * (double)(dy * dy));
+                }
+            }
+            double value = sign * best;
+            if constexpr (std::is_floating_point_v<T>) result.data[(size_t)y * img.width + x] = (T)value;
+            else result.data[(size_t)y * img.width + x] = (T)std::clamp(std::nearbyint(value), 0.0, (double)std::numeric_limits<T>::max());
+        }
+    }
+    return result;
+}
+
+// Funzione per verificare le operazioni *_weighted di un tipo di pixel; aggiorna confronti e differenze
+template <typename T>
+static void verifyWeighted(const VerifyOptions& options, const std::string& type, const std::vector<int>& threads,
+                           std::mt19937& rng, int& checks, int& mismatches) {
+    // Altezze nelle unità del tipo: per i float le immagini sono in 0..1 circa
+    double scale = std::is_floating_point_v<T> ? 0.05 : std::is_same_v<T, uint8_t> ? 4.0 : 1000.0;
+    for (const auto& [width, height] : options.sizes) {
+        std::vector<GrayImage<T>> inputs;
+        for (int i = 0; i < options.images; i++) inputs.push_back(generateGrayImage<T>(width, height, i % 2 == 1, rng));
+        // Elementi: sfere e paraboloidi (troncati e illimitati) per ogni raggio positivo, forme piatte per ogni raggio
+        std::vector<std::pair<std::string, StructuringElementSpec>> elements;
+        for (int radius : options.radii) {
+            for (std::string shape : {"ball", "paraboloid", "paraboloid_unbounded"}) {
+                if (radius < 1) continue;
+                StructuringElementSpec spec;
+                spec.shape = shape;
+                spec.radius = radius;
+                spec.scale = scale;
+                elements.emplace_back(shape + std::to_string(radius), spec);
+            }
+            for (const auto& shape : options.shapes) {
+                StructuringElementSpec spec;
+                spec.shape = shape;
+                spec.radius = radius;
+                elements.emplace_back(shape + std::to_string(radius), spec);
+            }
+        }
+        for (const auto& [name, spec] : elements) {
+            WeightedStructuringElement se = makeWeightedStructuringElement(spec);
+            for (bool erode : {true, false}) {
+                for (size_t i = 0; i < inputs.size(); i++) {
+                    // Percorso scelto (Auto) e percorso esplicito dell'elemento, con il riferimento della sua forma
+                    WeightedPath exact = se.paraboloid_k > 0 ? WeightedPath::Separable : WeightedPath::Direct;
+                    GrayImage<T> expected = se.paraboloid_k > 0 ? referenceParaboloid(inputs[i], se.paraboloid_k, erode)
+                                                                : referenceWeighted(inputs[i], se, erode);
+                    std::vector<std::pair<WeightedPath, GrayImage<T>>> cases{{WeightedPath::Auto, expected}, {exact, expected}};
+                    for (const auto& [path, reference] : cases) {
+                        for (int t = 0; t <= (int)threads.size(); t++) {
+                            bool parallel = t > 0;
+                            omp_set_num_threads(parallel ? threads[t - 1] : 1);
+                            GrayImage<T> actual = erode ? erosion_weighted(inputs[i], se, path, parallel) : dilation_weighted(inputs[i], se, path, parallel);
+                            checks++;
+                            auto diff = std::mismatch(reference.data.begin(), reference.data.end(), actual.data.begin());
+                            if (diff.first == reference.data.end()) continue;
+                            mismatches++;
+                            size_t index = diff.first - reference.data.begin();
+                            std::cout << "MISMATCH " << (erode ? "erosion" : "dilation") << "_weighted " << type << " "
+                                      << (path == WeightedPath::Auto ? "auto" : path == WeightedPath::Direct ? "direct" : "separable") << " threads=" << (parallel ? threads[t - 1] : 1)
+                                      << " " << name << " " << width << "x" << height << " immagine " << i << ": primo pixel diverso ("
+                                      << index % width << "," << index / width << ") atteso " << +*diff.first
+                                      << " ottenuto " << +*diff.second << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+int runVerification(const VerifyOptions& options) {
+    std::vector<std::string> ops = options.ops.empty() ? availableOperations() : options.ops;
+    std::vector<std::string> engines = options.engines;
+    if (engines.empty()) {
+        for (const auto& mode : availableModes())
+            if (mode != "V1") engines.push_back(mode);
+    }
+    std::vector<int> threads = options.threads;
+    if (threads.empty()) {
+        threads.push_back(1);
+        if (omp_get_max_threads() > 1) threads.push_back(omp_get_max_threads());
+    }
+    int max_threads = omp_get_max_threads();
+
+    std::mt19937 rng(options.seed);
+    srand(options.seed);
+    int mismatches = 0, checks = 0;
+
+    if (!options.pixel_types.empty()) {
+        for (const auto& type : options.pixel_types) {
+            if (type == "uint8" && options.weighted) verifyWeighted<uint8_t>(options, type, threads, rng, checks, mismatches);
+            else if (type == "uint16" && options.weighted) verifyWeighted<uint16_t>(options, type, threads, rng, checks, mismatches);
+            else if (type == "float" && options.weighted) verifyWeighted<float>(options, type, threads, rng, checks, mismatches);
+            else if (type == "uint8") verifyGrayscale<uint8_t>(options, type, ops, threads, rng, checks, mismatches);
+            else if (type == "uint16") verifyGrayscale<uint16_t>(options, type, ops, threads, rng, checks, mismatches);
+            else if (type == "float") verifyGrayscale<float>(options, type, ops, threads, rng, checks, mismatches);
+            else {
+                std::cerr << "Tipo di pixel sconosciuto: " << type << std::endl;
+                mismatches++;
+            }
+        }
+        omp_set_num_threads(max_threads);
+        std::cout << checks << " confronti, " << mismatches << " differenze" << std::endl;
+        return mismatches;
+    }
+
+    for (const auto& [width, height] : options.sizes) {
+        // Maschere a forme (stile generateBinaryImages) e a rumore con densità diverse
+        std::vector<STBImage> inputs;
+        const double densities[] = {0.05, 0.5, 0.95};
+        for (int i = 0; i < options.images; i++) {
+            if (i % 2 == 0) {
+                inputs.push_back(generateBinaryImage(width, height, 3 + i, 255));
+            } else {
+                inputs.push_back(generateNoiseImage(width, height, densities[(i / 2) % 3], rng));
+            }
+            inputs.back().filename = "case_" + std::to_string(width) + "x" + std::to_string(height) + "_" + std::to_string(i);
+        }
+
+        for (const auto& shape : options.shapes) {
+            for (int radius : options.radii) {
+                StructuringElement se(makeStructuringElement({shape, radius}));
+                if (se.width > width || se.height > height) continue;
+                for (const auto& op : ops) {
+                    for (const auto& input : inputs) {
+                        omp_set_num_threads(max_threads);
+                        STBImage reference = applyOperation(input, se, op, "V1", 64, DEFAULT_BACKGROUND_COLOR);
+                        uint64_t reference_hash = hashImage(reference);
+                        if (options.hash_only) reference.freeImage();
+
+                        for (const auto& engine : engines) {
+                            bool parallel = engine.find("_parallel") != std::string::npos;
+                            bool tiled = engine.find("V3") != std::string::npos;
+                            std::vector<int> thread_list = parallel ? threads : std::vector<int>{1};
+                            std::vector<int> tile_list = tiled ? options.tile_sizes : std::vector<int>{64};
+                            for (int t : thread_list) {
+                                for (int tile : tile_list) {
+                                    VerifyCase c{&se, op, engine, t, tile};
+                                    STBImage actual = runCase(input, c, engine);
+                                    checks++;
+                                    if (hashImage(actual) == reference_hash) continue;
+
+                                    // Differenza: il riferimento serve per individuare il primo pixel
+                                    if (options.hash_only) reference = runCase(input, c, "V1");
+                                    int fx, fy;
+                                    if (!findFirstDifference(reference, actual, fx, fy)) continue;
+                                    mismatches++;
+                                    std::cout << "MISMATCH " << op << " " << engine << " threads=" << t << " tile=" << tile
+                                              << " " << shape << radius << " " << input.filename
+                                              << ": primo pixel diverso (" << fx << "," << fy << ") atteso "
+                                              << (fx >= 0 ? (int)reference.image_data[(size_t)fy * width + fx] : -1)
+                                              << " ottenuto " << (fx >= 0 ? (int)actual.image_data[(size_t)fy * width + fx] : -1)
+                                              << std::endl;
+                                    if (fx >= 0) {
+                                        STBImage reproducer = minimizeReproducer(input, fx, fy, c);
+                                        std::string dir = options.failure_dir + "/" + op + "_" + engine + "_t" + std::to_string(t) +
+                                            "_tile" + std::to_string(tile) + "_" + shape + std::to_string(radius) + "_" + input.filename;
+                                        writeReproducer(dir, reproducer, c, shape, radius, fx, fy);
+                                        std::cout << "  riproduttore " << reproducer.width << "x" << reproducer.height << " in " << dir << std::endl;
+                                    }
+                                    if (options.hash_only) reference.freeImage();
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+    omp_set_num_threads(max_threads);
+
+    std::cout << checks << " confronti, " << mismatches << " differenze" << std::endl;
+    return mismatches;
+}
+
+int runVerifyCommand(int argc, char* argv[]) {
+    VerifyOptions options;
+    for (int i = 0; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--hash-only") {
+            options.hash_only = true;
+            continue;
+        }
+        if (arg == "--weighted") {
+            // Senza --pixel-types si verificano tutti i tipi
+            options.weighted = true;
+            if (options.pixel_types.empty()) options.pixel_types = {"uint8", "uint16", "float"};
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Valore mancante o opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+        std::string value = argv[++i];
+        if (arg == "--sizes") options.sizes = parseSizeList(value);
+        else if (arg == "--radii") options.radii = parseIntList(value);
+        else if (arg == "--shapes") options.shapes = splitList(value);
+        else if (arg == "--ops") options.ops = splitList(value);
+        else if (arg == "--engines") options.engines = splitList(value);
+        else if (arg == "--threads") options.threads = parseIntList(value);
+        else if (arg == "--tile-sizes") options.tile_sizes = parseIntList(value);
+        else if (arg == "--pixel-types") options.pixel_types = splitList(value);
+        else if (arg == "--images") options.images = std::stoi(value);
+        else if (arg == "--seed") options.seed = std::stoul(value);
+        else if (arg == "--out") options.failure_dir = value;
+        else {
+            std::cerr << "Opzione sconosciuta: " << arg << std::endl;
+            return 2;
+        }
+    }
+    return runVerification(options) == 0 ? 0 : 1;
+}
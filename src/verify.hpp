@@ -0,0 +1,47 @@
+#ifndef MORPHOLOGY_VERIFY_HPP
+#define MORPHOLOGY_VERIFY_HPP
+
+#include "image.hpp"
+
+// VERIFICA DIFFERENZIALE
+//
+// Ogni versione (V2, V3, parallele, ...) viene eseguita su maschere casuali e confrontata bit a bit
+// con il riferimento V1 (erosion_V1 / dilation_V1 e composizioni). In caso di differenza vengono
+// riportati il primo pixel diverso e un riproduttore minimizzato salvato su disco.
+// Con --pixel-types le operazioni *_gray, con entrambi i percorsi, si confrontano invece con un minimo/
+// massimo diretto su immagini a rumore e a gradini (solo il primo pixel diverso, senza riproduttore).
+// Con --weighted si verificano le operazioni *_weighted: il percorso diretto con sfere, paraboloidi
+// troncati e forme piatte, il paraboloide illimitato (separabile) con il minimo su tutta l'immagine.
+
+struct VerifyOptions {
+    std::vector<std::pair<int, int>> sizes{{64, 64}, {131, 97}, {256, 256}};
+    std::vector<int> radii{1, 2, 5};
+    std::vector<std::string> shapes{"disk", "square", "cross", "diamond", "octagon", "ellipse", "rectangle", "line"}; // "mask" richiede un file
+    std::vector<std::string> ops{};         // Vuoto = tutte le operazioni
+    std::vector<std::string> engines{};     // Vuoto = tutte le versioni tranne V1
+    std::vector<int> threads{};             // Vuoto = 1 e il massimo disponibile
+    std::vector<int> tile_sizes{7, 64};
+    std::vector<std::string> pixel_types{}; // Non vuoto = verifica in scala di grigi (uint8, uint16, float) al posto di quella binaria
+    bool weighted{false};                   // Con pixel_types: elementi non piatti al posto di quelli piatti
+    int images{4};                          // Immagini per dimensione: metà a forme, metà a rumore
+    unsigned seed{1};
+    bool hash_only{false};                  // Confronta solo gli hash, senza tenere i riferimenti completi
+    std::string failure_dir{"verify_failures"};
+};
+
+// Funzione per calcolare un hash veloce a 64 bit di dimensioni e pixel di un'immagine
+uint64_t hashImage(const STBImage& img);
+
+// Funzione per trovare il primo pixel diverso fra due immagini (false se identiche)
+bool findFirstDifference(const STBImage& a, const STBImage& b, int& x, int& y);
+
+// Funzione per ritagliare una regione di un'immagine
+STBImage cropImage(const STBImage& img, int x0, int y0, int w, int h);
+
+// Funzione per eseguire la verifica; restituisce il numero di differenze trovate
+int runVerification(const VerifyOptions& options);
+
+// Funzione per leggere le opzioni di "verify" da riga di comando ed eseguire la verifica
+int runVerifyCommand(int argc, char* argv[]);
+
+#endif // MORPHOLOGY_VERIFY_HPP
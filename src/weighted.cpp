@@ -0,0 +1,194 @@
+#include "morphology.hpp"
+
+#include "trace.hpp"
+
+#include <omp.h>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+// ELEMENTI STRUTTURANTI NON PIATTI
+//
+// Percorso diretto: per ogni spostamento b del supporto una passata vettorizzata sulla riga che somma
+// l'altezza, satura all'intervallo del tipo e tiene il massimo (dilatazione) o il minimo (erosione).
+// Percorso separabile: il paraboloide illimitato -k|b|^2 è somma di una parabola in x e una in y, quindi la sua
+// erosione è una passata per righe e una per colonne di min_q g(q) + k (x - q)^2, cioè l'inviluppo
+// inferiore delle parabole centrate nei pixel (Felzenszwalb-Huttenlocher), in tempo lineare qualunque
+// sia il raggio; la dilatazione è l'erosione dell'immagine cambiata di segno.
+
+// Spostamento del supporto con la sua altezza
+struct WeightedOffset {
+    int dy, dx;
+    double weight;
+};
+
+template <typename T, bool Erode>
+static inline T pickValue(T a, T b) {
+    return Erode ? (a < b ? a : b) : (a > b ? a : b);
+}
+
+// Elemento neutro di minimo/massimo: +inf/-inf per i float, massimo/minimo per gli interi
+template <typename T, bool Erode>
+static constexpr T neutralValue() {
+    if constexpr (std::numeric_limits<T>::has_infinity)
+        return Erode ? std::numeric_limits<T>::infinity() : -std::numeric_limits<T>::infinity();
+    else
+        return Erode ? std::numeric_limits<T>::max() : std::numeric_limits<T>::lowest();
+}
+
+// Funzione per sommare (dilatazione) o sottrarre (erosione) le altezze con il percorso diretto
+template <typename T, bool Erode>
+static void directWeightedPass(const T* in, T* out, int width, int height, const WeightedStructuringElement& se, bool parallel) {
+    std::vector<WeightedOffset> offsets;
+    for (int i = 0; i < se.height; i++)
+        for (int j = 0; j < se.width; j++)
+            if (se.support[i][j] == 1) offsets.push_back({i - se.anchor_y, j - se.anchor_x, se.weights[i][j]});
+
+    #pragma omp parallel for if(parallel) schedule(static) shared(in, out, width, height, offsets) default(none)
+    for (int y = 0; y < height; y++) {
+        T* dst = out + (size_t)y * width;
+        std::fill(dst, dst + width, neutralValue<T, Erode>());
+        for (const auto& offset : offsets) {
+            int source = y + offset.dy;
+            if (source < 0 || source >= height) continue;
+            // Colonne di uscita i cui vicini cadono nell'immagine
+            int x0 = std::max(0, -offset.dx), x1 = std::min(width, width - offset.dx);
+            const T* src = in + (size_t)source * width + offset.dx;
+            if constexpr (std::is_floating_point_v<T>) {
+                T w = (T)(Erode ? -offset.weight : offset.weight);
+                #pragma omp simd
+                for (int x = x0; x < x1; x++) dst[x] = pickValue<T, Erode>(dst[x], src[x] + w);
+            } else {
+                // Somma saturata nel tipo intero più stretto che contiene -max..2 max (16 bit per uint8_t,
+                // così ogni registro SIMD elabora 8-16 pixel): un'altezza oltre +-max satura comunque
+                using Wide = std::conditional_t<sizeof(T) == 1, int16_t, int32_t>;
+                const Wide top = std::numeric_limits<T>::max();
+                double rounded = (double)std::lround(Erode ? -offset.weight : offset.weight);
+                const Wide w = (Wide)std::clamp(rounded, -(double)top, (double)top);
+                #pragma omp simd
+                for (int x = x0; x < x1; x++) {
+                    Wide value = (Wide)(src[x] + w);
+                    value = value < 0 ? 0 : (value > top ? top : value);
+                    dst[x] = pickValue<T, Erode>(dst[x], (T)value);
+                }
+            }
+        }
+    }
+}
+
+// Erosione 1D di g[0..n-1] con la parabola k d^2: e[x] = min_q g[q] + k (x - q)^2, con l'inviluppo
+// inferiore delle parabole (v = vertici dell'inviluppo, z = confini fra due parabole consecutive)
+static void lowerEnvelope(const double* g, int n, double k, double* e, int* v, double* z) {
+    int j = 0;
+    v[0] = 0;
+    z[0] = -std::numeric_limits<double>::infinity();
+    z[1] = std::numeric_limits<double>::infinity();
+    // Ascissa in cui la parabola di q raggiunge quella di p
+    auto meet = [&](int q, int p) { return ((g[q] + k * q * q) - (g[p] + k * p * p)) / (2.0 * k * (q - p)); };
+    for (int q = 1; q < n; q++) {
+        // Le parabole dell'inviluppo che q supera prima del loro confine sinistro non servono più
+        double s = meet(q, v[j]);
+        while (s <= z[j]) s = meet(q, v[--j]);
+        j++;
+        v[j] = q;
+        z[j] = s;
+        z[j + 1] = std::numeric_limits<double>::infinity();
+    }
+    j = 0;
+    for (int x = 0; x < n; x++) {
+        while (z[j + 1] < x) j++;
+        int d = x - v[j];
+        e[x] = g[v[j]] + k * (double)(d * d);
+    }
+}
+
+// Pixel di tipo T da un valore in doppia precisione, arrotondato e saturato per gli interi
+template <typename T>
+static T roundValue(double value) {
+    if constexpr (std::is_floating_point_v<T>) return (T)value;
+    else return (T)std::clamp(std::nearbyint(value), 0.0, (double)std::numeric_limits<T>::max());
+}
+
+// Funzione per erodere (Erode = true) o dilatare con il paraboloide, per righe e poi per colonne
+template <typename T, bool Erode>
+static void paraboloidPass(const T* in, T* out, int width, int height, double k, bool parallel) {
+    const double sign = Erode ? 1.0 : -1.0;
+    std::vector<double> rows((size_t)width * height);
+    #pragma omp parallel if(parallel) shared(in, rows, width, height, k, sign) default(none)
+    {
+        int n = std::max(width, height);
+        std::vector<double> g(n), z(n + 1);
+        std::vector<int> v(n);
+        #pragma omp for schedule(static)
+        for (int y = 0; y < height; y++) {
+            const T* src = in + (size_t)y * width;
+            for (int x = 0; x < width; x++) g[x] = sign * src[x];
+            lowerEnvelope(g.data(), width, k, rows.data() + (size_t)y * width, v.data(), z.data());
+        }
+    }
+    #pragma omp parallel if(parallel) shared(out, rows, width, height, k, sign) default(none)
+    {
+        int n = std::max(width, height);
+        std::vector<double> g(n), e(n), z(n + 1);
+        std::vector<int> v(n);
+        #pragma omp for schedule(static)
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; y++) g[y] = rows[(size_t)y * width + x];
+            lowerEnvelope(g.data(), height, k, e.data(), v.data(), z.data());
+            for (int y = 0; y < height; y++) out[(size_t)y * width + x] = roundValue<T>(sign * e[y]);
+        }
+    }
+}
+
+// Funzione per eseguire erosione o dilatazione con un elemento strutturante non piatto
+template <typename T, bool Erode>
+static GrayImage<T> weightedOperation(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path, bool parallel) {
+    TraceScope pass_trace(Erode ? "erosion_weighted" : "dilation_weighted", "stage");
+    // Ogni elemento ha un solo percorso esatto: il paraboloide illimitato non ha un supporto finito da
+    // scorrere, gli altri (anche il paraboloide troncato) non sono separabili
+    if (path == WeightedPath::Separable && se.paraboloid_k <= 0) {
+        throw std::invalid_argument("Il percorso separabile richiede paraboloid_unbounded");
+    }
+    if (path == WeightedPath::Direct && se.paraboloid_k > 0) {
+        throw std::invalid_argument("paraboloid_unbounded non ha un supporto finito: richiede il percorso separabile");
+    }
+    GrayImage<T> result;
+    result.initialize(img.width, img.height, T{});
+    result.filename = img.filename;
+    if (se.paraboloid_k > 0)
+        paraboloidPass<T, Erode>(img.data.data(), result.data.data(), img.width, img.height, se.paraboloid_k, parallel);
+    else
+        directWeightedPass<T, Erode>(img.data.data(), result.data.data(), img.width, img.height, se, parallel);
+    return result;
+}
+
+template <typename T>
+GrayImage<T> erosion_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path, bool parallel) {
+    return weightedOperation<T, true>(img, se, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> dilation_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path, bool parallel) {
+    return weightedOperation<T, false>(img, se, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> opening_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path, bool parallel) {
+    return dilation_weighted(erosion_weighted(img, se, path, parallel), se, path, parallel);
+}
+
+template <typename T>
+GrayImage<T> closing_weighted(const GrayImage<T>& img, const WeightedStructuringElement& se, WeightedPath path, bool parallel) {
+    return erosion_weighted(dilation_weighted(img, se, path, parallel), se, path, parallel);
+}
+
+// Istanze per i tipi di pixel supportati
+#define INSTANTIATE_WEIGHTED_OPERATIONS(T) \
+    template GrayImage<T> erosion_weighted<T>(const GrayImage<T>&, const WeightedStructuringElement&, WeightedPath, bool); \
+    template GrayImage<T> dilation_weighted<T>(const GrayImage<T>&, const WeightedStructuringElement&, WeightedPath, bool); \
+    template GrayImage<T> opening_weighted<T>(const GrayImage<T>&, const WeightedStructuringElement&, WeightedPath, bool); \
+    template GrayImage<T> closing_weighted<T>(const GrayImage<T>&, const WeightedStructuringElement&, WeightedPath, bool);
+
+INSTANTIATE_WEIGHTED_OPERATIONS(uint8_t)
+INSTANTIATE_WEIGHTED_OPERATIONS(uint16_t)
+INSTANTIATE_WEIGHTED_OPERATIONS(float)